@@ -0,0 +1,99 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The pool of the buffers that the received frames are decoded from.
+ *
+ * The buffers are grouped by the size classes of the power of two, and the buffer of a data
+ * returned by the pool is recycled into the pool once the data is released, so the frames of a
+ * similar size reuse the same storage instead of allocating a new one for every message.
+ *
+ * The shared pool keeps the buffers up to a limit for all the channels. A channel can also have
+ * its own pool on top of the shared one, which caches the last buffer released by the channel and
+ * hands it out again before falling back to the shared pool. The counters of all the pools are
+ * collected in the shared pool.
+ *
+ * The buffers larger than the largest size class are not pooled.
+ */
+@interface EDOBufferPool : NSObject
+
+/** The pool shared by all the channels. */
+@property(class, readonly) EDOBufferPool *sharedPool;
+
+/** The number of buffers handed out from the pooled ones. */
+@property(readonly) uint64_t hitCount;
+
+/** The number of buffers that had to be allocated. */
+@property(readonly) uint64_t missCount;
+
+/** The ratio of @c hitCount to all the buffers handed out, or 0 if none is handed out yet. */
+@property(readonly) double hitRate;
+
+/** The number of bytes kept by the pool for reuse. */
+@property(readonly) uint64_t retainedBytes;
+
+/** The number of dispatch data returned as @c NSData by @c -dataWithDispatchData:. */
+@property(readonly) uint64_t dispatchDataCount;
+
+/** The number of bytes copied by @c -dataWithDispatchData: to flatten the discontiguous data. */
+@property(readonly) uint64_t copiedBytes;
+
+/**
+ * Initializes a pool that caches the last buffer recycled into it and falls back to @c parentPool.
+ *
+ * The buffer cached by the pool is returned to @c parentPool once the pool is released.
+ *
+ * @param parentPool The pool to allocate the buffers from and to recycle the buffers into.
+ * @return An instance of @c EDOBufferPool.
+ */
+- (instancetype)initWithParentPool:(EDOBufferPool *)parentPool;
+
+/**
+ * Returns a buffer from the pool that can hold at least @c length bytes.
+ *
+ * The buffer must be either wrapped by @c -dataWithBuffer:length: or passed to
+ * @c -recycleBuffer:length: with the same @c length.
+ */
+- (void *)allocateBufferWithLength:(size_t)length;
+
+/** Returns the buffer allocated with the given @c length to the pool. */
+- (void)recycleBuffer:(void *)buffer length:(size_t)length;
+
+/**
+ * Wraps the buffer allocated from the pool into a data without copying.
+ *
+ * @param buffer The buffer returned by @c -allocateBufferWithLength:.
+ * @param length The length that the buffer is allocated with.
+ *
+ * @return The data of the buffer, which recycles the buffer into this pool once it is released.
+ */
+- (NSData *)dataWithBuffer:(void *)buffer length:(size_t)length;
+
+/**
+ * Returns the content of the dispatch data as an @c NSData.
+ *
+ * The contiguous dispatch data is wrapped without copying, and the discontiguous one is copied into
+ * a pooled buffer.
+ */
+- (NSData *)dataWithDispatchData:(dispatch_data_t)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
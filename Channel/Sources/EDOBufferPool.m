@@ -0,0 +1,281 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Channel/Sources/EDOBufferPool.h"
+
+#import "Channel/Sources/EDOChannelUtil.h"
+
+/** The smallest size class of the pooled buffers. */
+static const size_t kEDOBufferPoolMinBufferSize = 4096;
+
+/** The largest size class of the pooled buffers. */
+static const size_t kEDOBufferPoolMaxBufferSize = 16 << 20;
+
+/** The maximum number of bytes that the shared pool keeps for reuse. */
+static const uint64_t kEDOBufferPoolMaxRetainedBytes = 32 << 20;
+
+/** Gets the capacity of the size class that holds the @c length bytes. */
+static size_t EDOGetBufferCapacity(size_t length) {
+  size_t capacity = kEDOBufferPoolMinBufferSize;
+  while (capacity < length && capacity <= kEDOBufferPoolMaxBufferSize) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+@implementation EDOBufferPool {
+  // The pool to fall back to, or nil if this is the shared pool.
+  EDOBufferPool *_parentPool;
+  // The free buffers of the shared pool by their capacities.
+  NSMutableDictionary<NSNumber *, NSMutableArray<NSValue *> *> *_freeBuffers;
+  // The last buffer recycled into the pool with a parent pool, and its capacity.
+  void *_cachedBuffer;
+  size_t _cachedCapacity;
+  // The counters of all the pools, which are only updated on the shared pool.
+  uint64_t _hitCount;
+  uint64_t _missCount;
+  uint64_t _retainedBytes;
+  uint64_t _dispatchDataCount;
+  uint64_t _copiedBytes;
+}
+
++ (EDOBufferPool *)sharedPool {
+  static dispatch_once_t onceToken;
+  static EDOBufferPool *sharedPool;
+  dispatch_once(&onceToken, ^{
+    sharedPool = [[self alloc] init];
+  });
+  return sharedPool;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _freeBuffers = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+- (instancetype)initWithParentPool:(EDOBufferPool *)parentPool {
+  self = [super init];
+  if (self) {
+    _parentPool = parentPool;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  if (_cachedBuffer) {
+    [[self edo_rootPool] edo_addRetainedBytes:-(int64_t)_cachedCapacity];
+    [_parentPool recycleBuffer:_cachedBuffer length:_cachedCapacity];
+  }
+  for (NSMutableArray<NSValue *> *buffers in _freeBuffers.allValues) {
+    for (NSValue *buffer in buffers) {
+      free(buffer.pointerValue);
+    }
+  }
+}
+
+- (uint64_t)hitCount {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    return rootPool->_hitCount;
+  }
+}
+
+- (uint64_t)missCount {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    return rootPool->_missCount;
+  }
+}
+
+- (double)hitRate {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    uint64_t total = rootPool->_hitCount + rootPool->_missCount;
+    return total == 0 ? 0 : (double)rootPool->_hitCount / total;
+  }
+}
+
+- (uint64_t)retainedBytes {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    return rootPool->_retainedBytes;
+  }
+}
+
+- (uint64_t)dispatchDataCount {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    return rootPool->_dispatchDataCount;
+  }
+}
+
+- (uint64_t)copiedBytes {
+  EDOBufferPool *rootPool = [self edo_rootPool];
+  @synchronized(rootPool) {
+    return rootPool->_copiedBytes;
+  }
+}
+
+- (void *)allocateBufferWithLength:(size_t)length {
+  size_t capacity = EDOGetBufferCapacity(length);
+  if (capacity > kEDOBufferPoolMaxBufferSize) {
+    [[self edo_rootPool] edo_recordHit:NO];
+    return malloc(length);
+  }
+
+  if (_parentPool) {
+    void *buffer = NULL;
+    @synchronized(self) {
+      if (_cachedBuffer && _cachedCapacity == capacity) {
+        buffer = _cachedBuffer;
+        _cachedBuffer = NULL;
+      }
+    }
+    if (!buffer) {
+      return [_parentPool allocateBufferWithLength:length];
+    }
+    EDOBufferPool *rootPool = [self edo_rootPool];
+    [rootPool edo_recordHit:YES];
+    [rootPool edo_addRetainedBytes:-(int64_t)capacity];
+    return buffer;
+  }
+
+  @synchronized(self) {
+    NSMutableArray<NSValue *> *buffers = _freeBuffers[@(capacity)];
+    if (buffers.count > 0) {
+      void *buffer = buffers.lastObject.pointerValue;
+      [buffers removeLastObject];
+      _hitCount += 1;
+      _retainedBytes -= capacity;
+      return buffer;
+    }
+    _missCount += 1;
+  }
+  return malloc(capacity);
+}
+
+- (void)recycleBuffer:(void *)buffer length:(size_t)length {
+  size_t capacity = EDOGetBufferCapacity(length);
+  if (capacity > kEDOBufferPoolMaxBufferSize) {
+    free(buffer);
+    return;
+  }
+
+  if (_parentPool) {
+    // The pool only keeps the last buffer, and the one it replaces goes to the parent pool.
+    void *evictedBuffer;
+    size_t evictedCapacity;
+    @synchronized(self) {
+      evictedBuffer = _cachedBuffer;
+      evictedCapacity = _cachedCapacity;
+      _cachedBuffer = buffer;
+      _cachedCapacity = capacity;
+    }
+    EDOBufferPool *rootPool = [self edo_rootPool];
+    [rootPool edo_addRetainedBytes:(int64_t)capacity];
+    if (evictedBuffer) {
+      [rootPool edo_addRetainedBytes:-(int64_t)evictedCapacity];
+      [_parentPool recycleBuffer:evictedBuffer length:evictedCapacity];
+    }
+    return;
+  }
+
+  @synchronized(self) {
+    if (_retainedBytes + capacity <= kEDOBufferPoolMaxRetainedBytes) {
+      NSNumber *key = @(capacity);
+      NSMutableArray<NSValue *> *buffers = _freeBuffers[key];
+      if (!buffers) {
+        buffers = [[NSMutableArray alloc] init];
+        _freeBuffers[key] = buffers;
+      }
+      [buffers addObject:[NSValue valueWithPointer:buffer]];
+      _retainedBytes += capacity;
+      return;
+    }
+  }
+  free(buffer);
+}
+
+- (NSData *)dataWithBuffer:(void *)buffer length:(size_t)length {
+  return [[NSData alloc] initWithBytesNoCopy:buffer
+                                      length:length
+                                 deallocator:^(void *bytes, NSUInteger _) {
+                                   [self recycleBuffer:bytes length:length];
+                                 }];
+}
+
+- (NSData *)dataWithDispatchData:(dispatch_data_t)data {
+  __block size_t regionCount = 0;
+  dispatch_data_apply(data, ^bool(dispatch_data_t region, size_t offset, const void *buffer,
+                                  size_t size) {
+    return ++regionCount < 2;
+  });
+  size_t length = dispatch_data_get_size(data);
+  [[self edo_rootPool] edo_recordDispatchDataWithCopiedBytes:regionCount < 2 ? 0 : length];
+  if (regionCount < 2) {
+    return EDOGetDataFromDispatchData(data);
+  }
+
+  uint8_t *buffer = [self allocateBufferWithLength:length];
+  dispatch_data_apply(data, ^bool(dispatch_data_t region, size_t offset, const void *bytes,
+                                  size_t size) {
+    memcpy(buffer + offset, bytes, size);
+    return true;
+  });
+  return [self dataWithBuffer:buffer length:length];
+}
+
+#pragma mark - Private
+
+/** The pool that collects the counters, which is the one without a parent pool. */
+- (EDOBufferPool *)edo_rootPool {
+  EDOBufferPool *pool = self;
+  while (pool->_parentPool) {
+    pool = pool->_parentPool;
+  }
+  return pool;
+}
+
+/** Counts a buffer handed out, either from the pooled ones or newly allocated. */
+- (void)edo_recordHit:(BOOL)hit {
+  @synchronized(self) {
+    if (hit) {
+      _hitCount += 1;
+    } else {
+      _missCount += 1;
+    }
+  }
+}
+
+/** Counts a dispatch data returned as @c NSData and the bytes copied to flatten it. */
+- (void)edo_recordDispatchDataWithCopiedBytes:(size_t)copiedBytes {
+  @synchronized(self) {
+    _dispatchDataCount += 1;
+    _copiedBytes += copiedBytes;
+  }
+}
+
+/** Adjusts the number of bytes kept for reuse by the pools. */
+- (void)edo_addRetainedBytes:(int64_t)bytes {
+  @synchronized(self) {
+    _retainedBytes += (uint64_t)bytes;
+  }
+}
+
+@end
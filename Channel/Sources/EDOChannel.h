@@ -54,6 +54,22 @@ typedef void (^EDOChannelReceiveHandler)(id<EDOChannel> channel, NSData *_Nullab
  */
 typedef void (^EDOChannelSentHandler)(id<EDOChannel> channel, NSError *_Nullable error);
 
+/**
+ * @typedef EDOChannelReceiveDispatchDataHandler
+ * The type handlers handling the data as it is received from the underlying transport.
+ *
+ * It follows the same convention as @c EDOChannelReceiveHandler, except that the @c data is the
+ * region-backed @c dispatch_data_t which can consist of multiple non-contiguous regions. No bytes
+ * are copied before the handler is dispatched.
+ *
+ * @param channel The channel where the data is received.
+ * @param data    The data being received. The channel is closed when it's nil.
+ * @param error   The error when it fails to receive data.
+ */
+typedef void (^EDOChannelReceiveDispatchDataHandler)(id<EDOChannel> channel,
+                                                     dispatch_data_t _Nullable data,
+                                                     NSError *_Nullable error);
+
 /**
  * Check if the channel is valid and available to send and receive data.
  *
@@ -123,6 +139,35 @@ typedef void (^EDOChannelSentHandler)(id<EDOChannel> channel, NSError *_Nullable
  */
 - (void)invalidate;
 
+@optional
+
+/**
+ * Schedule the block for the next received data to process as dispatch data.
+ *
+ * This behaves the same as @c receiveDataWithQueue:handler: but hands over the received data
+ * without flattening it into a contiguous buffer, which allows the caller to avoid copying large
+ * payloads if it can process the data regions directly.
+ *
+ * @param queue   The dispatch queue on which the handler will be dispatched.
+ * @param handler The handler to be dispatched when the data is received.
+ */
+- (void)receiveDispatchDataWithQueue:(dispatch_queue_t)queue
+                             handler:(EDOChannelReceiveDispatchDataHandler _Nullable)handler;
+
+/**
+ * Asynchronously send the dispatch data to this channel.
+ *
+ * This behaves the same as @c sendData:withCompletionHandler: but takes the data that can consist
+ * of multiple non-contiguous regions, i.e. the segments concatenated by
+ * @c EDOCreateDispatchDataFromSegments. The regions are written with a single gathered write and
+ * are never flattened into a contiguous buffer.
+ *
+ * @param data    The data being sent.
+ * @param handler The completion block.
+ */
+- (void)sendDispatchData:(dispatch_data_t)data
+    withCompletionHandler:(EDOChannelSentHandler _Nullable)handler;
+
 @end
 
 NS_ASSUME_NONNULL_END
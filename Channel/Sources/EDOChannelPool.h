@@ -28,6 +28,10 @@ NS_ASSUME_NONNULL_BEGIN
  * @c EDOSocketChannel objects that are available can be stored here for future reuse. Reuse will
  * help reduce the amount to time spent rebuilding and reestablishing a connection. Channels are
  * clustered with the port they are connected to.
+ *
+ * If there is no available channel and the host accepts streams on one of its connections, a new
+ * stream is opened on that connection instead of connecting to the host again, so the concurrent
+ * requests to the same host share one socket.
  */
 @interface EDOChannelPool : NSObject
 
@@ -72,6 +76,23 @@ NS_ASSUME_NONNULL_BEGIN
                            connectionQueue:(dispatch_queue_t _Nullable)queue
                                      error:(NSError *_Nullable *_Nullable)error;
 
+/**
+ * Fetches an already-connected channel from the pool, keyed by the host @c port, or create a new
+ * channel if one does not exist, waiting for the channel no later than the @c deadline.
+ *
+ * @param port     The host port to connect to.
+ * @param queue    The queue that new channels will be connected on.
+ * @param deadline The dispatch time to give up waiting for the channel from the device, or
+ *                 @c DISPATCH_TIME_FOREVER to only wait for the default timeout.
+ * @param error    The error to populate in case of failure.
+ *
+ * @return The channel that's ready to send and receive data, or @c nil if there is an error.
+ */
+- (nullable id<EDOChannel>)channelWithPort:(EDOHostPort *)port
+                           connectionQueue:(dispatch_queue_t _Nullable)queue
+                                  deadline:(dispatch_time_t)deadline
+                                     error:(NSError *_Nullable *_Nullable)error;
+
 /**
  * Adds the @c channel to the pool.
  *
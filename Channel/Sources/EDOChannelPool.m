@@ -20,6 +20,7 @@
 #import "Channel/Sources/EDOChannel.h"
 #import "Channel/Sources/EDOChannelErrors.h"
 #import "Channel/Sources/EDOHostPort.h"
+#import "Channel/Sources/EDOSharedMemoryChannel.h"
 #import "Channel/Sources/EDOSocket.h"
 #import "Channel/Sources/EDOSocketChannel.h"
 #import "Channel/Sources/EDOSocketPort.h"
@@ -33,6 +34,8 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
   dispatch_queue_t _channelPoolQueue;
   // The reusable channels, mapping from the host port to the channels.
   NSMutableDictionary<EDOHostPort *, EDOBlockingQueue<id<EDOChannel>> *> *_channelMap;
+  // The connections to open new streams on, mapping from the host port to the channel.
+  NSMutableDictionary<EDOHostPort *, EDOSocketChannel *> *_multiplexedChannelMap;
   // The socket of service registration.
   EDOSocket *_serviceRegistrationSocket;
   // The dispatch queue to accept service connection by name.
@@ -53,6 +56,7 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
   if (self) {
     _channelPoolQueue = dispatch_queue_create("com.google.edo.ChannelPool", DISPATCH_QUEUE_SERIAL);
     _channelMap = [[NSMutableDictionary alloc] init];
+    _multiplexedChannelMap = [[NSMutableDictionary alloc] init];
     _serviceConnectionQueue =
         dispatch_queue_create("com.google.edo.serviceConnection", DISPATCH_QUEUE_SERIAL);
   }
@@ -66,10 +70,24 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
 - (id<EDOChannel>)channelWithPort:(EDOHostPort *)port
                   connectionQueue:(dispatch_queue_t)queue
                             error:(NSError **)error {
+  return [self channelWithPort:port
+               connectionQueue:queue
+                      deadline:DISPATCH_TIME_FOREVER
+                         error:error];
+}
+
+- (id<EDOChannel>)channelWithPort:(EDOHostPort *)port
+                  connectionQueue:(dispatch_queue_t)queue
+                         deadline:(dispatch_time_t)deadline
+                            error:(NSError **)error {
   dispatch_time_t now = dispatch_time(DISPATCH_TIME_NOW, 0);
   id<EDOChannel> channel = [[self channelsForPort:port] lastObjectWithTimeout:now];
   NSError *resultError;
 
+  if (!channel) {
+    // Share the existing connection instead of connecting again if the host accepts streams.
+    channel = [self edo_openStreamWithPort:port];
+  }
   if (channel) {
     return channel;
   } else if (port.port == 0) {
@@ -78,7 +96,7 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
 
     // The channel from the device to the host will be registered asynchronously. We give a short
     // period time to wait here until the channel is being added from the host.
-    dispatch_time_t timeout = dispatch_time(DISPATCH_TIME_NOW, kChannelPoolTimeout);
+    dispatch_time_t timeout = MIN(dispatch_time(DISPATCH_TIME_NOW, kChannelPoolTimeout), deadline);
     channel = [[self channelsForPort:port] lastObjectWithTimeout:timeout];
     if (!channel) {
       NSDictionary<NSErrorUserInfoKey, id> *userInfo = @{EDOChannelPortKey : port};
@@ -112,6 +130,14 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
 - (void)addChannel:(id<EDOChannel>)channel forPort:(EDOHostPort *)port {
   // reuse the channel only when it is valid
   if (channel.isValid) {
+    if ([channel isKindOfClass:[EDOSocketChannel class]] &&
+        ((EDOSocketChannel *)channel).multiplexingSupported) {
+      dispatch_sync(_channelPoolQueue, ^{
+        if (!self->_multiplexedChannelMap[port].valid) {
+          self->_multiplexedChannelMap[port] = (EDOSocketChannel *)channel;
+        }
+      });
+    }
     [[self channelsForPort:port] appendObject:channel];
   }
 }
@@ -119,6 +145,7 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
 - (void)removeChannelsWithPort:(EDOHostPort *)port {
   dispatch_sync(_channelPoolQueue, ^{
     [self->_channelMap removeObjectForKey:port];
+    [self->_multiplexedChannelMap removeObjectForKey:port];
   });
 }
 
@@ -135,6 +162,20 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
 
 #pragma mark - Private
 
+/**
+ * Opens a new stream on the connection to the host @c port that accepts streams.
+ *
+ * @return The stream that's ready to send and receive data, or @c nil if there is no such
+ *         connection.
+ */
+- (id<EDOChannel>)edo_openStreamWithPort:(EDOHostPort *)port {
+  __block EDOSocketChannel *multiplexedChannel;
+  dispatch_sync(_channelPoolQueue, ^{
+    multiplexedChannel = self->_multiplexedChannelMap[port];
+  });
+  return [multiplexedChannel openStream];
+}
+
 - (id<EDOChannel>)edo_createChannelWithPort:(EDOHostPort *)port
                                       queue:(dispatch_queue_t)queue
                                       error:(NSError **)error {
@@ -149,7 +190,27 @@ static const int64_t kChannelPoolTimeout = 10 * NSEC_PER_SEC;
       channel = [[EDOSocketChannel alloc] initWithDispatchIO:deviceChannel];
     }
   } else {
-    EDOSocket *socket = [EDOSocket socketWithTCPPort:port.port queue:queue error:&connectionError];
+    // Prefer the shared memory and then the UNIX domain socket if the host listens on them, which
+    // skip the TCP stack.
+    NSString *sharedMemorySocketPath = port.sharedMemorySocketPath;
+    if (sharedMemorySocketPath) {
+      EDOSocket *sharedMemorySocket = [EDOSocket socketWithSocketPath:sharedMemorySocketPath
+                                                                queue:queue
+                                                                error:nil];
+      if (sharedMemorySocket) {
+        channel = [EDOSharedMemoryChannel channelWithConnectedSocket:sharedMemorySocket
+                                                        handlerQueue:nil
+                                                               error:nil];
+      }
+    }
+    EDOSocket *socket;
+    NSString *localSocketPath = port.localSocketPath;
+    if (!channel && localSocketPath) {
+      socket = [EDOSocket socketWithSocketPath:localSocketPath queue:queue error:nil];
+    }
+    if (!channel && !socket) {
+      socket = [EDOSocket socketWithTCPPort:port.port queue:queue error:&connectionError];
+    }
     if (socket) {
       channel = [EDOSocketChannel channelWithSocket:socket];
     }
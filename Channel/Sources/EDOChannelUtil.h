@@ -23,12 +23,88 @@
 extern "C" {
 #endif
 
-/** Gets the size of the frame header. */
+/** The version of the frame header. */
+typedef NS_ENUM(uint16_t, EDOFrameHeaderVersion) {
+  /** The header with a 32-bit payload length, which all the peers understand. */
+  EDOFrameHeaderVersion1 = 1,
+  /** The header with the flags, the stream identifier and a 64-bit payload length. */
+  EDOFrameHeaderVersion2 = 2,
+  /** The latest version that this build can parse. */
+  EDOFrameHeaderVersionLatest = EDOFrameHeaderVersion2,
+};
+
+/** The per-frame features carried by the version 2 frame header. */
+typedef NS_OPTIONS(uint8_t, EDOFrameFlags) {
+  EDOFrameFlagsNone = 0,
+  /** The payload is compressed. */
+  EDOFrameFlagsCompressed = 1 << 0,
+  /** The payload is followed by its checksum. */
+  EDOFrameFlagsChecksummed = 1 << 1,
+  /** The payload continues in the next frame of the same stream. */
+  EDOFrameFlagsContinuation = 1 << 2,
+  /** The frame carries the 64-bit flow-control credit granted to the peer instead of data. */
+  EDOFrameFlagsWindowUpdate = 1 << 3,
+};
+
+/** The capabilities of the sender advertised in every frame header. */
+typedef NS_OPTIONS(uint8_t, EDOFrameCapabilities) {
+  EDOFrameCapabilitiesNone = 0,
+  /** The sender accepts the new streams opened by the peer. */
+  EDOFrameCapabilitiesStreams = 1 << 0,
+  /** The sender reassembles the continuation frames and grants the flow-control credit. */
+  EDOFrameCapabilitiesChunks = 1 << 1,
+};
+
+/** The information parsed from a frame header. */
+typedef struct EDOFrameHeader {
+  /** The version of the header. */
+  EDOFrameHeaderVersion version;
+  /** The latest header version that the sender of the frame can parse. */
+  EDOFrameHeaderVersion supportedVersion;
+  /** The capabilities of the sender of the frame. */
+  EDOFrameCapabilities capabilities;
+  /** The flags of the frame; always none for the version 1 header. */
+  EDOFrameFlags flags;
+  /** The identifier of the stream that the frame belongs to; always 0 for the version 1 header. */
+  uint32_t streamID;
+  /** The size of the header. */
+  size_t headerSize;
+  /** The size of the payload following the header. */
+  uint64_t payloadSize;
+} EDOFrameHeader;
+
+/** The result of parsing a frame header. */
+typedef NS_ENUM(NSInteger, EDOFrameHeaderStatus) {
+  /** The data doesn't have enough bytes for the header yet. */
+  EDOFrameHeaderStatusIncomplete,
+  /** The header is parsed successfully. */
+  EDOFrameHeaderStatusValid,
+  /** The data doesn't start with a valid frame header. */
+  EDOFrameHeaderStatusInvalid,
+};
+
+/** Gets the size of the version 1 frame header. */
 size_t EDOGetPayloadHeaderSize(void);
 
-/** Gets the size of the payload from the frame header. */
+/** Gets the size of the frame header of the given @c version. */
+size_t EDOGetFrameHeaderSize(EDOFrameHeaderVersion version);
+
+/** Gets the size of the payload from the frame header, or 0 if the header is invalid. */
 size_t EDOGetPayloadSizeFromFrameData(dispatch_data_t data);
 
+/**
+ * Parses the frame header at the beginning of the data.
+ *
+ * Only the bytes of the header are mapped so the data can include the payload and the frames
+ * following it.
+ *
+ * @param data        The data starting with a frame header.
+ * @param[out] header The parsed header if the status is @c EDOFrameHeaderStatusValid.
+ *
+ * @return The status of the parsing.
+ */
+EDOFrameHeaderStatus EDOParseFrameHeader(dispatch_data_t data, EDOFrameHeader *header);
+
 /**
  * Creates @c dispatch_data_t from NSData that has the frame header and is ready to be sent.
  *
@@ -39,6 +115,65 @@ size_t EDOGetPayloadSizeFromFrameData(dispatch_data_t data);
  */
 dispatch_data_t EDOBuildFrameFromDataWithQueue(NSData *data, dispatch_queue_t queue);
 
+/**
+ * Creates @c dispatch_data_t from NSData that has the given frame header.
+ *
+ * The frame of the version 2 header must only be sent to the peer that has advertised it in the
+ * @c supportedVersion of its frames. Every header advertises the latest version of this build.
+ *
+ * @param data   The data to be sent.
+ * @param header The header of the frame; the @c version, @c capabilities, @c flags and @c streamID
+ *               are used and the rest is derived. The flags and the stream identifier require the
+ *               version 2 header.
+ * @param queue  The dispatch queue on which to release the @c data.
+ *
+ * @return The dispatch data containing the frame header and the given data.
+ */
+dispatch_data_t EDOBuildFrameFromDataWithHeader(NSData *data, EDOFrameHeader header,
+                                                dispatch_queue_t queue);
+
+/**
+ * Creates @c dispatch_data_t from the dispatch data that has the given frame header.
+ *
+ * The header is the only buffer allocated; the regions of the @c data are referenced as they are,
+ * so the frame can be written with a single gathered write without copying the payload.
+ *
+ * @param data   The data to be sent, which can consist of multiple non-contiguous regions.
+ * @param header The header of the frame. @see EDOBuildFrameFromDataWithHeader.
+ *
+ * @return The dispatch data containing the frame header and the given data.
+ */
+dispatch_data_t EDOBuildFrameFromDispatchDataWithHeader(dispatch_data_t data,
+                                                        EDOFrameHeader header);
+
+/**
+ * Creates @c dispatch_data_t that refers to the bytes of the data segments in order.
+ *
+ * No bytes are copied; each segment is retained until the returned data is released. The segments
+ * that are backed by multiple regions, such as the data received by the channels, are referenced
+ * region by region without being flattened.
+ *
+ * @param segments The data segments.
+ * @param queue    The dispatch queue on which to release the @c segments, or @c nil to release
+ *                 them on the default global queue.
+ *
+ * @return The dispatch data of the concatenated segments.
+ */
+dispatch_data_t EDOCreateDispatchDataFromSegments(NSArray<NSData *> *segments,
+                                                  dispatch_queue_t queue);
+
+/**
+ * Creates an @c NSData that shares the underlying storage of the given dispatch data.
+ *
+ * If the @c data is backed by a single contiguous region, the returned data references the region
+ * directly and no bytes are copied; otherwise the regions are flattened once.
+ *
+ * @param data The dispatch data to wrap.
+ *
+ * @return The @c NSData with the same content as @c data.
+ */
+NSData *EDOGetDataFromDispatchData(dispatch_data_t data);
+
 #if defined(__cplusplus)
 }  //   extern "C"
 #endif
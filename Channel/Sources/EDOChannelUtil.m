@@ -16,6 +16,8 @@
 
 #import "Channel/Sources/EDOChannelUtil.h"
 
+#include <libkern/OSByteOrder.h>
+
 static const uint64_t kGEDOSocketFrameHeaderTag = 0xc080c080;
 
 /**
@@ -24,9 +26,13 @@ static const uint64_t kGEDOSocketFrameHeaderTag = 0xc080c080;
  * The header data layout:
  * |--- 32bit ---|--- 32bit ---|----- 32 bit -----|--- flexible ---|
  * |-- type(1) --|- 0xc080c080-|- length of data -|--*-* data *-*--|
+ *
+ * The peers prior to the version 2 header only check the tag, so the upper 16 bits of the type
+ * carry the latest header version that the sender can parse and the capabilities of the sender.
  */
 typedef struct EDOSocketFrameHeader_s {
-  // Type of frame, always 1.
+  // Type of frame: the header version in the lower 16 bits, followed by the 8-bit supported
+  // version and the 8-bit EDOFrameCapabilities.
   uint32_t type;
 
   // Tag.
@@ -36,6 +42,37 @@ typedef struct EDOSocketFrameHeader_s {
   uint32_t payloadSize;
 } __attribute__((__packed__)) EDOSocketFrameHeader_t;
 
+/**
+ * The version 2 data header, which is only sent after the peer advertises it.
+ *
+ * The header data layout:
+ * |--- 32bit ---|--- 32bit ---|- 8bit -|- 24bit -|--- 32bit ---|----- 64 bit -----|-- flexible --|
+ * |-- type(2) --|- 0xc080c080-|- flags-|- zeros -|- stream id -|- length of data -|--*- data -*--|
+ */
+typedef struct EDOSocketFrameHeaderV2_s {
+  // Type of frame, the same as the version 1 header.
+  uint32_t type;
+
+  // Tag.
+  uint32_t tag;
+
+  // The EDOFrameFlags of the frame.
+  uint8_t flags;
+
+  // Reserved for future use, always zeros.
+  uint8_t reserved[3];
+
+  // The stream identifier in network byte order.
+  uint32_t streamID;
+
+  // If payloadSize is larger than zero, @c payloadSize of bytes are following.
+  uint64_t payloadSize;
+} __attribute__((__packed__)) EDOSocketFrameHeaderV2_t;
+
+/** The flags that the frame reader can process. */
+static const EDOFrameFlags kEDOSupportedFrameFlags =
+    EDOFrameFlagsContinuation | EDOFrameFlagsWindowUpdate;
+
 // Check if the frame header is valid
 // TODO(haowoo): add more checksum checks.
 static BOOL edo_isFrameHeaderValid(const EDOSocketFrameHeader_t *header) {
@@ -46,41 +83,131 @@ static BOOL edo_isFrameHeaderValid(const EDOSocketFrameHeader_t *header) {
 
 size_t EDOGetPayloadHeaderSize(void) { return sizeof(EDOSocketFrameHeader_t); }
 
+size_t EDOGetFrameHeaderSize(EDOFrameHeaderVersion version) {
+  return version == EDOFrameHeaderVersion2 ? sizeof(EDOSocketFrameHeaderV2_t)
+                                           : sizeof(EDOSocketFrameHeader_t);
+}
+
 size_t EDOGetPayloadSizeFromFrameData(dispatch_data_t data) {
-  if (data == NULL) {
+  EDOFrameHeader header;
+  if (data == NULL || EDOParseFrameHeader(data, &header) != EDOFrameHeaderStatusValid) {
     return 0;
   }
+  return (size_t)header.payloadSize;
+}
 
-  __block size_t payloadSize = 0;
-  dispatch_data_t contiguousData = dispatch_data_create_map(data, NULL, NULL);
-  dispatch_data_apply(contiguousData, ^bool(dispatch_data_t region, size_t offset,
-                                            const void *buffer, size_t size) {
-    const struct EDOSocketFrameHeader_s *frame = buffer;
-    if (offset == 0 && edo_isFrameHeaderValid(frame)) {
-      payloadSize = ntohl(frame->payloadSize);
-    }
-    return YES;
-  });
+EDOFrameHeaderStatus EDOParseFrameHeader(dispatch_data_t data, EDOFrameHeader *header) {
+  size_t dataSize = dispatch_data_get_size(data);
+  if (dataSize < sizeof(EDOSocketFrameHeader_t)) {
+    return EDOFrameHeaderStatusIncomplete;
+  }
+
+  // Only map the bytes of the largest header, the payload can be arbitrarily large.
+  size_t mappedSize = MIN(dataSize, sizeof(EDOSocketFrameHeaderV2_t));
+  const void *buffer = NULL;
+  NS_VALID_UNTIL_END_OF_SCOPE dispatch_data_t contiguousData =
+      dispatch_data_create_map(dispatch_data_create_subrange(data, 0, mappedSize), &buffer, NULL);
+  const EDOSocketFrameHeader_t *frame = buffer;
+  if (!edo_isFrameHeaderValid(frame)) {
+    return EDOFrameHeaderStatusInvalid;
+  }
 
-  return payloadSize;
+  EDOFrameHeaderVersion version = frame->type & 0xffff;
+  EDOFrameHeaderVersion supportedVersion = (frame->type >> 16) & 0xff;
+  header->capabilities = frame->type >> 24;
+  if (version == EDOFrameHeaderVersion2) {
+    if (mappedSize < sizeof(EDOSocketFrameHeaderV2_t)) {
+      return EDOFrameHeaderStatusIncomplete;
+    }
+    const EDOSocketFrameHeaderV2_t *frameV2 = buffer;
+    if ((frameV2->flags & ~kEDOSupportedFrameFlags) != 0) {
+      return EDOFrameHeaderStatusInvalid;
+    }
+    header->flags = frameV2->flags;
+    header->streamID = ntohl(frameV2->streamID);
+    header->payloadSize = OSSwapBigToHostInt64(frameV2->payloadSize);
+  } else if (version == EDOFrameHeaderVersion1) {
+    header->flags = EDOFrameFlagsNone;
+    header->streamID = 0;
+    header->payloadSize = ntohl(frame->payloadSize);
+  } else {
+    // The newer peer must not send the header that isn't advertised.
+    return EDOFrameHeaderStatusInvalid;
+  }
+  header->version = version;
+  header->supportedVersion = MAX(version, supportedVersion);
+  header->headerSize = EDOGetFrameHeaderSize(version);
+  return EDOFrameHeaderStatusValid;
 }
 
 dispatch_data_t EDOBuildFrameFromDataWithQueue(NSData *data, dispatch_queue_t queue) {
-  dispatch_data_t frameData = dispatch_data_create(data.bytes, data.length, queue, ^{
-    // The trick to have the block capture and retain the data.
-    [data length];
-  });
+  EDOFrameHeader header = {.version = EDOFrameHeaderVersion1};
+  return EDOBuildFrameFromDataWithHeader(data, header, queue);
+}
 
-  dispatch_data_t headerData = ({
+dispatch_data_t EDOBuildFrameFromDataWithHeader(NSData *data, EDOFrameHeader header,
+                                                dispatch_queue_t queue) {
+  dispatch_data_t payload = EDOCreateDispatchDataFromSegments(@[ data ], queue);
+  return EDOBuildFrameFromDispatchDataWithHeader(payload, header);
+}
+
+dispatch_data_t EDOBuildFrameFromDispatchDataWithHeader(dispatch_data_t data,
+                                                        EDOFrameHeader header) {
+  EDOFrameHeaderVersion version = header.version;
+  NSCAssert(version == EDOFrameHeaderVersion2 ||
+                (header.flags == EDOFrameFlagsNone && header.streamID == 0),
+            @"The flags and the stream ID require the version 2 frame header.");
+  size_t payloadSize = dispatch_data_get_size(data);
+  uint32_t type = (uint32_t)version | ((uint32_t)EDOFrameHeaderVersionLatest << 16) |
+                  ((uint32_t)header.capabilities << 24);
+  // The header is copied into the buffer owned by the dispatch data, which is the only allocation.
+  dispatch_data_t headerData;
+  if (version == EDOFrameHeaderVersion2) {
+    EDOSocketFrameHeaderV2_t frameHeader = {
+        .type = type,
+        .tag = kGEDOSocketFrameHeaderTag,
+        .flags = header.flags,
+        .streamID = htonl(header.streamID),
+        .payloadSize = OSSwapHostToBigInt64(payloadSize),
+    };
+    headerData = dispatch_data_create(&frameHeader, sizeof(frameHeader), NULL,
+                                      DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  } else {
     EDOSocketFrameHeader_t frameHeader = {
-        .type = 1,
+        .type = type,
         .tag = kGEDOSocketFrameHeaderTag,
-        .payloadSize = htonl(data.length),
+        .payloadSize = htonl(payloadSize),
     };
-    NSData *headerData = [NSData dataWithBytes:&frameHeader length:sizeof(frameHeader)];
-    dispatch_data_create(headerData.bytes, headerData.length, queue, ^{
-      [headerData length];
-    });
-  });
-  return dispatch_data_create_concat(headerData, frameData);
+    headerData = dispatch_data_create(&frameHeader, sizeof(frameHeader), NULL,
+                                      DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  }
+  return dispatch_data_create_concat(headerData, data);
+}
+
+dispatch_data_t EDOCreateDispatchDataFromSegments(NSArray<NSData *> *segments,
+                                                  dispatch_queue_t queue) {
+  __block dispatch_data_t result = dispatch_data_empty;
+  for (NSData *segment in segments) {
+    [segment enumerateByteRangesUsingBlock:^(const void *bytes, NSRange range, BOOL *stop) {
+      dispatch_data_t region = dispatch_data_create(bytes, range.length, queue, ^{
+        // The trick to have the block capture and retain the data.
+        [segment length];
+      });
+      result = dispatch_data_create_concat(result, region);
+    }];
+  }
+  return result;
+}
+
+NSData *EDOGetDataFromDispatchData(dispatch_data_t data) {
+  const void *buffer = NULL;
+  size_t size = 0;
+  // The map is a no-op and returns the same data if it is already contiguous.
+  dispatch_data_t contiguousData = dispatch_data_create_map(data, &buffer, &size);
+  return [[NSData alloc] initWithBytesNoCopy:(void *)buffer
+                                      length:size
+                                 deallocator:^(void *bytes, NSUInteger length) {
+                                   // The trick to have the block capture and retain the data.
+                                   (void)contiguousData;
+                                 }];
 }
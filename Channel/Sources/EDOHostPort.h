@@ -48,6 +48,24 @@ NS_ASSUME_NONNULL_BEGIN
 /** Whether to require to connect to usbmuxd for the device connections. */
 @property(readonly, nonatomic) BOOL connectsDevice;
 
+/**
+ * The path of the UNIX domain socket that the host may also listen on, which is derived from the
+ * @c port. @c nil if the host isn't on the same machine or is identified by name.
+ *
+ * The socket is in a directory under /tmp that only the current user can access, which is created
+ * if needed. @c nil if the existing directory is not owned by the user or others can access it.
+ *
+ * The UNIX domain socket is optional; the connection falls back to the TCP @c port if nothing
+ * listens on the path.
+ */
+@property(readonly, nonatomic, nullable) NSString *localSocketPath;
+
+/**
+ * The path of the UNIX domain socket that the host may listen on to set up the shared memory
+ * channels, which is derived from the @c port. @c nil if @c localSocketPath is @c nil.
+ */
+@property(readonly, nonatomic, nullable) NSString *sharedMemorySocketPath;
+
 /** The data representation of the host port. */
 @property(readonly, nonatomic) NSData *data;
 
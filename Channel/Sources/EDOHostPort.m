@@ -18,9 +18,26 @@
 
 #import <TargetConditionals.h>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 /** The device identifer for the host that @c EDOHostPort targets to . */
 static NSString *const kEDOHostPortHostIdentifier = @"host";
 
+/**
+ * The format of the directory of the UNIX domain sockets for the given user ID.
+ *
+ * The directory is under /tmp because the simulators have their own temporary directory, which the
+ * processes on the Mac can't see. Only the user who owns it can access the directory.
+ */
+static NSString *const kEDOHostPortLocalSocketDirectoryFormat = @"/tmp/com.google.edo.%u";
+
+/** The format of the UNIX domain socket name for the given port number. */
+static NSString *const kEDOHostPortLocalSocketNameFormat = @"%d.sock";
+
+/** The format of the socket name to set up the shared memory channels for the given port number. */
+static NSString *const kEDOHostPortSharedMemorySocketNameFormat = @"%d.shm.sock";
+
 static NSString *const kEDOHostPortCoderPortKey = @"port";
 static NSString *const kEDOHostPortCoderNameKey = @"serviceName";
 static NSString *const kEDOHostPortCoderDeviceSerialKey = @"deviceSerialNumber";
@@ -39,6 +56,31 @@ typedef struct EDOHostPortData_s {
   uint16_t serialOffset;
 } __attribute__((__packed__)) EDOHostPortData_t;
 
+#if TARGET_OS_SIMULATOR || TARGET_OS_OSX
+/**
+ * Gets the directory of the UNIX domain sockets for the current user, creating it if needed.
+ *
+ * @return The path of the directory, @c nil if it isn't a directory that only the current user can
+ *         access, in which case the sockets are not used.
+ */
+static NSString *edo_LocalSocketDirectory(void) {
+  uid_t userID = geteuid();
+  NSString *directory = [NSString stringWithFormat:kEDOHostPortLocalSocketDirectoryFormat, userID];
+  const char *path = directory.fileSystemRepresentation;
+  if (mkdir(path, S_IRWXU) != 0 && errno != EEXIST) {
+    return nil;
+  }
+  // Check what is at the path as it may be created by others before us; lstat doesn't follow the
+  // symbolic link.
+  struct stat status;
+  if (lstat(path, &status) != 0 || !S_ISDIR(status.st_mode) || status.st_uid != userID ||
+      (status.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+    return nil;
+  }
+  return directory;
+}
+#endif
+
 @implementation EDOHostPort
 
 + (BOOL)supportsSecureCoding {
@@ -179,6 +221,26 @@ typedef struct EDOHostPortData_s {
 #endif
 }
 
+- (NSString *)localSocketPath {
+#if TARGET_OS_SIMULATOR || TARGET_OS_OSX
+  // The processes on the Mac and its simulators share the same file system, while the sandboxed
+  // processes on the real devices don't.
+  if (self.port == 0 || self.connectsDevice) {
+    return nil;
+  }
+  NSString *name = [NSString stringWithFormat:kEDOHostPortLocalSocketNameFormat, self.port];
+  return [edo_LocalSocketDirectory() stringByAppendingPathComponent:name];
+#else
+  return nil;
+#endif
+}
+
+- (NSString *)sharedMemorySocketPath {
+  NSString *name = [NSString stringWithFormat:kEDOHostPortSharedMemorySocketNameFormat, self.port];
+  return [self.localSocketPath.stringByDeletingLastPathComponent
+      stringByAppendingPathComponent:name];
+}
+
 #pragma mark - Object Equality
 
 - (BOOL)isEqual:(id)other {
@@ -20,6 +20,7 @@
 #include <fcntl.h>
 #include <netinet/tcp.h>
 #include <stdatomic.h>
+#include <sys/stat.h>
 #include <sys/un.h>
 
 #import "Channel/Sources/EDOSocket.h"
@@ -47,6 +48,15 @@ static char const *gListenSocketQueueLabel = "com.google.edo.socketListen";
     return nil;
   }
 
+  // Record the file of the UNIX domain socket, so it is removed later only if it's still the one
+  // created by this socket.
+  struct sockaddr_un unixAddress;
+  socklen_t addrLen = sizeof(unixAddress);
+  struct stat fileStatus;
+  BOOL ownsSocketFile = getsockname(socketFD, (struct sockaddr *)&unixAddress, &addrLen) == 0 &&
+                        unixAddress.sun_family == AF_UNIX &&
+                        lstat(unixAddress.sun_path, &fileStatus) == 0;
+
   dispatch_queue_t eventQueue =
       dispatch_queue_create(gListenSocketQueueLabel, DISPATCH_QUEUE_SERIAL);
 
@@ -73,6 +83,13 @@ static char const *gListenSocketQueueLabel = "com.google.edo.socketListen";
     // Release the socket and reset it to -1.
     EDOSocket *strongSelf = weakSelf;
     [strongSelf releaseSocket];
+
+    // Remove the file of the UNIX domain socket so no one can connect to it anymore.
+    struct stat currentStatus;
+    if (ownsSocketFile && lstat(unixAddress.sun_path, &currentStatus) == 0 &&
+        currentStatus.st_dev == fileStatus.st_dev && currentStatus.st_ino == fileStatus.st_ino) {
+      unlink(unixAddress.sun_path);
+    }
     close(socketFD);
   });
 
@@ -115,7 +132,7 @@ static char const *gListenSocketQueueLabel = "com.google.edo.socketListen";
  * @param fd The incoming socket descriptor.
  */
 - (EDOSocket *)accept:(dispatch_fd_t)fd {
-  struct sockaddr_in addr;
+  struct sockaddr_storage addr;
   socklen_t addrLen = sizeof(addr);
   dispatch_fd_t clientFD = accept(fd, (struct sockaddr *)&addr, &addrLen);
 
@@ -0,0 +1,74 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Channel/Sources/EDOChannel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOSocket;
+
+/**
+ * The channel that exchanges data through the memory shared by two processes on the same machine.
+ *
+ * The shared memory holds a single-producer/single-consumer ring buffer for each direction, and
+ * the data is copied into the ring without any system call. The connecting side creates the
+ * shared memory and the accepting side maps it over a connected UNIX domain socket, which is then
+ * only used to wake up the peer when it is waiting for the data or for the space in the ring. The
+ * receiving side polls the ring for a short while before it waits, so a response that comes back
+ * quickly doesn't need the wakeup at all.
+ *
+ * The channel is closed for both sides once either side invalidates it or the process exits.
+ */
+@interface EDOSharedMemoryChannel : NSObject <EDOChannel>
+
+/**
+ * Creates the shared memory and sets up the channel with the peer that accepts the @c socket.
+ *
+ * @param socket       The socket connected to the peer, which the channel takes over.
+ * @param handlerQueue The queue on which the channel handlers for sending and receiving data will
+ *                     be dispatched. If @c nil, it creates a serial queue.
+ * @param error        The error if it fails to set up the shared memory.
+ *
+ * @return An instance of @c EDOSharedMemoryChannel on success; @c nil otherwise.
+ */
++ (nullable instancetype)channelWithConnectedSocket:(EDOSocket *)socket
+                                       handlerQueue:(dispatch_queue_t _Nullable)handlerQueue
+                                              error:(NSError *_Nullable *_Nullable)error;
+
+/**
+ * Maps the shared memory that the peer of the accepted @c socket creates and sets up the channel.
+ *
+ * It waits briefly for the peer to send the name of the shared memory, which the peer does right
+ * after the connection is established.
+ *
+ * @param socket       The socket accepted from the peer, which the channel takes over.
+ * @param handlerQueue The queue on which the channel handlers for sending and receiving data will
+ *                     be dispatched. If @c nil, it creates a serial queue.
+ * @param error        The error if it fails to set up the shared memory.
+ *
+ * @return An instance of @c EDOSharedMemoryChannel on success; @c nil otherwise.
+ */
++ (nullable instancetype)channelWithAcceptedSocket:(EDOSocket *)socket
+                                      handlerQueue:(dispatch_queue_t _Nullable)handlerQueue
+                                             error:(NSError *_Nullable *_Nullable)error;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,732 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Channel/Sources/EDOSharedMemoryChannel.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#import "Channel/Sources/EDOBufferPool.h"
+#import "Channel/Sources/EDOChannel.h"
+#import "Channel/Sources/EDOSocket.h"
+
+/** The magic number that starts the handshake, which is "eDOm". */
+static const uint32_t kEDOSharedMemoryMagic = 0x65444f6d;
+
+/** The capacity in bytes of the ring buffer for each direction, which is a power of two. */
+static const uint32_t kEDOSharedMemoryRingCapacity = 1 << 20;
+
+/** The maximum length in bytes of a frame, which bounds the buffer to receive the peer's frame. */
+static const uint32_t kEDOSharedMemoryMaxFrameLength = 1 << 30;
+
+/** The timeout in milliseconds to exchange the handshake with the peer. */
+static const int kEDOSharedMemoryHandshakeTimeout = 1000;
+
+/** The time to keep polling the empty ring before waiting for the peer to wake this side up. */
+static const uint64_t kEDOSharedMemorySpinTimeInNano = 50 * NSEC_PER_USEC;
+
+/** The interval to check if the channel is closed while the sender waits for the space. */
+static const int64_t kEDOSharedMemorySendWaitInterval = 10 * NSEC_PER_MSEC;
+
+/**
+ * The control block of a ring buffer in the shared memory.
+ *
+ * The positions only increase, and they are wrapped around by the capacity to access the buffer.
+ * The producer advances the head and the consumer advances the tail, which are kept on separate
+ * cache lines.
+ */
+typedef struct EDOSharedMemoryRing {
+  /** The total number of bytes written by the producer. */
+  _Atomic(uint64_t) head __attribute__((aligned(64)));
+  /** Whether the producer waits for the consumer to free up the space. */
+  _Atomic(uint32_t) producerWaiting;
+  /** The total number of bytes read by the consumer. */
+  _Atomic(uint64_t) tail __attribute__((aligned(64)));
+  /** Whether the consumer waits for the producer to write more data. */
+  _Atomic(uint32_t) consumerWaiting;
+} EDOSharedMemoryRing;
+
+/**
+ * The layout of the shared memory, which is followed by the buffers of the two rings.
+ *
+ * The connecting side sends with the first ring and receives with the second ring.
+ */
+typedef struct EDOSharedMemoryLayout {
+  EDOSharedMemoryRing rings[2];
+} EDOSharedMemoryLayout;
+
+/** The message that the connecting side sends for the accepting side to map the shared memory. */
+typedef struct EDOSharedMemoryHandshake {
+  uint32_t magic;
+  uint32_t capacity;
+  char name[32];
+} EDOSharedMemoryHandshake;
+
+/** The block to process a frame received from the channel, or the closure of the channel. */
+typedef void (^EDOSharedMemoryFrameHandler)(NSData *_Nullable frame, NSError *_Nullable error);
+
+#pragma mark - Shared memory help functions
+
+/** Gets the size of the shared memory for the rings of the given capacity. */
+static size_t edo_SharedMemorySize(uint32_t capacity) {
+  return sizeof(EDOSharedMemoryLayout) + 2 * (size_t)capacity;
+}
+
+/** Copies the bytes into the ring buffer at the position, wrapping around the end. */
+static void edo_CopyToRing(uint8_t *buffer, uint32_t capacity, uint64_t position,
+                           const uint8_t *bytes, size_t length) {
+  size_t offset = (size_t)(position & (capacity - 1));
+  size_t length1 = MIN(length, capacity - offset);
+  memcpy(buffer + offset, bytes, length1);
+  memcpy(buffer, bytes + length1, length - length1);
+}
+
+/** Copies the bytes out of the ring buffer at the position, wrapping around the end. */
+static void edo_CopyFromRing(const uint8_t *buffer, uint32_t capacity, uint64_t position,
+                             uint8_t *bytes, size_t length) {
+  size_t offset = (size_t)(position & (capacity - 1));
+  size_t length1 = MIN(length, capacity - offset);
+  memcpy(bytes, buffer + offset, length1);
+  memcpy(bytes + length1, buffer, length - length1);
+}
+
+/**
+ * Reads or writes exactly @c length bytes over the socket within the handshake timeout.
+ *
+ * @return 0 on success; the @c errno value otherwise.
+ */
+static int edo_TransferHandshakeBytes(dispatch_fd_t socket, void *bytes, size_t length,
+                                      BOOL writes) {
+  uint8_t *cursor = bytes;
+  while (length > 0) {
+    struct pollfd pollFD = {.fd = socket, .events = writes ? POLLOUT : POLLIN};
+    int ready = poll(&pollFD, 1, kEDOSharedMemoryHandshakeTimeout);
+    if (ready == 0) {
+      return ETIMEDOUT;
+    } else if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    ssize_t count = writes ? write(socket, cursor, length) : read(socket, cursor, length);
+    if (count == 0) {
+      return ECONNRESET;
+    } else if (count < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      return errno;
+    }
+    cursor += count;
+    length -= (size_t)count;
+  }
+  return 0;
+}
+
+#pragma mark - EDOSharedMemoryChannel
+
+@implementation EDOSharedMemoryChannel {
+  // The socket to wake up the peer, which is closed when the channel is released.
+  dispatch_fd_t _socket;
+  // The shared memory mapped into this process.
+  void *_memory;
+  // The capacity of each ring buffer.
+  uint32_t _capacity;
+  // The ring and its buffer that this side writes to.
+  EDOSharedMemoryRing *_sendRing;
+  uint8_t *_sendBuffer;
+  // The ring and its buffer that this side reads from.
+  EDOSharedMemoryRing *_receiveRing;
+  uint8_t *_receiveBuffer;
+  // The queue to dispatch the send completion handlers.
+  dispatch_queue_t _handlerQueue;
+  // The serial queue to write the frames that don't fit in the ring right away.
+  dispatch_queue_t _sendQueue;
+  // The number of frames waiting to be written on the send queue.
+  NSUInteger _pendingSendCount;
+  // The semaphore signaled when the peer wakes this side up, which the blocked sender waits on.
+  dispatch_semaphore_t _spaceSemaphore;
+  // The serial queue to read from the receive ring.
+  dispatch_queue_t _receiveQueue;
+  // The source to wake up the receive queue when the peer writes to the socket.
+  dispatch_source_t _wakeupSource;
+  // Whether the receive queue is scheduled to poll the ring for the response.
+  _Atomic(bool) _spinScheduled;
+  // The pooled buffer of the frame being received and the number of its bytes filled, only used
+  // on the receive queue.
+  uint8_t *_receivingFrame;
+  size_t _receivingFrameOffset;
+  // The pool of the buffers that the received frames are copied into.
+  EDOBufferPool *_receiveBufferPool;
+  // The length prefix of the next frame and the number of its bytes read.
+  uint32_t _frameLength;
+  size_t _frameLengthOffset;
+  // Whether the channel is closed.
+  BOOL _closed;
+  // The frames that are received before any receive handler is scheduled.
+  NSMutableArray<NSData *> *_receivedFrames;
+  // The pending receive handlers, in the order they are scheduled.
+  NSMutableArray<EDOSharedMemoryFrameHandler> *_frameHandlers;
+}
+
++ (instancetype)channelWithConnectedSocket:(EDOSocket *)socket
+                              handlerQueue:(dispatch_queue_t)handlerQueue
+                                     error:(NSError **)error {
+  dispatch_fd_t socketFD = socket.valid ? [socket releaseSocket] : -1;
+  EDOSharedMemoryHandshake handshake = {.magic = kEDOSharedMemoryMagic,
+                                        .capacity = kEDOSharedMemoryRingCapacity};
+  size_t size = edo_SharedMemorySize(handshake.capacity);
+  void *memory = MAP_FAILED;
+  int errNo = socketFD == -1 ? EBADF : 0;
+
+  // The name only needs to be unique until the peer maps the memory.
+  static _Atomic(uint32_t) gSharedMemoryCount = 0;
+  int memoryFD = -1;
+  while (errNo == 0 && memoryFD == -1) {
+    snprintf(handshake.name, sizeof(handshake.name), "/edo.%d.%u", getpid(),
+             atomic_fetch_add(&gSharedMemoryCount, 1));
+    memoryFD = shm_open(handshake.name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (memoryFD == -1 && errno != EEXIST) {
+      errNo = errno;
+    }
+  }
+  if (errNo == 0) {
+    if (ftruncate(memoryFD, (off_t)size) == 0) {
+      memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFD, 0);
+    }
+    errNo = memory == MAP_FAILED ? errno : 0;
+    close(memoryFD);
+
+    if (errNo == 0) {
+      errNo = edo_TransferHandshakeBytes(socketFD, &handshake, sizeof(handshake), YES);
+    }
+    uint8_t acknowledgement;
+    if (errNo == 0) {
+      errNo = edo_TransferHandshakeBytes(socketFD, &acknowledgement, 1, NO);
+    }
+    // The peer has mapped the memory once it acknowledges, so the name can be removed.
+    shm_unlink(handshake.name);
+  }
+  return [self edo_channelWithSocket:socketFD
+                              memory:memory
+                            capacity:handshake.capacity
+                    sendsOnFirstRing:YES
+                        handlerQueue:handlerQueue
+                           errorCode:errNo
+                               error:error];
+}
+
++ (instancetype)channelWithAcceptedSocket:(EDOSocket *)socket
+                             handlerQueue:(dispatch_queue_t)handlerQueue
+                                    error:(NSError **)error {
+  dispatch_fd_t socketFD = socket.valid ? [socket releaseSocket] : -1;
+  EDOSharedMemoryHandshake handshake = {0};
+  void *memory = MAP_FAILED;
+  int errNo = socketFD == -1 ? EBADF : 0;
+
+  if (errNo == 0) {
+    errNo = edo_TransferHandshakeBytes(socketFD, &handshake, sizeof(handshake), NO);
+  }
+  uint32_t capacity = handshake.capacity;
+  if (errNo == 0 && (handshake.magic != kEDOSharedMemoryMagic || capacity < sizeof(uint32_t) ||
+                     (capacity & (capacity - 1)) != 0)) {
+    errNo = EPROTO;
+  }
+  if (errNo == 0) {
+    handshake.name[sizeof(handshake.name) - 1] = '\0';
+    size_t size = edo_SharedMemorySize(capacity);
+    int memoryFD = shm_open(handshake.name, O_RDWR, 0);
+    struct stat memoryStat;
+    if (memoryFD == -1 || fstat(memoryFD, &memoryStat) != 0) {
+      errNo = errno;
+    } else if ((size_t)memoryStat.st_size < size) {
+      errNo = EPROTO;
+    } else {
+      memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFD, 0);
+      errNo = memory == MAP_FAILED ? errno : 0;
+    }
+    if (memoryFD != -1) {
+      close(memoryFD);
+    }
+  }
+  if (errNo == 0) {
+    uint8_t acknowledgement = 1;
+    errNo = edo_TransferHandshakeBytes(socketFD, &acknowledgement, 1, YES);
+  }
+  return [self edo_channelWithSocket:socketFD
+                              memory:memory
+                            capacity:capacity
+                    sendsOnFirstRing:NO
+                        handlerQueue:handlerQueue
+                           errorCode:errNo
+                               error:error];
+}
+
+/**
+ * Creates the channel with the shared memory if the handshake succeeds, or cleans up otherwise.
+ *
+ * @param socket           The socket connected to the peer.
+ * @param memory           The mapped shared memory, or @c MAP_FAILED if it isn't mapped.
+ * @param capacity         The capacity of each ring buffer in the shared memory.
+ * @param sendsOnFirstRing Whether this side writes to the first ring.
+ * @param handlerQueue     The queue to dispatch the channel handlers.
+ * @param errNo            The @c errno value if the handshake fails, or 0 on success.
+ * @param error            The error if the handshake fails.
+ *
+ * @return An instance of @c EDOSharedMemoryChannel on success; @c nil otherwise.
+ */
++ (instancetype)edo_channelWithSocket:(dispatch_fd_t)socket
+                               memory:(void *)memory
+                             capacity:(uint32_t)capacity
+                     sendsOnFirstRing:(BOOL)sendsOnFirstRing
+                         handlerQueue:(dispatch_queue_t)handlerQueue
+                            errorCode:(int)errNo
+                                error:(NSError **)error {
+  if (errNo != 0) {
+    if (memory != MAP_FAILED) {
+      munmap(memory, edo_SharedMemorySize(capacity));
+    }
+    if (socket != -1) {
+      close(socket);
+    }
+    if (error) {
+      *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errNo userInfo:nil];
+    }
+    return nil;
+  }
+  return [[self alloc] initWithSocket:socket
+                               memory:memory
+                             capacity:capacity
+                     sendsOnFirstRing:sendsOnFirstRing
+                         handlerQueue:handlerQueue];
+}
+
+- (instancetype)initWithSocket:(dispatch_fd_t)socket
+                        memory:(void *)memory
+                      capacity:(uint32_t)capacity
+              sendsOnFirstRing:(BOOL)sendsOnFirstRing
+                  handlerQueue:(dispatch_queue_t)handlerQueue {
+  self = [super init];
+  if (self) {
+    _socket = socket;
+    _memory = memory;
+    _capacity = capacity;
+
+    EDOSharedMemoryLayout *layout = memory;
+    uint8_t *buffers = (uint8_t *)memory + sizeof(EDOSharedMemoryLayout);
+    NSUInteger sendIndex = sendsOnFirstRing ? 0 : 1;
+    _sendRing = &layout->rings[sendIndex];
+    _sendBuffer = buffers + sendIndex * capacity;
+    _receiveRing = &layout->rings[1 - sendIndex];
+    _receiveBuffer = buffers + (1 - sendIndex) * capacity;
+
+    // Use QOS_CLASS_USER_INITIATED for the same reason as EDOSocketChannel, to avoid the priority
+    // inversion as eDO communication is often in the critical path of the test execution.
+    dispatch_queue_attr_t attributes =
+        dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
+    _handlerQueue = handlerQueue
+                        ?: dispatch_queue_create("com.google.edo.sharedMemoryChannel.handler",
+                                                 attributes);
+    _sendQueue = dispatch_queue_create("com.google.edo.sharedMemoryChannel.send", attributes);
+    _receiveQueue = dispatch_queue_create("com.google.edo.sharedMemoryChannel.receive", attributes);
+    _spaceSemaphore = dispatch_semaphore_create(0);
+    _receivedFrames = [[NSMutableArray alloc] init];
+    _frameHandlers = [[NSMutableArray alloc] init];
+    _receiveBufferPool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
+
+    // Prevent SIGPIPE when the peer goes away, and never block on the wakeups.
+    int on = 1;
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+
+    // The source doesn't retain self to let the channel be released and invalidated.
+    __weak EDOSharedMemoryChannel *weakSelf = self;
+    _wakeupSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, socket, 0, _receiveQueue);
+    dispatch_source_set_event_handler(_wakeupSource, ^{
+      [weakSelf edo_handleWakeup];
+    });
+    dispatch_source_set_cancel_handler(_wakeupSource, ^{
+      close(socket);
+    });
+    dispatch_resume(_wakeupSource);
+
+    // The peer may have written the data before it could ask for the wakeup.
+    dispatch_async(_receiveQueue, ^{
+      [weakSelf edo_readReceiveRingWithSpin:NO];
+    });
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [self invalidate];
+  dispatch_source_cancel(_wakeupSource);
+  munmap(_memory, edo_SharedMemorySize(_capacity));
+  if (_receivingFrame) {
+    [_receiveBufferPool recycleBuffer:_receivingFrame length:_frameLength];
+  }
+}
+
+#pragma mark - EDOChannel
+
+- (BOOL)isValid {
+  @synchronized(self) {
+    return !_closed;
+  }
+}
+
+- (void)sendData:(NSData *)data withCompletionHandler:(EDOChannelSentHandler)handler {
+  BOOL written = NO;
+  @synchronized(self) {
+    // Write in place if no other frame is waiting and the frame fits in the free space.
+    if (_pendingSendCount == 0 && !_closed) {
+      written = [self edo_tryWriteFrame:data];
+    }
+    if (!written) {
+      _pendingSendCount += 1;
+    }
+  }
+
+  if (written) {
+    [self edo_scheduleSpinningReceive];
+    if (handler) {
+      dispatch_async(_handlerQueue, ^{
+        handler(self, nil);
+      });
+    }
+    return;
+  }
+
+  dispatch_async(_sendQueue, ^{
+    NSError *error = [self edo_writeFrame:data];
+    @synchronized(self) {
+      self->_pendingSendCount -= 1;
+    }
+    [self edo_scheduleSpinningReceive];
+    if (handler) {
+      dispatch_async(self->_handlerQueue, ^{
+        handler(self, error);
+      });
+    }
+  });
+}
+
+- (void)sendDispatchData:(dispatch_data_t)data
+    withCompletionHandler:(EDOChannelSentHandler)handler {
+  // The dispatch data bridges to NSData, whose regions are copied into the ring one by one.
+  [self sendData:(NSData *)data withCompletionHandler:handler];
+}
+
+- (void)receiveDataWithHandler:(EDOChannelReceiveHandler)handler {
+  [self receiveDataWithQueue:_handlerQueue handler:handler];
+}
+
+- (void)receiveDataWithQueue:(dispatch_queue_t)queue handler:(EDOChannelReceiveHandler)handler {
+  EDOSharedMemoryFrameHandler frameHandler = ^(NSData *data, NSError *error) {
+    if (handler) {
+      dispatch_async(queue, ^{
+        handler(self, data, error);
+      });
+    }
+  };
+
+  @synchronized(self) {
+    // The frames that are already read are still delivered after the channel is invalidated.
+    if (_receivedFrames.count > 0) {
+      NSData *frame = _receivedFrames.firstObject;
+      [_receivedFrames removeObjectAtIndex:0];
+      frameHandler(frame, nil);
+    } else if (_closed) {
+      // TODO(haowoo): Add better error code define.
+      frameHandler(nil,
+                   [NSError errorWithDomain:NSInternalInconsistencyException code:0 userInfo:nil]);
+    } else {
+      [_frameHandlers addObject:frameHandler];
+    }
+  }
+}
+
+- (void)invalidate {
+  NSArray<EDOSharedMemoryFrameHandler> *frameHandlers;
+  @synchronized(self) {
+    if (_closed) {
+      return;
+    }
+    _closed = YES;
+    frameHandlers = [_frameHandlers copy];
+    [_frameHandlers removeAllObjects];
+  }
+
+  // Shutting down the socket lets the peer know the channel is closed.
+  shutdown(_socket, SHUT_RDWR);
+  dispatch_semaphore_signal(_spaceSemaphore);
+  for (EDOSharedMemoryFrameHandler frameHandler in frameHandlers) {
+    frameHandler(nil, nil);
+  }
+}
+
+#pragma mark - Private
+
+/**
+ * Writes the frame into the send ring if it fits in the free space, without waiting.
+ *
+ * @return @c YES if the frame is written; @c NO if there isn't enough space for the frame.
+ */
+- (BOOL)edo_tryWriteFrame:(NSData *)data {
+  uint64_t head = atomic_load_explicit(&_sendRing->head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit(&_sendRing->tail, memory_order_acquire);
+  uint64_t frameSize = sizeof(uint32_t) + (uint64_t)data.length;
+  if (data.length > kEDOSharedMemoryMaxFrameLength || _capacity - (head - tail) < frameSize) {
+    return NO;
+  }
+
+  uint32_t frameLength = (uint32_t)data.length;
+  edo_CopyToRing(_sendBuffer, _capacity, head, (const uint8_t *)&frameLength, sizeof(frameLength));
+  __block uint64_t position = head + sizeof(frameLength);
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange range, BOOL *stop) {
+    edo_CopyToRing(self->_sendBuffer, self->_capacity, position, bytes, range.length);
+    position += range.length;
+  }];
+  [self edo_publishHead:position];
+  return YES;
+}
+
+/**
+ * Writes the frame into the send ring, waiting for the peer to free up the space as needed.
+ *
+ * The frame that is larger than the ring is written in pieces while the peer reads it.
+ *
+ * @return The error if the channel is closed before the frame is written, or @c nil on success.
+ */
+- (NSError *)edo_writeFrame:(NSData *)data {
+  __block int errNo = data.length > kEDOSharedMemoryMaxFrameLength ? EMSGSIZE : 0;
+  uint32_t frameLength = (uint32_t)data.length;
+  if (errNo == 0) {
+    errNo = [self edo_writeBytes:&frameLength length:sizeof(frameLength)];
+  }
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange range, BOOL *stop) {
+    if (errNo == 0) {
+      errNo = [self edo_writeBytes:bytes length:range.length];
+    }
+    *stop = errNo != 0;
+  }];
+  return errNo == 0 ? nil : [NSError errorWithDomain:NSPOSIXErrorDomain code:errNo userInfo:nil];
+}
+
+/**
+ * Writes the bytes into the send ring, waiting for the peer to free up the space as needed.
+ *
+ * @return 0 on success; @c ECONNRESET if the channel is closed before all the bytes are written.
+ */
+- (int)edo_writeBytes:(const void *)bytes length:(size_t)length {
+  const uint8_t *cursor = bytes;
+  uint64_t head = atomic_load_explicit(&_sendRing->head, memory_order_relaxed);
+  while (length > 0) {
+    if (!self.valid) {
+      return ECONNRESET;
+    }
+    uint64_t tail = atomic_load_explicit(&_sendRing->tail, memory_order_acquire);
+    if (head - tail == _capacity) {
+      // Ask for the wakeup before checking once more, so the space freed in between isn't missed.
+      atomic_store(&_sendRing->producerWaiting, 1);
+      if (head - atomic_load(&_sendRing->tail) == _capacity) {
+        dispatch_semaphore_wait(_spaceSemaphore,
+                                dispatch_time(DISPATCH_TIME_NOW, kEDOSharedMemorySendWaitInterval));
+      }
+      continue;
+    }
+
+    size_t count = (size_t)MIN(_capacity - (head - tail), length);
+    edo_CopyToRing(_sendBuffer, _capacity, head, cursor, count);
+    head += count;
+    cursor += count;
+    length -= count;
+    [self edo_publishHead:head];
+  }
+  return 0;
+}
+
+/** Makes the written bytes visible to the peer and wakes it up if it is waiting for them. */
+- (void)edo_publishHead:(uint64_t)head {
+  atomic_store(&_sendRing->head, head);
+  if (atomic_exchange(&_sendRing->consumerWaiting, 0)) {
+    [self edo_wakeUpPeer];
+  }
+}
+
+/**
+ * Wakes up the peer to check the rings.
+ *
+ * It is fine to skip the wakeup if the socket buffer is full, as the peer has yet to read the
+ * previous wakeups.
+ */
+- (void)edo_wakeUpPeer {
+  static const uint8_t kWakeup = 1;
+  send(_socket, &kWakeup, sizeof(kWakeup), 0);
+}
+
+/**
+ * Schedules the receive queue to poll the ring for a short while.
+ *
+ * It is scheduled after the data is sent, so the response that comes back quickly is read without
+ * the peer having to wake this side up.
+ */
+- (void)edo_scheduleSpinningReceive {
+  if (atomic_exchange(&_spinScheduled, true)) {
+    return;
+  }
+  __weak EDOSharedMemoryChannel *weakSelf = self;
+  dispatch_async(_receiveQueue, ^{
+    EDOSharedMemoryChannel *strongSelf = weakSelf;
+    if (strongSelf) {
+      atomic_store(&strongSelf->_spinScheduled, false);
+      [strongSelf edo_readReceiveRingWithSpin:YES];
+    }
+  });
+}
+
+/** Handles the wakeup from the peer, or the closure of the socket. */
+- (void)edo_handleWakeup {
+  uint8_t wakeups[64];
+  ssize_t count;
+  do {
+    count = read(_socket, wakeups, sizeof(wakeups));
+  } while (count > 0 || (count < 0 && errno == EINTR));
+  BOOL closed = count == 0 || errno != EAGAIN;
+
+  // The wakeup is either for the new data or for the space freed up for the blocked sender.
+  dispatch_semaphore_signal(_spaceSemaphore);
+  // The data written before the peer closes the channel is still received.
+  [self edo_readReceiveRingWithSpin:NO];
+  if (closed) {
+    dispatch_source_cancel(_wakeupSource);
+    [self invalidate];
+  }
+}
+
+/**
+ * Reads all the data in the receive ring and dispatches the complete frames.
+ *
+ * @param spin Whether to keep polling the ring for a short while once it is empty, before asking
+ *             the peer to wake this side up.
+ */
+- (void)edo_readReceiveRingWithSpin:(BOOL)spin {
+  EDOSharedMemoryRing *ring = _receiveRing;
+  uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  uint64_t deadline = 0;
+  if (spin) {
+    // The peer doesn't need to wake this side up while it is polling.
+    atomic_store(&ring->consumerWaiting, 0);
+    deadline = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) + kEDOSharedMemorySpinTimeInNano;
+  }
+
+  while (YES) {
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+      if (spin && clock_gettime_nsec_np(CLOCK_UPTIME_RAW) < deadline) {
+        continue;
+      }
+      // Ask for the wakeup before checking once more, so the data written in between isn't missed.
+      atomic_store(&ring->consumerWaiting, 1);
+      if (atomic_load(&ring->head) == tail) {
+        return;
+      }
+      atomic_store(&ring->consumerWaiting, 0);
+      continue;
+    }
+
+    // The peer never writes more than the capacity ahead, so the ring is corrupted otherwise.
+    if (head - tail > _capacity || ![self edo_readFramesFromPosition:&tail length:head - tail]) {
+      NSLog(@"The shared memory channel is corrupted, closing the channel.");
+      [self invalidate];
+      return;
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    if (atomic_exchange(&ring->producerWaiting, 0)) {
+      [self edo_wakeUpPeer];
+    }
+  }
+}
+
+/**
+ * Reads the bytes from the receive ring into the frames and dispatches the complete ones.
+ *
+ * Each frame is prefixed by its length, and the frame can span multiple reads if it is larger
+ * than the ring.
+ *
+ * @param position The position in the ring to read from, which is advanced past the bytes read.
+ * @param length   The number of bytes to read.
+ *
+ * @return @c NO if the frame is longer than the maximum or its buffer can't be allocated.
+ */
+- (BOOL)edo_readFramesFromPosition:(uint64_t *)position length:(uint64_t)length {
+  while (length > 0) {
+    size_t count;
+    if (!_receivingFrame) {
+      count = (size_t)MIN(length, sizeof(_frameLength) - _frameLengthOffset);
+      edo_CopyFromRing(_receiveBuffer, _capacity, *position,
+                       (uint8_t *)&_frameLength + _frameLengthOffset, count);
+      _frameLengthOffset += count;
+      if (_frameLengthOffset == sizeof(_frameLength)) {
+        if (_frameLength > kEDOSharedMemoryMaxFrameLength) {
+          return NO;
+        }
+        _receivingFrame = [_receiveBufferPool allocateBufferWithLength:_frameLength];
+        if (!_receivingFrame) {
+          return NO;
+        }
+        _receivingFrameOffset = 0;
+        _frameLengthOffset = 0;
+      }
+    } else {
+      count = (size_t)MIN(length, _frameLength - _receivingFrameOffset);
+      edo_CopyFromRing(_receiveBuffer, _capacity, *position,
+                       _receivingFrame + _receivingFrameOffset, count);
+      _receivingFrameOffset += count;
+    }
+    *position += count;
+    length -= count;
+
+    if (_receivingFrame && _receivingFrameOffset == _frameLength) {
+      [self edo_enqueueFrame:[_receiveBufferPool dataWithBuffer:_receivingFrame
+                                                         length:_frameLength]];
+      _receivingFrame = NULL;
+    }
+  }
+  return YES;
+}
+
+/** Hands the frame to the oldest pending handler, or keeps it if there is none. */
+- (void)edo_enqueueFrame:(NSData *)frame {
+  @synchronized(self) {
+    if (_frameHandlers.count > 0) {
+      _frameHandlers.firstObject(frame, nil);
+      [_frameHandlers removeObjectAtIndex:0];
+    } else {
+      [_receivedFrames addObject:frame];
+    }
+  }
+}
+
+@end
@@ -74,6 +74,33 @@ typedef void (^EDOSocketConnectedBlock)(EDOSocket *_Nullable socket, NSError *_N
                                      queue:(dispatch_queue_t _Nullable)queue
                                      error:(NSError *_Nullable *_Nullable)error;
 
+/**
+ * Connects to the UNIX domain socket at the given path asynchronously.
+ *
+ * The connection fails with @c EPERM if the peer doesn't run as the current user.
+ *
+ * @param path  The file system path of the socket.
+ * @param queue The queue where the completion block will be dispatched to. If @c nil, it creates a
+ *              serial queue.
+ * @param block The block to be invoked after the connection is established.
+ */
++ (void)connectWithSocketPath:(NSString *)path
+                        queue:(dispatch_queue_t _Nullable)queue
+               connectedBlock:(EDOSocketConnectedBlock _Nullable)block;
+
+/**
+ * Creates a socket that connects to the UNIX domain socket at the given path synchronously.
+ *
+ * @param path  The file system path of the socket.
+ * @param queue The queue where the completion block will be dispatched to. If @c nil, it creates a
+ *              serial queue.
+ * @param error The error if it fails to connect.
+ * @return An instance of @c EDOSocket that connects to the given path, @c nil if failed.
+ */
++ (nullable instancetype)socketWithSocketPath:(NSString *)path
+                                        queue:(dispatch_queue_t _Nullable)queue
+                                        error:(NSError *_Nullable *_Nullable)error;
+
 /**
  * Init with a socket descriptor.
  *
@@ -128,6 +155,26 @@ typedef void (^EDOSocketConnectedBlock)(EDOSocket *_Nullable socket, NSError *_N
                                     queue:(dispatch_queue_t _Nullable)queue
                            connectedBlock:(EDOSocketConnectedBlock _Nullable)block;
 
+/**
+ * Create a @c EDOSocket listening on the UNIX domain socket at the given path.
+ *
+ * The UNIX domain socket skips the TCP stack for the processes on the same machine. The stale
+ * socket file at the path is replaced only if the current user owns it and nothing listens on it.
+ * The file is removed when the socket is invalidated unless it has been replaced since.
+ *
+ * @param path  The file system path of the socket.
+ * @param queue The dispatch queue that the block will be dispatched to. If @c nil, it creates a
+ *              new concurrent queue.
+ * @param block The block will be dispatched when there is a new connection that is about to be
+ *              established.
+ *
+ * @return The socket connection that listens on the path, @c nil if it fails to bind the path.
+ * @see +listenWithTCPPort:queue:connectedBlock:
+ */
++ (EDOSocket *_Nullable)listenWithSocketPath:(NSString *)path
+                                       queue:(dispatch_queue_t _Nullable)queue
+                              connectedBlock:(EDOSocketConnectedBlock _Nullable)block;
+
 @end
 
 NS_ASSUME_NONNULL_END
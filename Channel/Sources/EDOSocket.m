@@ -22,7 +22,9 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <sys/stat.h>
 #include <sys/un.h>
+#include <unistd.h>
 
 // The 'nil' completion block that does nothing.
 static EDOSocketConnectedBlock gNoOpHandlerBlock = ^(EDOSocket *socket, NSError *error) {
@@ -32,15 +34,16 @@ static EDOSocketConnectedBlock gNoOpHandlerBlock = ^(EDOSocket *socket, NSError
 /**
  * Create a non-block socket.
  *
- * @param errNo the out parameter when it errors.
+ * @param domain The communication domain of the socket, @c AF_INET or @c AF_UNIX.
+ * @param errNo  the out parameter when it errors.
  *
  * @return -1, if fails to create and @c errNo contains @c errno value;
  *         the socket file descriptor, otherwise.
  */
-static dispatch_fd_t edo_CreateSocket(int *errNo) {
+static dispatch_fd_t edo_CreateSocket(int domain, int *errNo) {
   NSCAssert(errNo, @"errNo cannot be nil");
 
-  dispatch_fd_t fd = socket(AF_INET, SOCK_STREAM, 0);
+  dispatch_fd_t fd = socket(domain, SOCK_STREAM, 0);
   if (fd == -1) {
     *errNo = errno;
     return -1;
@@ -65,6 +68,157 @@ static void edo_RunHandlerWithErrorInQueueWithBlock(int code, dispatch_queue_t q
   }
 }
 
+/**
+ * Fills the UNIX socket address with the given path.
+ *
+ * @param path    The file system path of the socket.
+ * @param address The socket address to fill.
+ *
+ * @return 0 if the address is filled; @c ENAMETOOLONG if the path doesn't fit in the address.
+ */
+static int edo_FillUnixSocketAddress(NSString *path, struct sockaddr_un *address) {
+  const char *fileSystemPath = path.fileSystemRepresentation;
+  memset(address, 0, sizeof(*address));
+  if (strlen(fileSystemPath) >= sizeof(address->sun_path)) {
+    return ENAMETOOLONG;
+  }
+  address->sun_family = AF_UNIX;
+  address->sun_len = sizeof(*address);
+  strlcpy(address->sun_path, fileSystemPath, sizeof(address->sun_path));
+  return 0;
+}
+
+/**
+ * Checks whether the peer of the connected UNIX domain socket runs as the current user.
+ *
+ * @param socketFD The connected socket.
+ *
+ * @return @c YES if the effective user ID of the peer is the same as the current process.
+ */
+static BOOL edo_IsPeerCurrentUser(dispatch_fd_t socketFD) {
+  uid_t peerUserID;
+  gid_t peerGroupID;
+  return getpeereid(socketFD, &peerUserID, &peerGroupID) == 0 && peerUserID == geteuid();
+}
+
+/**
+ * Removes the stale socket file at the address that the previous listener left.
+ *
+ * The file is removed only if it is a socket owned by the current user and nothing listens on it,
+ * so a listening socket or a file that someone else created is never replaced.
+ *
+ * @param address The address of the UNIX domain socket.
+ *
+ * @return 0 if nothing is at the path anymore; the error code otherwise.
+ */
+static int edo_RemoveStaleSocketFile(const struct sockaddr_un *address) {
+  struct stat status;
+  if (lstat(address->sun_path, &status) != 0) {
+    return errno == ENOENT ? 0 : errno;
+  }
+  if (!S_ISSOCK(status.st_mode) || status.st_uid != geteuid()) {
+    return EADDRINUSE;
+  }
+
+  int probeFD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (probeFD == -1) {
+    return errno;
+  }
+  int ret = connect(probeFD, (const struct sockaddr *)address, sizeof(*address));
+  int connectErr = errno;
+  close(probeFD);
+  if (ret == 0 || connectErr != ECONNREFUSED) {
+    return EADDRINUSE;
+  }
+  return unlink(address->sun_path) == 0 ? 0 : errno;
+}
+
+/**
+ * Connects to the given address asynchronously.
+ *
+ * @param domain  The communication domain of the address.
+ * @param address The socket address to connect to.
+ * @param length  The length of the @c address.
+ * @param queue   The queue where the completion block will be dispatched to.
+ * @param block   The block to be invoked after the connection is established or fails.
+ */
+static void edo_ConnectSocket(int domain, const struct sockaddr *address, socklen_t length,
+                              dispatch_queue_t queue, EDOSocketConnectedBlock block) {
+  int socketErr = 0;
+  dispatch_fd_t socketFD = edo_CreateSocket(domain, &socketErr);
+  if (socketFD == -1) {
+    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
+    return;
+  }
+
+  int ret = connect(socketFD, address, length);
+  socketErr = errno;
+  if (ret != 0 && socketErr != EINPROGRESS) {
+    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
+    close(socketFD);
+    return;
+  }
+
+  // The dispatch source to wait on the connection. The socket becomes writable once it is
+  // connected, including when the connection completes right away.
+  dispatch_source_t source =
+      dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, (uintptr_t)socketFD, 0, queue);
+
+  dispatch_source_set_event_handler(source, ^{
+    int connectError = 0;
+    socklen_t errorlen = sizeof(connectError);
+
+    // If there is an error, the connection fails.
+    if (getsockopt(socketFD, SOL_SOCKET, SO_ERROR, &connectError, &errorlen) != 0 ||
+        connectError != 0) {
+      edo_RunHandlerWithErrorInQueueWithBlock(connectError, queue, block);
+    } else if (domain == AF_UNIX && !edo_IsPeerCurrentUser(socketFD)) {
+      // Whoever listens on the path may not be the expected host, so only the processes of the same
+      // user are trusted with the data.
+      close(socketFD);
+      edo_RunHandlerWithErrorInQueueWithBlock(EPERM, queue, block);
+    } else {
+      // Prevent SIGPIPE, suggested by Apple.
+      // https://developer.apple.com/library/archive/documentation/NetworkingInternetWeb/Conceptual/NetworkingOverview/CommonPitfalls/CommonPitfalls.html
+      int on = 1;
+      setsockopt(socketFD, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+      block([EDOSocket socketWithSocket:socketFD], nil);
+    }
+
+    // Once connected, we don't need this source any more; so we don't track this internally.
+    // This will also effectively release the strong reference of the source so it breaks the
+    // retain cycle as after the source is cancelled, the event handler will get released.
+    dispatch_source_cancel(source);
+  });
+
+  dispatch_resume(source);
+}
+
+/**
+ * Waits for the asynchronous connection synchronously.
+ *
+ * @param connectBlock The block to start the connection with the given completion block.
+ * @param error        The error if it fails to connect.
+ *
+ * @return An instance of @c EDOSocket that is connected, @c nil if failed.
+ */
+static EDOSocket *edo_WaitForConnection(void (^connectBlock)(EDOSocketConnectedBlock),
+                                        NSError **error) {
+  __block EDOSocket *connectedSocket;
+  __block NSError *connectionError;
+  dispatch_semaphore_t waitLock = dispatch_semaphore_create(0);
+  connectBlock(^(EDOSocket *socket, NSError *socketError) {
+    connectedSocket = socket;
+    connectionError = socketError;
+    dispatch_semaphore_signal(waitLock);
+  });
+  dispatch_semaphore_wait(waitLock, DISPATCH_TIME_FOREVER);
+  if (error) {
+    *error = connectionError;
+  }
+  return connectedSocket;
+}
+
 #pragma mark - EDOSocket implementation
 
 @interface EDOSocket ()
@@ -92,21 +246,21 @@ static void edo_RunHandlerWithErrorInQueueWithBlock(int code, dispatch_queue_t q
 + (nullable instancetype)socketWithTCPPort:(UInt16)port
                                      queue:(dispatch_queue_t _Nullable)queue
                                      error:(NSError *_Nullable *_Nullable)error {
-  __block EDOSocket *connectedSocket;
-  __block NSError *connectionError;
-  dispatch_semaphore_t waitLock = dispatch_semaphore_create(0);
-  [self connectWithTCPPort:port
-                     queue:queue
-            connectedBlock:^(EDOSocket *socket, NSError *socketError) {
-              connectedSocket = socket;
-              connectionError = socketError;
-              dispatch_semaphore_signal(waitLock);
-            }];
-  dispatch_semaphore_wait(waitLock, DISPATCH_TIME_FOREVER);
-  if (error) {
-    *error = connectionError;
-  }
-  return connectedSocket;
+  return edo_WaitForConnection(
+      ^(EDOSocketConnectedBlock block) {
+        [self connectWithTCPPort:port queue:queue connectedBlock:block];
+      },
+      error);
+}
+
++ (nullable instancetype)socketWithSocketPath:(NSString *)path
+                                        queue:(dispatch_queue_t _Nullable)queue
+                                        error:(NSError *_Nullable *_Nullable)error {
+  return edo_WaitForConnection(
+      ^(EDOSocketConnectedBlock block) {
+        [self connectWithSocketPath:path queue:queue connectedBlock:block];
+      },
+      error);
 }
 
 - (instancetype)initWithSocket:(dispatch_fd_t)socket {
@@ -177,54 +331,28 @@ static void edo_RunHandlerWithErrorInQueueWithBlock(int code, dispatch_queue_t q
   block = block ?: gNoOpHandlerBlock;
   queue = queue ?: dispatch_queue_create("com.google.edo.connectSocket", DISPATCH_QUEUE_SERIAL);
 
-  int socketErr = 0;
-  dispatch_fd_t socketFD = edo_CreateSocket(&socketErr);
-  if (socketFD == -1) {
-    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
-    return;
-  }
-
-  // The dispatch source to wait on the connection.
-  dispatch_source_t source =
-      dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, (uintptr_t)socketFD, 0, queue);
-
-  dispatch_source_set_event_handler(source, ^{
-    int connectError = 0;
-    socklen_t errorlen = sizeof(connectError);
-
-    // If there is an error, the connection fails.
-    if (getsockopt(socketFD, SOL_SOCKET, SO_ERROR, &connectError, &errorlen) != 0 ||
-        connectError != 0) {
-      edo_RunHandlerWithErrorInQueueWithBlock(connectError, queue, block);
-    } else {
-      // Prevent SIGPIPE, suggested by Apple.
-      // https://developer.apple.com/library/archive/documentation/NetworkingInternetWeb/Conceptual/NetworkingOverview/CommonPitfalls/CommonPitfalls.html
-      int on = 1;
-      setsockopt(socketFD, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
-      block([EDOSocket socketWithSocket:socketFD], nil);
-    }
-
-    // Once connected, we don't need this source any more; so we don't track this internally.
-    // This will also effectively release the strong reference of the source so it breaks the
-    // retain cycle as after the source is cancelled, the event handler will get released.
-    dispatch_source_cancel(source);
-  });
-
-  dispatch_resume(source);
-
   // Setup a sockaddr with the default local loopback address 127.0.0.1 to connect to.
   struct sockaddr_in addr;
   memset(&addr, 0, sizeof(addr));
   addr.sin_family = AF_INET;
   addr.sin_port = htons(port);
   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  edo_ConnectSocket(AF_INET, (struct sockaddr const *)&addr, sizeof(addr), queue, block);
+}
 
-  int ret = connect(socketFD, (struct sockaddr const *)&addr, sizeof(addr));
-  socketErr = errno;
-  if (ret != 0 && socketErr != EINPROGRESS) {
-    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
-    close(socketFD);
++ (void)connectWithSocketPath:(NSString *)path
+                        queue:(dispatch_queue_t)queue
+               connectedBlock:(EDOSocketConnectedBlock)block {
+  block = block ?: gNoOpHandlerBlock;
+  queue = queue ?: dispatch_queue_create("com.google.edo.connectSocket", DISPATCH_QUEUE_SERIAL);
+
+  struct sockaddr_un addr;
+  int addressErr = edo_FillUnixSocketAddress(path, &addr);
+  if (addressErr != 0) {
+    edo_RunHandlerWithErrorInQueueWithBlock(addressErr, queue, block);
+    return;
   }
+  edo_ConnectSocket(AF_UNIX, (struct sockaddr const *)&addr, sizeof(addr), queue, block);
 }
 
 + (EDOSocket *)listenWithTCPPort:(UInt16)port
@@ -234,7 +362,7 @@ static void edo_RunHandlerWithErrorInQueueWithBlock(int code, dispatch_queue_t q
   queue = queue ?: dispatch_queue_create("com.google.edo.listenSocket", DISPATCH_QUEUE_CONCURRENT);
 
   int socketErr = 0;
-  dispatch_fd_t socketFD = edo_CreateSocket(&socketErr);
+  dispatch_fd_t socketFD = edo_CreateSocket(AF_INET, &socketErr);
   if (socketFD == -1) {
     edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
     return nil;
@@ -269,4 +397,43 @@ static void edo_RunHandlerWithErrorInQueueWithBlock(int code, dispatch_queue_t q
                                   }];
 }
 
++ (EDOSocket *)listenWithSocketPath:(NSString *)path
+                              queue:(dispatch_queue_t)queue
+                     connectedBlock:(EDOSocketConnectedBlock)block {
+  block = block ?: gNoOpHandlerBlock;
+  queue = queue ?: dispatch_queue_create("com.google.edo.listenSocket", DISPATCH_QUEUE_CONCURRENT);
+
+  struct sockaddr_un addr;
+  int socketErr = edo_FillUnixSocketAddress(path, &addr);
+  if (socketErr != 0) {
+    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
+    return nil;
+  }
+
+  dispatch_fd_t socketFD = edo_CreateSocket(AF_UNIX, &socketErr);
+  if (socketFD == -1) {
+    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
+    return nil;
+  }
+
+  socketErr = edo_RemoveStaleSocketFile(&addr);
+  if (socketErr != 0) {
+    edo_RunHandlerWithErrorInQueueWithBlock(socketErr, queue, block);
+    close(socketFD);
+    return nil;
+  }
+  if (bind(socketFD, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    close(socketFD);
+    return nil;
+  }
+
+  return [EDOListenSocket listenSocketWithSocket:socketFD
+                                  connectedBlock:^(EDOSocket *socket, NSError *error) {
+                                    // dispatch the block to the user's queue
+                                    dispatch_async(queue, ^{
+                                      block(socket, nil);
+                                    });
+                                  }];
+}
+
 @end
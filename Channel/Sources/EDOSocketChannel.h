@@ -22,18 +22,105 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class EDOSocket;
 
+/**
+ * The block to be invoked when the peer opens a new stream.
+ *
+ * @param stream The new stream, which is closed if the block doesn't retain it.
+ */
+typedef void (^EDOSocketChannelStreamHandler)(id<EDOChannel> stream);
+
+/**
+ * The block to be invoked with each chunk of the frame received from the channel.
+ *
+ * @param channel  The channel that receives the frame.
+ * @param chunk    The next part of the frame, or @c nil if the channel is closed.
+ * @param complete Whether the chunk is the last one of the frame.
+ * @param error    The error if the channel fails to receive the frame.
+ */
+typedef void (^EDOSocketChannelChunkHandler)(id<EDOChannel> channel,
+                                             dispatch_data_t _Nullable chunk, BOOL complete,
+                                             NSError *_Nullable error);
+
 /**
  * The channel implemented using dispatch I/O.
  *
  * It uses dispatch I/O API to process the non-blocking I/O operations. The channel manages a
- * header frame to ensure the integrity of each data block received. If two consecutive receiving
- * blocks are scheduled at once, it may interrupt how the channel interpret the header frame. The
- * caller shall schedule another receiving callback only after the previous one is completed.
+ * header frame to ensure the integrity of each data block received. Once the first receiving block
+ * is scheduled, the channel keeps reading into a buffer and parses all the frames available at
+ * each wakeup. The frames are handed to the receiving blocks in the order they are scheduled, and
+ * the frames that arrive before any receiving block is scheduled are kept until the next one.
+ *
+ * The channel sends the version 1 frame header, which every peer understands and which advertises
+ * the latest version this side can parse. Once a frame from the peer advertises the version 2
+ * header, the channel sends the version 2 header from then on.
+ *
+ * On top of the version 2 header, the channel multiplexes streams over the same socket. Each stream
+ * is an @c EDOChannel on its own with a separate handler queue, and the frames are routed to the
+ * stream by the stream identifier in the header. The channel itself is the stream 0, which is the
+ * only stream the older peers use.
+ *
+ * Once the peer advertises that it reassembles the chunks, a payload larger than a megabyte is sent
+ * as a series of continuation frames, so the peer can consume it as it arrives. The payload sent to
+ * the peer is bounded by a window of each stream, and the peer grants more credit only after the
+ * data is handed to its receiving blocks. A stream that the peer stops receiving on holds back its
+ * frames that don't fit in the window instead of buffering them without a limit, while the other
+ * streams keep going.
  *
  * TODO(haowoo): Rename this to EDODispatchChannel as it is a wrapper around dispatch_io_t.
  */
 @interface EDOSocketChannel : NSObject <EDOChannel>
 
+/**
+ * Whether the channels read and write on the shared socket reactor, which applies to the channels
+ * created afterwards, including the ones of the host services and the channel pools. The default
+ * value is @c NO.
+ *
+ * By default, each channel keeps a dispatch I/O read outstanding and parses the frames on its own
+ * handler queue. With the reactor, a single thread waits for the sockets of all the channels and
+ * parses the frames, and only the complete frames are dispatched to the handler queues. This saves
+ * the queue wakeups when a process has many connections that are mostly idle. The frames are also
+ * written with a single gathered write on the sending thread, and the reactor thread only finishes
+ * the writes that the socket buffer can't take right away, which saves the system calls and the
+ * queue hops of dispatch I/O for every write.
+ */
+@property(class) BOOL usesSharedReactor;
+
+/**
+ * The block to be invoked on the handler queue when the peer opens a new stream.
+ *
+ * The channel only advertises that it accepts new streams when the handler is set, and the frames
+ * of new streams are dropped if it is not set. It should be set before any data is sent.
+ */
+@property(nullable, copy) EDOSocketChannelStreamHandler streamHandler;
+
+/**
+ * Whether the peer accepts new streams on this channel.
+ *
+ * This is only known after the channel receives a frame from the peer.
+ */
+@property(readonly, getter=isMultiplexingSupported) BOOL multiplexingSupported;
+
+/**
+ * The time in nanoseconds to wait for more frames before writing a frame, 0 by default.
+ *
+ * The frames sent while a write is outstanding are always coalesced into the next write. With a
+ * nonzero interval, a frame sent while the channel is idle also waits for the frames that follow
+ * within the interval, which trades the latency for fewer writes. Use @c flush to write the
+ * pending frames right away.
+ */
+@property uint64_t writeCoalescingIntervalInNano;
+
+/** The number of frames sent on the channel and its streams. */
+@property(readonly) uint64_t sentFrameCount;
+
+/**
+ * The number of writes issued for the sent frames.
+ *
+ * Each write is a single gathered write to the socket, so the difference to @c sentFrameCount is
+ * the number of writes saved by the coalescing.
+ */
+@property(readonly) uint64_t writeCount;
+
 /**
  * Initializes a channel with the established socket.
  *
@@ -62,6 +149,32 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithDispatchIO:(dispatch_io_t)channel;
 
+/**
+ * Opens a new stream that shares the socket of this channel.
+ *
+ * The stream is closed for both sides when it is invalidated or released.
+ *
+ * @return The new stream, or @c nil if the peer doesn't accept new streams.
+ */
+- (nullable id<EDOChannel>)openStream;
+
+/** Writes the frames waiting for the coalescing interval right away. */
+- (void)flush;
+
+/**
+ * Receives the next frame of the channel in chunks as they arrive.
+ *
+ * The handler is invoked with each chunk in order until the one that completes the frame, and the
+ * peer is only credited for a chunk after the handler returns, so a slow handler slows down the
+ * peer instead of having the frame buffered. The chunks of a frame sent by a peer without the
+ * chunks, or read before the handler is scheduled, are handed over together.
+ *
+ * @param queue   The serial queue on which the handler is invoked.
+ * @param handler The handler to receive the chunks of the frame.
+ */
+- (void)receiveChunksWithQueue:(dispatch_queue_t)queue
+                       handler:(EDOSocketChannelChunkHandler)handler;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -19,11 +19,191 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <sys/un.h>
 
+#import "Channel/Sources/EDOBufferPool.h"
 #import "Channel/Sources/EDOChannel.h"
 #import "Channel/Sources/EDOChannelUtil.h"
 #import "Channel/Sources/EDOSocket.h"
+#import "Channel/Sources/EDOSocketReactor.h"
+
+/** The stream identifier of the channel itself, which is used by the peers without streams. */
+static const uint32_t kEDOSocketChannelDefaultStreamID = 0;
+
+/** The largest payload of a frame sent to the peer that reassembles the continuation frames. */
+static const size_t kEDOSocketChannelChunkSize = 1 << 20;
+
+/**
+ * The largest payload of a version 2 frame, which bounds the memory buffered for a frame whose
+ * 64-bit size comes from the peer. The version 1 frames keep their 32-bit limit for older peers.
+ */
+static const uint64_t kEDOSocketChannelMaxPayloadSize = 1 << 30;
+
+/** The number of payload bytes of a stream that can be sent before the peer grants more credit. */
+static const int64_t kEDOSocketChannelWindowSize = 8 << 20;
+
+/** Whether the new channels read and write on the shared socket reactor instead of dispatch I/O. */
+static BOOL gUsesSharedReactor = NO;
+
+/**
+ * The block to process a chunk of a frame received from the channel, or the error that closes the
+ * channel.
+ *
+ * The block is invoked with each chunk of the frame as it arrives, and @c complete is @c YES for
+ * the last one. It is invoked with a @c nil frame and @c complete being @c YES if the channel is
+ * closed.
+ */
+typedef void (^EDOSocketFrameHandler)(dispatch_data_t _Nullable frame, BOOL complete,
+                                      NSError *_Nullable error);
+
+/** The block to complete a frame sent to the channel with the error code of the write. */
+typedef void (^EDOSocketFrameSentHandler)(int errCode);
+
+#pragma mark - Pending Frame
+
+/** The frame that waits for the flow-control credit to be sent. */
+@interface EDOSocketPendingFrame : NSObject
+/** The frame including its header. */
+@property(readonly, nonatomic) dispatch_data_t data;
+/** The number of payload bytes that the frame takes from the send window. */
+@property(readonly, nonatomic) size_t cost;
+/** The block to complete the frame with the error code of the write. */
+@property(readonly, nonatomic) EDOSocketFrameSentHandler sentHandler;
+
+- (instancetype)initWithData:(dispatch_data_t)data
+                        cost:(size_t)cost
+                 sentHandler:(EDOSocketFrameSentHandler)sentHandler;
+@end
+
+@implementation EDOSocketPendingFrame
+
+- (instancetype)initWithData:(dispatch_data_t)data
+                        cost:(size_t)cost
+                 sentHandler:(EDOSocketFrameSentHandler)sentHandler {
+  self = [super init];
+  if (self) {
+    _data = data;
+    _cost = cost;
+    _sentHandler = sentHandler;
+  }
+  return self;
+}
+
+@end
+
+#pragma mark - Frame Queue
+
+/**
+ * The frames received on a stream and the receive handlers waiting for them.
+ *
+ * The frame queue is not thread-safe, and it is only accessed while the owning channel is locked.
+ */
+@interface EDOSocketFrameQueue : NSObject
+/** Whether the stream is closed and no more frames will be received. */
+@property(readonly, nonatomic, getter=isClosed) BOOL closed;
+
+/** The number of payload bytes that are kept because no handler is waiting for them. */
+@property(readonly, nonatomic) size_t bufferedSize;
+
+/**
+ * Hands the chunk to the oldest pending handler, or keeps it if there is none.
+ *
+ * @param chunk    The payload of the frame, which is a part of a larger frame if not @c complete.
+ * @param complete Whether the chunk is the last one of the frame.
+ */
+- (void)enqueueChunk:(dispatch_data_t)chunk complete:(BOOL)complete;
+
+/**
+ * Adds the handler to receive the next frame.
+ *
+ * @param handler The handler to receive the frame.
+ * @param wait    Whether the handler can wait for a frame that hasn't arrived yet.
+ *
+ * @return @c YES if the handler is invoked with a received frame or scheduled to wait for one;
+ *         @c NO if there is no frame left and the stream is closed or the handler can't wait.
+ */
+- (BOOL)addHandler:(EDOSocketFrameHandler)handler waitsForFrame:(BOOL)wait;
+
+/**
+ * Closes the stream.
+ *
+ * @param notifyHandlers Whether to invoke the pending handlers with the @c error.
+ * @param error          The error to close the stream with, or @c nil for a graceful closure.
+ */
+- (void)closeAndNotifyHandlers:(BOOL)notifyHandlers error:(NSError *_Nullable)error;
+@end
+
+@implementation EDOSocketFrameQueue {
+  // The payloads of the frames that are read before any receive handler is scheduled.
+  NSMutableArray<dispatch_data_t> *_receivedFrames;
+  // The chunks of the frame that is still being read, after all the frames in _receivedFrames.
+  dispatch_data_t _partialFrame;
+  // The pending receive handlers, in the order they are scheduled. The first one may have been
+  // handed some chunks of its frame already.
+  NSMutableArray<EDOSocketFrameHandler> *_frameHandlers;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _receivedFrames = [[NSMutableArray alloc] init];
+    _frameHandlers = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (void)enqueueChunk:(dispatch_data_t)chunk complete:(BOOL)complete {
+  // A handler is only waiting when nothing is kept, so the chunks are delivered in order.
+  if (_frameHandlers.count > 0) {
+    _frameHandlers.firstObject(chunk, complete, nil);
+    if (complete) {
+      [_frameHandlers removeObjectAtIndex:0];
+    }
+    return;
+  }
+  _bufferedSize += dispatch_data_get_size(chunk);
+  _partialFrame = _partialFrame ? dispatch_data_create_concat(_partialFrame, chunk) : chunk;
+  if (complete) {
+    [_receivedFrames addObject:_partialFrame];
+    _partialFrame = nil;
+  }
+}
+
+- (BOOL)addHandler:(EDOSocketFrameHandler)handler waitsForFrame:(BOOL)wait {
+  // The frames that are already read are still delivered after the stream is closed.
+  if (_receivedFrames.count > 0) {
+    dispatch_data_t frame = _receivedFrames.firstObject;
+    [_receivedFrames removeObjectAtIndex:0];
+    _bufferedSize -= dispatch_data_get_size(frame);
+    handler(frame, YES, nil);
+    return YES;
+  }
+  if (_closed || !wait) {
+    return NO;
+  }
+  [_frameHandlers addObject:handler];
+  if (_partialFrame) {
+    // The handler starts with what is read so far and receives the rest as it arrives.
+    dispatch_data_t partialFrame = _partialFrame;
+    _partialFrame = nil;
+    _bufferedSize -= dispatch_data_get_size(partialFrame);
+    handler(partialFrame, NO, nil);
+  }
+  return YES;
+}
+
+- (void)closeAndNotifyHandlers:(BOOL)notifyHandlers error:(NSError *)error {
+  _closed = YES;
+  if (notifyHandlers) {
+    for (EDOSocketFrameHandler handler in _frameHandlers) {
+      handler(nil, YES, error);
+    }
+  }
+  [_frameHandlers removeAllObjects];
+}
+
+@end
 
 #pragma mark - Socket Connection Extension
 
@@ -32,12 +212,177 @@
 @property(readonly, nonatomic) dispatch_io_t channel;
 // The dispatch queue where the receive handler block will be dispatched to.
 @property(readonly, nonatomic) dispatch_queue_t handlerQueue;
+// The pool of the buffers that the received frames are decoded from.
+@property(readonly, nonatomic) EDOBufferPool *receiveBufferPool;
+
+/** Sends the data as a frame of the stream and invokes the handler with the given channel. */
+- (void)edo_sendData:(dispatch_data_t)data
+              onStream:(uint32_t)streamID
+           fromChannel:(id<EDOChannel>)channel
+          handlerQueue:(dispatch_queue_t)handlerQueue
+     completionHandler:(EDOChannelSentHandler _Nullable)handler;
+
+/** Schedules the handler to receive the next frame of the stream on the given queue. */
+- (void)edo_receiveOnStream:(uint32_t)streamID
+                 forChannel:(id<EDOChannel>)channel
+                      queue:(dispatch_queue_t)queue
+                    handler:(EDOChannelReceiveDispatchDataHandler _Nullable)handler;
+
+/** Whether the stream is open and the channel is valid. */
+- (BOOL)edo_isStreamValid:(uint32_t)streamID;
+
+/** Closes the stream and lets the peer know if the channel is still valid. */
+- (void)edo_closeStream:(uint32_t)streamID;
+@end
+
+#pragma mark - Socket Channel Stream
+
+/**
+ * The logical channel that shares the socket of an @c EDOSocketChannel with other streams.
+ *
+ * Each stream has its own serial handler queue so the requests on different streams are not
+ * blocked by each other.
+ */
+@interface EDOSocketChannelStream : NSObject <EDOChannel>
+- (instancetype)initWithChannel:(EDOSocketChannel *)channel streamID:(uint32_t)streamID;
+@end
+
+@implementation EDOSocketChannelStream {
+  // The channel that the stream is multiplexed on.
+  EDOSocketChannel *_channel;
+  // The identifier of the stream.
+  uint32_t _streamID;
+  // The dispatch queue where the handler blocks of the stream will be dispatched to.
+  dispatch_queue_t _handlerQueue;
+}
+@dynamic valid;
+
+- (instancetype)initWithChannel:(EDOSocketChannel *)channel streamID:(uint32_t)streamID {
+  self = [super init];
+  if (self) {
+    _channel = channel;
+    _streamID = streamID;
+    dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(
+        DISPATCH_QUEUE_SERIAL, dispatch_queue_get_qos_class(channel.handlerQueue, NULL), 0);
+    _handlerQueue = dispatch_queue_create("com.google.edo.socketChannel.stream", attributes);
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [self invalidate];
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"<%@: %p; stream %u of %@>", self.class, self, _streamID,
+                                    _channel];
+}
+
+#pragma mark - EDOChannel
+
+- (void)sendData:(NSData *)data withCompletionHandler:(EDOChannelSentHandler)handler {
+  [self sendDispatchData:EDOCreateDispatchDataFromSegments(@[ data ], _handlerQueue)
+      withCompletionHandler:handler];
+}
+
+- (void)sendDispatchData:(dispatch_data_t)data
+    withCompletionHandler:(EDOChannelSentHandler)handler {
+  [_channel edo_sendData:data
+                 onStream:_streamID
+              fromChannel:self
+             handlerQueue:_handlerQueue
+        completionHandler:handler];
+}
+
+- (void)receiveDataWithHandler:(EDOChannelReceiveHandler)handler {
+  [self receiveDataWithQueue:_handlerQueue handler:handler];
+}
+
+- (void)receiveDataWithQueue:(dispatch_queue_t)queue
+                     handler:(EDOChannelReceiveHandler _Nullable)handler {
+  EDOBufferPool *bufferPool = _channel.receiveBufferPool;
+  [self receiveDispatchDataWithQueue:queue
+                             handler:^(id<EDOChannel> channel, dispatch_data_t data,
+                                       NSError *error) {
+                               if (handler) {
+                                 NSData *frame =
+                                     data ? [bufferPool dataWithDispatchData:data] : nil;
+                                 handler(channel, frame, error);
+                               }
+                             }];
+}
+
+- (void)receiveDispatchDataWithQueue:(dispatch_queue_t)queue
+                             handler:(EDOChannelReceiveDispatchDataHandler _Nullable)handler {
+  [_channel edo_receiveOnStream:_streamID forChannel:self queue:queue handler:handler];
+}
+
+/** @see -[EDOChannel isValid] */
+- (BOOL)isValid {
+  return [_channel edo_isStreamValid:_streamID];
+}
+
+/** @see -[EDOChannel invalidate] */
+- (void)invalidate {
+  [_channel edo_closeStream:_streamID];
+}
+
 @end
 
 #pragma mark - Socket Connection
 
-@implementation EDOSocketChannel
+@implementation EDOSocketChannel {
+  // The bytes that are read from the channel but don't form a complete frame yet.
+  dispatch_data_t _bufferedData;
+  // The frame queues of the open streams, including the default stream of the channel itself.
+  NSMutableDictionary<NSNumber *, EDOSocketFrameQueue *> *_frameQueues;
+  // Whether the channel has started reading; the read is only started on the first receive.
+  BOOL _readingStarted;
+  // The registration on the shared reactor if the channel reads on it, until it is invalidated.
+  EDOSocketReactorSource *_readSource;
+  // Whether the frames are read and written on the shared reactor instead of dispatch I/O.
+  BOOL _usesReactor;
+  // The writes outstanding on the reactor, which the descriptor is only closed after.
+  dispatch_group_t _writeGroup;
+  // The frame header version to send, which is upgraded once the peer advertises a newer one.
+  EDOFrameHeaderVersion _peerFrameVersion;
+  // The capabilities advertised by the latest frame of the peer.
+  EDOFrameCapabilities _peerCapabilities;
+  // The identifier of the next stream to open; the opening side only uses odd numbers.
+  uint32_t _nextStreamID;
+  // The highest identifier of the streams opened by the peer. The identifiers only increase, so
+  // a frame of an unknown stream at or below it belongs to a stream that is already closed.
+  uint32_t _highestPeerStreamID;
+  // The frames waiting to be written together by the next write.
+  dispatch_data_t _pendingWriteData;
+  // The completion blocks of the pending frames, in the order they are sent.
+  NSMutableArray<EDOSocketFrameSentHandler> *_pendingWriteHandlers;
+  // Whether a write is outstanding, during which the frames being sent are coalesced.
+  BOOL _writing;
+  // Whether the pending frames are scheduled to be written after the coalescing interval.
+  BOOL _flushScheduled;
+  // The number of frames sent and the number of writes issued for them.
+  uint64_t _sentFrameCount;
+  uint64_t _writeCount;
+  // The number of payload bytes of each stream that can still be sent before the peer grants more
+  // credit. The streams with the full window are not kept.
+  NSMutableDictionary<NSNumber *, NSNumber *> *_sendWindows;
+  // The frames of each stream waiting for the credit from the peer, in the order they are sent.
+  NSMutableDictionary<NSNumber *, NSMutableArray<EDOSocketPendingFrame *> *> *_blockedFrames;
+  // The number of payload bytes of each stream consumed by the receivers but not credited to the
+  // peer yet.
+  NSMutableDictionary<NSNumber *, NSNumber *> *_unacknowledgedSizes;
+}
 @dynamic valid;
+@dynamic multiplexingSupported;
+
++ (BOOL)usesSharedReactor {
+  return gUsesSharedReactor;
+}
+
++ (void)setUsesSharedReactor:(BOOL)usesSharedReactor {
+  gUsesSharedReactor = usesSharedReactor;
+}
 
 + (instancetype)channelWithSocket:(EDOSocket *)socket {
   return [self channelWithSocket:socket handlerQueue:nil];
@@ -58,6 +403,19 @@
   self = [self initWithHandlerQueue:handlerQueue];
   if (self) {
     _channel = channel;
+    if (gUsesSharedReactor) {
+      _usesReactor = YES;
+      _writeGroup = dispatch_group_create();
+      // The reactor writes to the descriptor directly, which must neither block the sending thread
+      // nor raise SIGPIPE when the peer goes away.
+      dispatch_fd_t descriptor = dispatch_io_get_descriptor(channel);
+      int flags = fcntl(descriptor, F_GETFL);
+      if (flags != -1) {
+        fcntl(descriptor, F_SETFL, flags | O_NONBLOCK);
+      }
+      int on = 1;
+      setsockopt(descriptor, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
   }
   return self;
 }
@@ -77,6 +435,15 @@
           DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
       _handlerQueue = dispatch_queue_create("com.google.edo.socketChannel.handler", attributes);
     }
+    _peerFrameVersion = EDOFrameHeaderVersion1;
+    _nextStreamID = 1;
+    _frameQueues = [[NSMutableDictionary alloc] init];
+    _frameQueues[@(kEDOSocketChannelDefaultStreamID)] = [[EDOSocketFrameQueue alloc] init];
+    _pendingWriteHandlers = [[NSMutableArray alloc] init];
+    _sendWindows = [[NSMutableDictionary alloc] init];
+    _blockedFrames = [[NSMutableDictionary alloc] init];
+    _unacknowledgedSizes = [[NSMutableDictionary alloc] init];
+    _receiveBufferPool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
   }
   return self;
 }
@@ -85,36 +452,72 @@
   [self invalidate];
 }
 
-#pragma mark - EDOChannel
+- (BOOL)isMultiplexingSupported {
+  @synchronized(self) {
+    return _channel != NULL && _peerFrameVersion >= EDOFrameHeaderVersion2 &&
+           (_peerCapabilities & EDOFrameCapabilitiesStreams) != 0;
+  }
+}
 
-- (void)sendData:(NSData *)data withCompletionHandler:(EDOChannelSentHandler)handler {
-  dispatch_queue_t handlerQueue = self.handlerQueue;
-  if (!self.channel) {
-    dispatch_async(handlerQueue, ^{
-      if (handler) {
-        handler(self, [NSError errorWithDomain:NSPOSIXErrorDomain code:0 userInfo:nil]);
+- (id<EDOChannel>)openStream {
+  @synchronized(self) {
+    if (!self.multiplexingSupported) {
+      return nil;
+    }
+    uint32_t streamID = _nextStreamID;
+    _nextStreamID += 2;
+    _frameQueues[@(streamID)] = [[EDOSocketFrameQueue alloc] init];
+    return [[EDOSocketChannelStream alloc] initWithChannel:self streamID:streamID];
+  }
+}
+
+- (void)flush {
+  @synchronized(self) {
+    [self edo_writePendingFrames];
+  }
+}
+
+- (uint64_t)sentFrameCount {
+  @synchronized(self) {
+    return _sentFrameCount;
+  }
+}
+
+- (uint64_t)writeCount {
+  @synchronized(self) {
+    return _writeCount;
+  }
+}
+
+- (void)receiveChunksWithQueue:(dispatch_queue_t)queue
+                       handler:(EDOSocketChannelChunkHandler)handler {
+  EDOSocketFrameHandler frameHandler = ^(dispatch_data_t chunk, BOOL complete, NSError *error) {
+    dispatch_async(queue, ^{
+      handler(self, chunk, complete, error);
+      if (chunk) {
+        // The chunk is only credited once it is consumed, so a slow reader holds back the peer.
+        [self edo_acknowledgeReceivedSize:dispatch_data_get_size(chunk)
+                                 onStream:kEDOSocketChannelDefaultStreamID];
       }
     });
-    return;
-  }
+  };
+  [self edo_addFrameHandler:frameHandler onStream:kEDOSocketChannelDefaultStreamID];
+}
 
-  dispatch_data_t totalData = EDOBuildFrameFromDataWithQueue(data, handlerQueue);
-  dispatch_io_write(
-      self.channel, 0, totalData, handlerQueue, ^(bool done, dispatch_data_t _, int errCode) {
-        if (!done) {
-          return;
-        }
+#pragma mark - EDOChannel
 
-        if (handler) {
-          dispatch_async(handlerQueue, ^{
-            NSError *error;
-            if (errCode != 0) {
-              error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errCode userInfo:nil];
-            }
-            handler(self, error);
-          });
-        }
-      });
+- (void)sendData:(NSData *)data withCompletionHandler:(EDOChannelSentHandler)handler {
+  [self sendDispatchData:EDOCreateDispatchDataFromSegments(@[ data ], self.handlerQueue)
+      withCompletionHandler:handler];
+}
+
+- (void)sendDispatchData:(dispatch_data_t)data
+    withCompletionHandler:(EDOChannelSentHandler)handler {
+  [self edo_sendData:data
+               onStream:kEDOSocketChannelDefaultStreamID
+            fromChannel:self
+           handlerQueue:self.handlerQueue
+      completionHandler:handler];
 }
 
 - (void)receiveDataWithHandler:(EDOChannelReceiveHandler)handler {
@@ -123,115 +526,622 @@
 
 - (void)receiveDataWithQueue:(dispatch_queue_t)queue
                      handler:(EDOChannelReceiveHandler _Nullable)handler {
-  dispatch_queue_t handlerQueue = queue;
-  dispatch_io_t channel = self.channel;
-  if (!channel) {
-    dispatch_async(handlerQueue, ^{
-      // TODO(haowoo): Add better error code define.
-      handler(self, nil,
-              [NSError errorWithDomain:NSInternalInconsistencyException code:0 userInfo:nil]);
-    });
-    return;
+  EDOBufferPool *bufferPool = self.receiveBufferPool;
+  [self receiveDispatchDataWithQueue:queue
+                             handler:^(id<EDOChannel> channel, dispatch_data_t data,
+                                       NSError *error) {
+                               if (handler) {
+                                 NSData *frame =
+                                     data ? [bufferPool dataWithDispatchData:data] : nil;
+                                 handler(channel, frame, error);
+                               }
+                             }];
+}
+
+- (void)receiveDispatchDataWithQueue:(dispatch_queue_t)queue
+                             handler:(EDOChannelReceiveDispatchDataHandler _Nullable)handler {
+  [self edo_receiveOnStream:kEDOSocketChannelDefaultStreamID
+                 forChannel:self
+                      queue:queue
+                    handler:handler];
+}
+
+/** @see -[EDOChannel isValid] */
+- (BOOL)isValid {
+  @synchronized(self) {
+    return _channel != NULL;
   }
+}
 
-  // Accessing __block variable has to be atomic in order to prevent from data racing. Here because
-  // ARC inserts release at the end of scope such that reads and writes can happen in different
-  // threads/queues, using handlerQueue as an isolation queue to ensure its atomicity. For detail,
-  // see b/171321939.
-  dispatch_async(handlerQueue, ^{
-    __block dispatch_data_t dataReceived;
-    __block size_t remainingDataSize;
-    dispatch_io_handler_t dataHandler = ^(bool done, dispatch_data_t data, int error) {
-      if (error || !data) {
-        if (handler) {
-          dispatch_async(handlerQueue, ^{
-            handler(self, nil,
-                    [NSError errorWithDomain:NSPOSIXErrorDomain code:error userInfo:nil]);
-          });
+/** @see -[EDOChannel invalidate] */
+- (void)invalidate {
+  @synchronized(self) {
+    if (_channel) {
+      // The frames already sent are still written before the channel is closed, but not the ones
+      // waiting for the credit from the peer.
+      [self edo_writePendingFrames];
+      for (NSArray<EDOSocketPendingFrame *> *blockedFrames in _blockedFrames.allValues) {
+        for (EDOSocketPendingFrame *frame in blockedFrames) {
+          if (frame.sentHandler) {
+            frame.sentHandler(ECANCELED);
+          }
         }
-        return;
       }
-      remainingDataSize -= dispatch_data_get_size(data);
-      dataReceived = dataReceived ? dispatch_data_create_concat(dataReceived, data) : data;
-
-      if (remainingDataSize > 0) {
-        return;
+      [_blockedFrames removeAllObjects];
+      if (_usesReactor) {
+        // The reactor stops reading before the descriptor is closed, and nothing ends the pending
+        // receives but the channel itself.
+        [_readSource cancel];
+        _readSource = nil;
+        for (EDOSocketFrameQueue *frameQueue in _frameQueues.allValues) {
+          [frameQueue closeAndNotifyHandlers:YES error:nil];
+        }
+        _bufferedData = nil;
+        // The dispatch I/O channel doesn't know about the writes on the reactor, so the descriptor
+        // is closed once they finish.
+        dispatch_io_t channel = _channel;
+        dispatch_group_notify(_writeGroup, _handlerQueue, ^{
+          dispatch_io_close(channel, 0);
+        });
+      } else {
+        dispatch_io_close_flags_t flags = 0;
+        // The outstanding read never completes by itself. Shutting down the read side ends it with
+        // EOF while letting the pending writes finish; stop all the operations for non-sockets.
+        if (_readingStarted && shutdown(dispatch_io_get_descriptor(_channel), SHUT_RD) != 0) {
+          flags = DISPATCH_IO_STOP;
+        }
+        dispatch_io_close(_channel, flags);
       }
+      _channel = NULL;
+    }
+  }
+}
 
-      NSMutableData *receivedData =
-          [NSMutableData dataWithCapacity:dispatch_data_get_size(dataReceived)];
-      dispatch_data_apply(dataReceived, ^bool(dispatch_data_t region, size_t offset,
-                                              const void *buffer, size_t size) {
-        [receivedData appendBytes:buffer length:size];
-        return YES;
-      });
+#pragma mark - Private
 
+- (void)edo_sendData:(dispatch_data_t)data
+              onStream:(uint32_t)streamID
+           fromChannel:(id<EDOChannel>)channel
+          handlerQueue:(dispatch_queue_t)handlerQueue
+     completionHandler:(EDOChannelSentHandler)handler {
+  dispatch_io_t dispatchChannel;
+  BOOL chunked;
+  EDOFrameHeader header = {.streamID = streamID};
+  @synchronized(self) {
+    dispatchChannel = _channel;
+    // The streams are only opened after the peer supports the version 2 header.
+    header.version = streamID == kEDOSocketChannelDefaultStreamID ? _peerFrameVersion
+                                                                  : EDOFrameHeaderVersion2;
+    header.capabilities = [self edo_advertisedCapabilities];
+    chunked = [self edo_isFlowControlled];
+  }
+  if (!dispatchChannel) {
+    dispatch_async(handlerQueue, ^{
       if (handler) {
-        dispatch_async(handlerQueue, ^{
-          handler(self, receivedData, nil);
-        });
+        handler(channel, [NSError errorWithDomain:NSPOSIXErrorDomain code:0 userInfo:nil]);
       }
-    };
+    });
+    return;
+  }
 
-    dispatch_io_handler_t frameHandler = ^(bool done, dispatch_data_t data, int error) {
-      size_t payloadSize = EDOGetPayloadSizeFromFrameData(data);
-      if (payloadSize > 0) {
-        remainingDataSize = payloadSize;
-        if (![self readDispatchIOWithDataSize:remainingDataSize handler:dataHandler] && handler) {
-          handler(self, nil, nil);
-        }
-      } else {
-        // Close the channel on errors and closed sockets.
-        if (error != 0 || payloadSize == 0) {
-          [self invalidate];
+  EDOSocketFrameSentHandler sentHandler = ^(int errCode) {
+    if (handler) {
+      dispatch_async(handlerQueue, ^{
+        NSError *error;
+        if (errCode != 0) {
+          error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errCode userInfo:nil];
         }
+        handler(channel, error);
+      });
+    }
+  };
 
-        // Execute the block on closing the channel.
-        if (payloadSize == 0 && error == 0 && handler) {
-          dispatch_async(handlerQueue, ^{
-            handler(self, nil, nil);
-          });
-        }
+  if (!chunked) {
+    if (header.version == EDOFrameHeaderVersion2 &&
+        dispatch_data_get_size(data) > kEDOSocketChannelMaxPayloadSize) {
+      sentHandler(EMSGSIZE);
+      return;
+    }
+    [self edo_enqueueFrame:EDOBuildFrameFromDispatchDataWithHeader(data, header)
+                  onStream:streamID
+                      cost:0
+               sentHandler:sentHandler];
+    return;
+  }
+
+  // The large payload is split into the continuation frames, which the peer can consume as they
+  // arrive. The frames of the payload are queued together so the stream doesn't interleave them
+  // with another payload, and the handler completes with the last one.
+  size_t payloadSize = dispatch_data_get_size(data);
+  size_t offset = 0;
+  @synchronized(self) {
+    do {
+      size_t chunkSize = MIN(payloadSize - offset, kEDOSocketChannelChunkSize);
+      BOOL last = offset + chunkSize == payloadSize;
+      header.flags = last ? EDOFrameFlagsNone : EDOFrameFlagsContinuation;
+      dispatch_data_t chunk = dispatch_data_create_subrange(data, offset, chunkSize);
+      [self edo_enqueueFrame:EDOBuildFrameFromDispatchDataWithHeader(chunk, header)
+                    onStream:streamID
+                        cost:chunkSize
+                 sentHandler:last ? sentHandler : nil];
+      offset += chunkSize;
+    } while (offset < payloadSize);
+  }
+}
+
+/** The capabilities that this side advertises in the frame header. */
+- (EDOFrameCapabilities)edo_advertisedCapabilities {
+  EDOFrameCapabilities capabilities = EDOFrameCapabilitiesChunks;
+  if (self.streamHandler) {
+    capabilities |= EDOFrameCapabilitiesStreams;
+  }
+  return capabilities;
+}
+
+/**
+ * Whether the peer reassembles the continuation frames and grants the credit for the data.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (BOOL)edo_isFlowControlled {
+  return _peerFrameVersion >= EDOFrameHeaderVersion2 &&
+         (_peerCapabilities & EDOFrameCapabilitiesChunks) != 0;
+}
+
+/**
+ * Sends the frame once the send window of its stream has room for its payload.
+ *
+ * The frames of a stream are sent in order, so a frame waits behind the ones of the same stream
+ * blocked by the window even if it doesn't take any credit itself. The frames of other streams are
+ * not held back.
+ *
+ * @param frame       The frame including its header.
+ * @param streamID    The identifier of the stream that the frame belongs to.
+ * @param cost        The number of payload bytes that the frame takes from the send window.
+ * @param sentHandler The block to complete the frame with the error code of the write.
+ */
+- (void)edo_enqueueFrame:(dispatch_data_t)frame
+                onStream:(uint32_t)streamID
+                    cost:(size_t)cost
+             sentHandler:(EDOSocketFrameSentHandler)sentHandler {
+  @synchronized(self) {
+    NSNumber *streamKey = @(streamID);
+    NSMutableArray<EDOSocketPendingFrame *> *blockedFrames = _blockedFrames[streamKey];
+    int64_t sendWindow = [self edo_sendWindowOfStream:streamKey];
+    if (blockedFrames || (int64_t)cost > sendWindow) {
+      if (!blockedFrames) {
+        blockedFrames = [[NSMutableArray alloc] init];
+        _blockedFrames[streamKey] = blockedFrames;
       }
+      [blockedFrames addObject:[[EDOSocketPendingFrame alloc] initWithData:frame
+                                                                      cost:cost
+                                                               sentHandler:sentHandler]];
+      return;
+    }
+    [self edo_setSendWindow:sendWindow - (int64_t)cost ofStream:streamKey];
+    [self edo_scheduleFrame:frame sentHandler:sentHandler];
+  }
+}
+
+/**
+ * Gets the number of payload bytes that can still be sent on the stream.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (int64_t)edo_sendWindowOfStream:(NSNumber *)streamKey {
+  NSNumber *sendWindow = _sendWindows[streamKey];
+  return sendWindow ? sendWindow.longLongValue : kEDOSocketChannelWindowSize;
+}
+
+/**
+ * Sets the number of payload bytes that can still be sent on the stream.
+ *
+ * The window is capped at the full window, which isn't kept, so the streams that are closed and
+ * credited for all the data don't leave anything behind.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (void)edo_setSendWindow:(int64_t)sendWindow ofStream:(NSNumber *)streamKey {
+  if (sendWindow >= kEDOSocketChannelWindowSize) {
+    [_sendWindows removeObjectForKey:streamKey];
+  } else {
+    _sendWindows[streamKey] = @(sendWindow);
+  }
+}
+
+/**
+ * Sends the frames of the stream blocked by the window as long as the window has room for them.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (void)edo_releaseBlockedFramesOfStream:(NSNumber *)streamKey {
+  NSMutableArray<EDOSocketPendingFrame *> *blockedFrames = _blockedFrames[streamKey];
+  int64_t sendWindow = [self edo_sendWindowOfStream:streamKey];
+  while (blockedFrames.count > 0) {
+    EDOSocketPendingFrame *frame = blockedFrames.firstObject;
+    if ((int64_t)frame.cost > sendWindow) {
+      break;
+    }
+    [blockedFrames removeObjectAtIndex:0];
+    sendWindow -= (int64_t)frame.cost;
+    [self edo_scheduleFrame:frame.data sentHandler:frame.sentHandler];
+  }
+  if (blockedFrames.count == 0) {
+    [_blockedFrames removeObjectForKey:streamKey];
+  }
+  [self edo_setSendWindow:sendWindow ofStream:streamKey];
+}
+
+/**
+ * Grants the peer the credit for the payload bytes of the stream consumed by the receivers.
+ *
+ * The credit is accumulated and only sent once it reaches a quarter of the window, so not every
+ * frame is followed by a window update. The credit of a stream that is no longer open is sent right
+ * away as nothing else is consumed on it. The window update itself doesn't take any credit.
+ *
+ * @param size     The number of payload bytes consumed.
+ * @param streamID The identifier of the stream that the bytes are received on.
+ */
+- (void)edo_acknowledgeReceivedSize:(size_t)size onStream:(uint32_t)streamID {
+  @synchronized(self) {
+    if (!_channel || ![self edo_isFlowControlled]) {
+      return;
+    }
+    NSNumber *streamKey = @(streamID);
+    uint64_t unacknowledgedSize = _unacknowledgedSizes[streamKey].unsignedLongLongValue + size;
+    if (_frameQueues[streamKey] &&
+        unacknowledgedSize < (uint64_t)kEDOSocketChannelWindowSize / 4) {
+      _unacknowledgedSizes[streamKey] = @(unacknowledgedSize);
+      return;
+    }
+    [_unacknowledgedSizes removeObjectForKey:streamKey];
+    if (unacknowledgedSize == 0) {
+      return;
+    }
+    uint64_t credit = OSSwapHostToBigInt64(unacknowledgedSize);
+    EDOFrameHeader header = {
+        .version = EDOFrameHeaderVersion2,
+        .capabilities = [self edo_advertisedCapabilities],
+        .flags = EDOFrameFlagsWindowUpdate,
+        .streamID = streamID,
     };
+    dispatch_data_t payload = dispatch_data_create(&credit, sizeof(credit), NULL,
+                                                   DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+    [self edo_scheduleFrame:EDOBuildFrameFromDispatchDataWithHeader(payload, header)
+                sentHandler:nil];
+  }
+}
 
-    [self readDispatchIOWithDataSize:EDOGetPayloadHeaderSize() handler:frameHandler];
-  });
+/**
+ * Adds the frame to the pending frames and schedules them to be written.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (void)edo_scheduleFrame:(dispatch_data_t)frame
+              sentHandler:(EDOSocketFrameSentHandler)sentHandler {
+  _pendingWriteData =
+      _pendingWriteData ? dispatch_data_create_concat(_pendingWriteData, frame) : frame;
+  if (sentHandler) {
+    [_pendingWriteHandlers addObject:sentHandler];
+  }
+  _sentFrameCount += 1;
+  if (_writing || _flushScheduled) {
+    // The frame is written along with the others once the outstanding write completes or the
+    // coalescing interval elapses.
+    return;
+  }
+
+  uint64_t interval = self.writeCoalescingIntervalInNano;
+  if (interval == 0) {
+    [self edo_writePendingFrames];
+  } else {
+    _flushScheduled = YES;
+    __weak EDOSocketChannel *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), _handlerQueue, ^{
+      [weakSelf flush];
+    });
+  }
 }
 
-/** @see -[EDOChannel isValid] */
-- (BOOL)isValid {
+/**
+ * Writes all the pending frames with a single write.
+ *
+ * The frames sent while the write is outstanding are kept pending, and they are written together
+ * once it completes. Both the dispatch I/O channel and the reactor keep the writes in the order
+ * they are issued. On the reactor, the frames are written right away on the calling thread as far
+ * as the socket buffer takes them, so an idle channel sends a frame with one system call and no
+ * queue hop.
+ *
+ * @note The caller must hold the lock of self.
+ */
+- (void)edo_writePendingFrames {
+  if (!_pendingWriteData) {
+    return;
+  }
+  dispatch_data_t writeData = _pendingWriteData;
+  NSArray<EDOSocketFrameSentHandler> *sentHandlers = [_pendingWriteHandlers copy];
+  _pendingWriteData = nil;
+  [_pendingWriteHandlers removeAllObjects];
+  _flushScheduled = NO;
+
+  if (!_channel) {
+    for (EDOSocketFrameSentHandler sentHandler in sentHandlers) {
+      sentHandler(ECANCELED);
+    }
+    return;
+  }
+
+  _writing = YES;
+  _writeCount += 1;
+  // The write retains self until it completes, like the handlers of the frames do.
+  EDOSocketFrameSentHandler writeHandler = ^(int errCode) {
+    for (EDOSocketFrameSentHandler sentHandler in sentHandlers) {
+      sentHandler(errCode);
+    }
+    @synchronized(self) {
+      self->_writing = NO;
+      if (!self->_flushScheduled) {
+        [self edo_writePendingFrames];
+      }
+    }
+  };
+  if (_usesReactor) {
+    dispatch_group_t writeGroup = _writeGroup;
+    dispatch_group_enter(writeGroup);
+    [EDOSocketReactor.sharedReactor writeData:writeData
+                                 toDescriptor:dispatch_io_get_descriptor(_channel)
+                                      handler:^(int errCode) {
+                                        writeHandler(errCode);
+                                        dispatch_group_leave(writeGroup);
+                                      }];
+    return;
+  }
+  dispatch_io_write(_channel, 0, writeData, _handlerQueue,
+                    ^(bool done, dispatch_data_t _, int errCode) {
+                      if (done) {
+                        writeHandler(errCode);
+                      }
+                    });
+}
+
+- (void)edo_receiveOnStream:(uint32_t)streamID
+                 forChannel:(id<EDOChannel>)channel
+                      queue:(dispatch_queue_t)queue
+                    handler:(EDOChannelReceiveDispatchDataHandler)handler {
+  dispatch_queue_t handlerQueue = queue;
+  // The chunks are credited as soon as they are taken off the stream since the whole frame is
+  // collected for the handler anyway.
+  __weak EDOSocketChannel *weakSelf = self;
+  __block dispatch_data_t receivedFrame = dispatch_data_empty;
+  EDOSocketFrameHandler frameHandler = ^(dispatch_data_t chunk, BOOL complete, NSError *error) {
+    if (chunk) {
+      receivedFrame = dispatch_data_create_concat(receivedFrame, chunk);
+      [weakSelf edo_acknowledgeReceivedSize:dispatch_data_get_size(chunk) onStream:streamID];
+    }
+    if (complete && handler) {
+      dispatch_data_t frame = chunk ? receivedFrame : nil;
+      dispatch_async(handlerQueue, ^{
+        handler(channel, frame, error);
+      });
+    }
+  };
+  [self edo_addFrameHandler:frameHandler onStream:streamID];
+}
+
+/** Adds the handler to receive the next frame of the stream and starts reading if not yet. */
+- (void)edo_addFrameHandler:(EDOSocketFrameHandler)frameHandler onStream:(uint32_t)streamID {
   @synchronized(self) {
-    return _channel != NULL;
+    EDOSocketFrameQueue *frameQueue = _frameQueues[@(streamID)];
+    // The frames that are already read are still delivered after the channel is invalidated.
+    if (![frameQueue addHandler:frameHandler waitsForFrame:_channel != NULL]) {
+      // TODO(haowoo): Add better error code define.
+      frameHandler(
+          nil, YES, [NSError errorWithDomain:NSInternalInconsistencyException code:0 userInfo:nil]);
+      return;
+    }
+
+    if (!_readingStarted && _channel) {
+      _readingStarted = YES;
+      [self edo_startReadingFromChannel:_channel];
+    }
   }
 }
 
-/** @see -[EDOChannel invalidate] */
-- (void)invalidate {
+- (BOOL)edo_isStreamValid:(uint32_t)streamID {
   @synchronized(self) {
-    if (_channel) {
-      dispatch_io_close(_channel, 0);
-      _channel = NULL;
+    EDOSocketFrameQueue *frameQueue = _frameQueues[@(streamID)];
+    return _channel != NULL && frameQueue && !frameQueue.closed;
+  }
+}
+
+- (void)edo_closeStream:(uint32_t)streamID {
+  @synchronized(self) {
+    EDOSocketFrameQueue *frameQueue = _frameQueues[@(streamID)];
+    if (!frameQueue) {
+      return;
+    }
+    [frameQueue closeAndNotifyHandlers:NO error:nil];
+    [_frameQueues removeObjectForKey:@(streamID)];
+    // The peer is credited for the frames that will never be received.
+    [self edo_acknowledgeReceivedSize:frameQueue.bufferedSize onStream:streamID];
+    if (!_channel) {
+      return;
     }
   }
+  // The empty frame lets the peer release the stream.
+  [self edo_sendData:dispatch_data_empty
+               onStream:streamID
+            fromChannel:self
+           handlerQueue:self.handlerQueue
+      completionHandler:nil];
 }
 
-#pragma mark - Private
+/**
+ * Starts reading from the dispatch I/O channel until it is closed.
+ *
+ * A single read operation is kept outstanding for the lifetime of the channel and its handler is
+ * invoked with whatever bytes are available, so all the frames that arrive together are parsed in
+ * one wakeup instead of scheduling a read for every header and payload. If the channel uses the
+ * shared reactor, the descriptor of the channel is read on the reactor thread instead.
+ *
+ * @param channel The dispatch I/O channel to read from.
+ */
+- (void)edo_startReadingFromChannel:(dispatch_io_t)channel {
+  // The read operation holds the handler until the channel is closed, so it doesn't retain self
+  // to let the channel be released and invalidated.
+  __weak EDOSocketChannel *weakSelf = self;
+  if (_usesReactor) {
+    _readSource = [EDOSocketReactor.sharedReactor
+        readSourceForDescriptor:dispatch_io_get_descriptor(channel)
+                        handler:^(dispatch_data_t data, bool done, int error) {
+                          [weakSelf edo_processReadData:data done:done error:error];
+                        }];
+    return;
+  }
+
+  // Deliver the data as soon as any is available.
+  dispatch_io_set_low_water(channel, 1);
+  dispatch_io_read(channel, 0, SIZE_MAX, _handlerQueue,
+                   ^(bool done, dispatch_data_t data, int error) {
+                     [weakSelf edo_processReadData:data done:done error:error];
+                   });
+}
 
 /**
- * Atomically checks the validity of the socket channel and calls dispatch_io_read if it's valid.
+ * Appends the data read from the channel to the buffer and dispatches the complete frames.
  *
- * @param dataSize The number of bytes to be read through dispatch_io_read.
- * @param handler  The handler to process the data read by dispatch_io_read.
+ * Each frame is routed by its stream identifier and handed over to the oldest pending receive
+ * handler of the stream, or kept until the next receive call. The payload is a subrange of the
+ * regions read and no bytes are copied. The continuation frames are handed over as the chunks of
+ * the same frame, and the window updates from the peer release the frames blocked by the window. A
+ * frame of a stream above the ones seen so far opens a new stream if the @c streamHandler is set,
+ * the late frames of the closed streams are dropped, and an empty frame closes the stream. If the
+ * channel reaches EOF, fails to read, or reads an invalid frame header or a version 2 payload
+ * larger than the maximum, the channel is invalidated.
  *
- * @return @c YES if dispatch_io_read is called; @c NO otherwise.
+ * @param data  The data read from the channel.
+ * @param done  Whether the read operation is completed.
+ * @param error The error code of the read operation.
  */
-- (BOOL)readDispatchIOWithDataSize:(size_t)dataSize handler:(dispatch_io_handler_t)handler {
+- (void)edo_processReadData:(dispatch_data_t)data done:(bool)done error:(int)error {
+  BOOL closed = done;
+  NSMutableArray<EDOSocketChannelStream *> *acceptedStreams = [[NSMutableArray alloc] init];
+  EDOSocketChannelStreamHandler streamHandler = self.streamHandler;
   @synchronized(self) {
-    if (_channel) {
-      dispatch_io_read(_channel, 0, dataSize, _handlerQueue, handler);
+    if (data && dispatch_data_get_size(data) > 0) {
+      _bufferedData = _bufferedData ? dispatch_data_create_concat(_bufferedData, data) : data;
     }
-    return _channel != NULL;
+
+    while (_bufferedData) {
+      EDOFrameHeader header;
+      EDOFrameHeaderStatus status = EDOParseFrameHeader(_bufferedData, &header);
+      if (status == EDOFrameHeaderStatusIncomplete) {
+        break;
+      }
+      uint32_t streamID = header.streamID;
+      // The payload size is checked before it's added to the header size so the sum can't
+      // overflow.
+      if (status == EDOFrameHeaderStatusInvalid ||
+          (header.version == EDOFrameHeaderVersion2 &&
+           header.payloadSize > kEDOSocketChannelMaxPayloadSize) ||
+          (header.payloadSize == 0 && streamID == kEDOSocketChannelDefaultStreamID)) {
+        // Either the header is corrupted or the other side doesn't speak the same protocol.
+        closed = YES;
+        break;
+      }
+      // The frames sent afterwards use the latest header that both sides understand.
+      _peerFrameVersion = MAX(_peerFrameVersion, MIN(header.supportedVersion,
+                                                     EDOFrameHeaderVersionLatest));
+      _peerCapabilities = header.capabilities;
+
+      size_t bufferedSize = dispatch_data_get_size(_bufferedData);
+      size_t headerSize = header.headerSize;
+      size_t payloadSize = (size_t)header.payloadSize;
+      size_t frameSize = headerSize + payloadSize;
+      if (bufferedSize < frameSize) {
+        // Wait for the rest of the payload; the outstanding read keeps filling the buffer.
+        break;
+      }
+
+      dispatch_data_t frame = dispatch_data_create_subrange(_bufferedData, headerSize, payloadSize);
+      _bufferedData = bufferedSize > frameSize
+                          ? dispatch_data_create_subrange(_bufferedData, frameSize,
+                                                          bufferedSize - frameSize)
+                          : nil;
+
+      NSNumber *streamKey = @(streamID);
+      if (header.flags & EDOFrameFlagsWindowUpdate) {
+        // The peer has consumed the data of the stream and grants more credit for it.
+        uint64_t credit;
+        if (payloadSize != sizeof(credit)) {
+          closed = YES;
+          break;
+        }
+        memcpy(&credit, EDOGetDataFromDispatchData(frame).bytes, sizeof(credit));
+        credit = MIN(OSSwapBigToHostInt64(credit), (uint64_t)kEDOSocketChannelWindowSize);
+        int64_t sendWindow = [self edo_sendWindowOfStream:streamKey] + (int64_t)credit;
+        [self edo_setSendWindow:sendWindow ofStream:streamKey];
+        [self edo_releaseBlockedFramesOfStream:streamKey];
+        continue;
+      }
+
+      EDOSocketFrameQueue *frameQueue = _frameQueues[streamKey];
+      if (payloadSize == 0) {
+        // The peer has closed the stream, and the frames not received yet are discarded.
+        [frameQueue closeAndNotifyHandlers:YES error:nil];
+        [_frameQueues removeObjectForKey:streamKey];
+        [self edo_acknowledgeReceivedSize:frameQueue.bufferedSize onStream:streamID];
+        continue;
+      }
+      if (!frameQueue) {
+        // The frames that were in flight when this side closed the stream are dropped and
+        // credited to the peer, instead of opening the stream again.
+        BOOL closedStream = streamID < _nextStreamID || streamID <= _highestPeerStreamID;
+        if (closedStream || !streamHandler) {
+          if (!closedStream) {
+            NSLog(@"[eDistantObject] The frame of stream %u is dropped by the channel %@.",
+                  streamID, self);
+          }
+          [self edo_acknowledgeReceivedSize:payloadSize onStream:streamID];
+          continue;
+        }
+        _highestPeerStreamID = streamID;
+        frameQueue = [[EDOSocketFrameQueue alloc] init];
+        _frameQueues[streamKey] = frameQueue;
+        [acceptedStreams addObject:[[EDOSocketChannelStream alloc] initWithChannel:self
+                                                                          streamID:streamID]];
+      }
+      [frameQueue enqueueChunk:frame complete:(header.flags & EDOFrameFlagsContinuation) == 0];
+    }
+
+    if (closed) {
+      // The pending handlers are notified of the closed channel, and an error is only reported if
+      // the read fails in the middle of a frame.
+      NSError *closeError;
+      if (error != 0 && _bufferedData) {
+        closeError = [NSError errorWithDomain:NSPOSIXErrorDomain code:error userInfo:nil];
+      }
+      for (EDOSocketFrameQueue *frameQueue in _frameQueues.allValues) {
+        [frameQueue closeAndNotifyHandlers:(error == 0 || closeError) error:closeError];
+      }
+      _bufferedData = nil;
+    }
+  }
+
+  // The accepted streams are released and closed if the handler doesn't hold them. The handler
+  // is always invoked on the handler queue, which the reactor thread doesn't run on.
+  for (EDOSocketChannelStream *stream in acceptedStreams) {
+    if (_usesReactor) {
+      dispatch_async(_handlerQueue, ^{
+        streamHandler(stream);
+      });
+    } else {
+      streamHandler(stream);
+    }
+  }
+
+  if (closed) {
+    [self invalidate];
   }
 }
 
@@ -88,12 +88,18 @@ static NSString *GetSocketIPAddress(const struct sockaddr_storage *socketAddress
 }
 
 - (NSString *)localPath {
+  // The connecting side is usually unnamed, so the accepted socket only has the path of its own.
   if (_peerSocketAddress.ss_family == AF_UNIX) {
     struct sockaddr_un *unixSock = (struct sockaddr_un *)&_peerSocketAddress;
+    if (unixSock->sun_path[0] != '\0') {
+      return [NSString stringWithUTF8String:unixSock->sun_path];
+    }
+  }
+  if (_socketAddress.ss_family == AF_UNIX) {
+    struct sockaddr_un *unixSock = (struct sockaddr_un *)&_socketAddress;
     return [NSString stringWithUTF8String:unixSock->sun_path];
-  } else {
-    return nil;
   }
+  return nil;
 }
 
 - (NSString *)description {
@@ -0,0 +1,110 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The block to be invoked on the reactor thread with the data read from the descriptor.
+ *
+ * @param data  The bytes read at the wakeup, which may be empty.
+ * @param done  Whether the descriptor reaches EOF or fails to read, after which the block is not
+ *              invoked anymore.
+ * @param error The error code if the descriptor fails to read; 0 otherwise.
+ */
+typedef void (^EDOSocketReactorReadHandler)(dispatch_data_t data, bool done, int error);
+
+/**
+ * The block to be invoked once the data is written to the descriptor.
+ *
+ * @param error The error code if the descriptor fails to write; 0 otherwise.
+ */
+typedef void (^EDOSocketReactorWriteHandler)(int error);
+
+/** The registration of a descriptor that the reactor reads from. */
+@interface EDOSocketReactorSource : NSObject
+
+/** The descriptor to read from. */
+@property(readonly) dispatch_fd_t descriptor;
+
+/**
+ * Stops reading from the descriptor.
+ *
+ * Once it returns, the descriptor isn't read anymore and can be closed. The handler may still be
+ * invoked once with the data read right before the cancellation.
+ */
+- (void)cancel;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ * The event loop that reads from and writes to many descriptors on a single thread.
+ *
+ * The reactor waits for all the registered descriptors with a single kqueue, and it reads whatever
+ * is available from each readable descriptor on its own thread before handing the bytes over to
+ * the handler. Compared to a dispatch I/O channel and a handler queue per descriptor, the idle
+ * descriptors cost neither a thread nor a queue wakeup, and the busy ones are served by one thread
+ * that wakes up once for all the descriptors ready at the same time.
+ *
+ * The data is written right away on the calling thread with a single gathered write for all its
+ * regions, and the reactor thread only takes over the part that the socket buffer can't hold yet.
+ *
+ * The handlers run on the reactor thread, so they are expected to only parse the data and dispatch
+ * the work elsewhere.
+ */
+@interface EDOSocketReactor : NSObject
+
+/** The reactor shared by the process, which starts its thread on the first use. */
+@property(class, readonly) EDOSocketReactor *sharedReactor;
+
+/**
+ * Starts reading from the descriptor until it reaches EOF, fails to read, or is cancelled.
+ *
+ * The descriptor is switched to the non-blocking mode. It must stay open until the returned source
+ * is cancelled or the handler is invoked with @c done.
+ *
+ * @param descriptor The descriptor to read from.
+ * @param handler    The block to be invoked on the reactor thread with the data read.
+ *
+ * @return The source to cancel the reading.
+ */
+- (EDOSocketReactorSource *)readSourceForDescriptor:(dispatch_fd_t)descriptor
+                                            handler:(EDOSocketReactorReadHandler)handler;
+
+/**
+ * Writes the data to the descriptor in the order the writes are issued.
+ *
+ * The descriptor must be in the non-blocking mode, and it must stay open until the handler is
+ * invoked. The writes to the same descriptor must not be issued concurrently.
+ *
+ * @param data       The data to write.
+ * @param descriptor The descriptor to write to.
+ * @param handler    The block to be invoked once all the data is written or the write fails, which
+ *                   is invoked on the calling thread if the data is written right away and on the
+ *                   reactor thread otherwise.
+ */
+- (void)writeData:(dispatch_data_t)data
+     toDescriptor:(dispatch_fd_t)descriptor
+          handler:(EDOSocketReactorWriteHandler)handler;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,394 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Channel/Sources/EDOSocketReactor.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/event.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/** The number of events that the reactor handles at each wakeup. */
+static const int kEDOSocketReactorMaxEvents = 64;
+
+/** The size of each read from the descriptor. */
+static const size_t kEDOSocketReactorReadSize = 64 * 1024;
+
+/**
+ * The number of bytes read from a descriptor at each wakeup, after which the other descriptors
+ * are served first and the rest is read at the next wakeup.
+ */
+static const size_t kEDOSocketReactorMaxReadSizePerWakeup = 1024 * 1024;
+
+/**
+ * Writes as much of the data as the descriptor takes without blocking.
+ *
+ * The regions of the data are gathered into a single write, so the data made of many frames is
+ * written with one system call as long as the socket buffer has room for it.
+ *
+ * @param      descriptor The non-blocking descriptor to write to.
+ * @param      data       The data to write.
+ * @param[out] error      The error code if the write fails; untouched otherwise.
+ *
+ * @return The part of the data that is not written yet, or @c nil if the data is all written or
+ *         the write fails.
+ */
+static dispatch_data_t _Nullable EDOWriteAvailableData(dispatch_fd_t descriptor,
+                                                       dispatch_data_t data, int *error) {
+  size_t size = dispatch_data_get_size(data);
+  size_t offset = 0;
+  while (offset < size) {
+    dispatch_data_t remainingData =
+        offset > 0 ? dispatch_data_create_subrange(data, offset, size - offset) : data;
+    struct iovec vectors[IOV_MAX];
+    struct iovec *vector = vectors;
+    __block int count = 0;
+    dispatch_data_apply(remainingData, ^bool(dispatch_data_t region, size_t regionOffset,
+                                             const void *buffer, size_t regionSize) {
+      vector[count].iov_base = (void *)buffer;
+      vector[count].iov_len = regionSize;
+      return ++count < IOV_MAX;
+    });
+
+    ssize_t writtenSize = writev(descriptor, vectors, count);
+    if (writtenSize >= 0) {
+      offset += (size_t)writtenSize;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return remainingData;
+    } else if (errno != EINTR) {
+      *error = errno;
+      return nil;
+    }
+  }
+  return nil;
+}
+
+/**
+ * Wakes up the reactor once the descriptor is writable.
+ *
+ * @return The error code if the descriptor can't be watched; 0 otherwise.
+ */
+static int EDOWaitForWritableDescriptor(int queue, dispatch_fd_t descriptor) {
+  struct kevent change;
+  EV_SET(&change, descriptor, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, NULL);
+  return kevent(queue, &change, 1, NULL, 0, NULL) == 0 ? 0 : errno;
+}
+
+@interface EDOSocketReactor ()
+/** Stops watching the descriptor of the source. */
+- (void)edo_removeSource:(EDOSocketReactorSource *)source;
+@end
+
+#pragma mark - Reactor Write
+
+/** The data that waits for the descriptor to be writable. */
+@interface EDOSocketReactorWrite : NSObject
+/** The part of the data that is not written yet. */
+@property(nonatomic, nullable) dispatch_data_t data;
+/** The block to be invoked once the data is written. */
+@property(readonly, nonatomic) EDOSocketReactorWriteHandler handler;
+
+- (instancetype)initWithData:(dispatch_data_t)data handler:(EDOSocketReactorWriteHandler)handler;
+@end
+
+@implementation EDOSocketReactorWrite
+
+- (instancetype)initWithData:(dispatch_data_t)data handler:(EDOSocketReactorWriteHandler)handler {
+  self = [super init];
+  if (self) {
+    _data = data;
+    _handler = handler;
+  }
+  return self;
+}
+
+@end
+
+#pragma mark - Reactor Source
+
+@interface EDOSocketReactorSource ()
+- (instancetype)initWithReactor:(EDOSocketReactor *)reactor
+                     descriptor:(dispatch_fd_t)descriptor
+                        handler:(EDOSocketReactorReadHandler)handler;
+
+/** Reads what is available from the descriptor and hands it over to the handler. */
+- (void)edo_readAvailableData;
+@end
+
+@implementation EDOSocketReactorSource {
+  // The reactor that watches the descriptor.
+  EDOSocketReactor *_reactor;
+  // The block to hand the data over to, which is released once the source is cancelled.
+  EDOSocketReactorReadHandler _handler;
+  // Whether the source is cancelled.
+  BOOL _cancelled;
+}
+
+- (instancetype)initWithReactor:(EDOSocketReactor *)reactor
+                     descriptor:(dispatch_fd_t)descriptor
+                        handler:(EDOSocketReactorReadHandler)handler {
+  self = [super init];
+  if (self) {
+    _reactor = reactor;
+    _descriptor = descriptor;
+    _handler = handler;
+  }
+  return self;
+}
+
+- (void)cancel {
+  // Waits for the read in progress, if any, so the descriptor can be closed once it returns.
+  @synchronized(self) {
+    if (_cancelled) {
+      return;
+    }
+    _cancelled = YES;
+    _handler = nil;
+  }
+  [_reactor edo_removeSource:self];
+}
+
+- (void)edo_readAvailableData {
+  EDOSocketReactorReadHandler handler;
+  dispatch_data_t data = dispatch_data_empty;
+  bool done = false;
+  int error = 0;
+  @synchronized(self) {
+    if (_cancelled) {
+      return;
+    }
+    handler = _handler;
+    size_t totalSize = 0;
+    while (totalSize < kEDOSocketReactorMaxReadSizePerWakeup) {
+      void *buffer = malloc(kEDOSocketReactorReadSize);
+      ssize_t size = read(_descriptor, buffer, kEDOSocketReactorReadSize);
+      if (size > 0) {
+        // The buffer is handed over to the dispatch data, which frees it.
+        dispatch_data_t region = dispatch_data_create(buffer, (size_t)size, NULL,
+                                                      DISPATCH_DATA_DESTRUCTOR_FREE);
+        data = dispatch_data_create_concat(data, region);
+        totalSize += (size_t)size;
+        if ((size_t)size < kEDOSocketReactorReadSize) {
+          break;
+        }
+        continue;
+      }
+      free(buffer);
+      if (size == 0) {
+        done = true;
+      } else if (errno == EINTR) {
+        continue;
+      } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        done = true;
+        error = errno;
+      }
+      break;
+    }
+  }
+  if (done) {
+    [self cancel];
+  }
+  // The handler is invoked without the lock, so the handler can cancel the source and another
+  // thread can cancel it without waiting for the handler.
+  handler(data, done, error);
+}
+
+@end
+
+#pragma mark - Reactor
+
+@implementation EDOSocketReactor {
+  // The kqueue that watches all the descriptors.
+  int _queue;
+  // The registered sources by their descriptors.
+  NSMutableDictionary<NSNumber *, EDOSocketReactorSource *> *_sources;
+  // The writes waiting for the descriptors to be writable, in the order they are issued.
+  NSMutableDictionary<NSNumber *, NSMutableArray<EDOSocketReactorWrite *> *> *_pendingWrites;
+  // The thread that runs the event loop.
+  NSThread *_thread;
+}
+
++ (EDOSocketReactor *)sharedReactor {
+  static dispatch_once_t onceToken;
+  static EDOSocketReactor *sharedReactor;
+  dispatch_once(&onceToken, ^{
+    sharedReactor = [[self alloc] initInternal];
+  });
+  return sharedReactor;
+}
+
+- (instancetype)initInternal {
+  self = [super init];
+  if (self) {
+    _queue = kqueue();
+    NSAssert(_queue != -1, @"Failed to create the kqueue (%d).", errno);
+    _sources = [[NSMutableDictionary alloc] init];
+    _pendingWrites = [[NSMutableDictionary alloc] init];
+    _thread = [[NSThread alloc] initWithTarget:self selector:@selector(edo_run) object:nil];
+    _thread.name = @"com.google.edo.socketReactor";
+    // The same QoS as the default handler queues of the channels, as the reactor thread reads all
+    // the frames of the channels.
+    _thread.qualityOfService = NSQualityOfServiceUserInitiated;
+    [_thread start];
+  }
+  return self;
+}
+
+- (EDOSocketReactorSource *)readSourceForDescriptor:(dispatch_fd_t)descriptor
+                                            handler:(EDOSocketReactorReadHandler)handler {
+  EDOSocketReactorSource *source = [[EDOSocketReactorSource alloc] initWithReactor:self
+                                                                        descriptor:descriptor
+                                                                           handler:handler];
+  int flags = fcntl(descriptor, F_GETFL);
+  if (flags != -1) {
+    fcntl(descriptor, F_SETFL, flags | O_NONBLOCK);
+  }
+  @synchronized(self) {
+    _sources[@(descriptor)] = source;
+  }
+
+  struct kevent change;
+  EV_SET(&change, descriptor, EVFILT_READ, EV_ADD, 0, 0, NULL);
+  if (kevent(_queue, &change, 1, NULL, 0, NULL) != 0) {
+    int error = errno;
+    [source cancel];
+    // The handler is never invoked before the source is returned.
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+      handler(dispatch_data_empty, true, error);
+    });
+  }
+  return source;
+}
+
+- (void)writeData:(dispatch_data_t)data
+     toDescriptor:(dispatch_fd_t)descriptor
+          handler:(EDOSocketReactorWriteHandler)handler {
+  NSNumber *key = @(descriptor);
+  @synchronized(self) {
+    // The data waits behind the writes that the reactor thread hasn't finished yet.
+    NSMutableArray<EDOSocketReactorWrite *> *writes = _pendingWrites[key];
+    if (writes) {
+      [writes addObject:[[EDOSocketReactorWrite alloc] initWithData:data handler:handler]];
+      return;
+    }
+  }
+
+  int error = 0;
+  dispatch_data_t remainingData = EDOWriteAvailableData(descriptor, data, &error);
+  if (remainingData) {
+    @synchronized(self) {
+      EDOSocketReactorWrite *write = [[EDOSocketReactorWrite alloc] initWithData:remainingData
+                                                                          handler:handler];
+      _pendingWrites[key] = [NSMutableArray arrayWithObject:write];
+      error = EDOWaitForWritableDescriptor(_queue, descriptor);
+      if (error == 0) {
+        return;
+      }
+      [_pendingWrites removeObjectForKey:key];
+    }
+  }
+  handler(error);
+}
+
+#pragma mark - Private
+
+/** Continues the pending writes of the descriptor that becomes writable. */
+- (void)edo_writePendingDataToDescriptor:(dispatch_fd_t)descriptor {
+  NSNumber *key = @(descriptor);
+  NSMutableArray<EDOSocketReactorWrite *> *finishedWrites = [[NSMutableArray alloc] init];
+  NSMutableArray<EDOSocketReactorWrite *> *failedWrites = [[NSMutableArray alloc] init];
+  int error = 0;
+  @synchronized(self) {
+    NSMutableArray<EDOSocketReactorWrite *> *writes = _pendingWrites[key];
+    while (writes.count > 0) {
+      EDOSocketReactorWrite *write = writes.firstObject;
+      write.data = EDOWriteAvailableData(descriptor, write.data, &error);
+      if (write.data) {
+        error = EDOWaitForWritableDescriptor(_queue, descriptor);
+        if (error == 0) {
+          break;
+        }
+      }
+      if (error != 0) {
+        // The writes behind the failed one can't be written either.
+        [failedWrites addObjectsFromArray:writes];
+        [writes removeAllObjects];
+        break;
+      }
+      [finishedWrites addObject:write];
+      [writes removeObjectAtIndex:0];
+    }
+    if (writes.count == 0) {
+      [_pendingWrites removeObjectForKey:key];
+    }
+  }
+  // The handlers are invoked without the lock so they can issue the next writes.
+  for (EDOSocketReactorWrite *write in finishedWrites) {
+    write.handler(0);
+  }
+  for (EDOSocketReactorWrite *write in failedWrites) {
+    write.handler(error);
+  }
+}
+
+- (void)edo_removeSource:(EDOSocketReactorSource *)source {
+  NSNumber *key = @(source.descriptor);
+  @synchronized(self) {
+    // The descriptor may be registered again by another source after it is closed and reused.
+    if (_sources[key] != source) {
+      return;
+    }
+    [_sources removeObjectForKey:key];
+  }
+  struct kevent change;
+  EV_SET(&change, source.descriptor, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+  kevent(_queue, &change, 1, NULL, 0, NULL);
+}
+
+/**
+ * Runs the event loop, which waits for the readable and writable descriptors and reads from or
+ * writes to them.
+ */
+- (void)edo_run {
+  struct kevent events[kEDOSocketReactorMaxEvents];
+  while (YES) {
+    @autoreleasepool {
+      int count = kevent(_queue, NULL, 0, events, kEDOSocketReactorMaxEvents, NULL);
+      if (count < 0) {
+        if (errno != EINTR) {
+          NSLog(@"[eDistantObject] The socket reactor fails to wait for events (%d).", errno);
+        }
+        continue;
+      }
+      for (int i = 0; i < count; ++i) {
+        dispatch_fd_t descriptor = (dispatch_fd_t)events[i].ident;
+        if (events[i].filter == EVFILT_WRITE) {
+          [self edo_writePendingDataToDescriptor:descriptor];
+          continue;
+        }
+        EDOSocketReactorSource *source;
+        @synchronized(self) {
+          source = _sources[@(descriptor)];
+        }
+        // The event of a source cancelled in the meantime is ignored.
+        [source edo_readAvailableData];
+      }
+    }
+  }
+}
+
+@end
@@ -0,0 +1,97 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "Channel/Sources/EDOBufferPool.h"
+
+@interface EDOBufferPoolTest : XCTestCase
+@end
+
+@implementation EDOBufferPoolTest
+
+/** Tests that the buffer of a released data is handed out again for the same size class. */
+- (void)testReleasedBufferIsReused {
+  EDOBufferPool *pool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
+  uint64_t hitCount = pool.hitCount;
+
+  void *buffer = [pool allocateBufferWithLength:10000];
+  @autoreleasepool {
+    NSData *data = [pool dataWithBuffer:buffer length:10000];
+    XCTAssertEqual(data.bytes, buffer);
+  }
+
+  // The buffer is cached by the pool of the channel and reused for a frame of a similar size.
+  XCTAssertEqual([pool allocateBufferWithLength:12000], buffer);
+  XCTAssertEqual(pool.hitCount, hitCount + 1);
+  [pool recycleBuffer:buffer length:12000];
+}
+
+/** Tests that the buffer cached by a released pool is returned to the shared pool. */
+- (void)testReleasedPoolReturnsBufferToSharedPool {
+  void *buffer;
+  uint64_t retainedBytes;
+  @autoreleasepool {
+    EDOBufferPool *pool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
+    buffer = [pool allocateBufferWithLength:100000];
+    retainedBytes = pool.retainedBytes;
+    [pool recycleBuffer:buffer length:100000];
+    XCTAssertGreaterThan(pool.retainedBytes, retainedBytes);
+  }
+
+  EDOBufferPool *sharedPool = EDOBufferPool.sharedPool;
+  XCTAssertEqual([sharedPool allocateBufferWithLength:100000], buffer);
+  XCTAssertEqual(sharedPool.retainedBytes, retainedBytes);
+  [sharedPool recycleBuffer:buffer length:100000];
+}
+
+/** Tests that the discontiguous dispatch data is copied into a pooled buffer. */
+- (void)testDataFromDiscontiguousDispatchData {
+  EDOBufferPool *pool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
+  NSData *headData = [@"test " dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *tailData = [@"message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData = dispatch_data_create_concat(
+      dispatch_data_create(headData.bytes, headData.length, NULL,
+                           DISPATCH_DATA_DESTRUCTOR_DEFAULT),
+      dispatch_data_create(tailData.bytes, tailData.length, NULL,
+                           DISPATCH_DATA_DESTRUCTOR_DEFAULT));
+
+  uint64_t copiedBytes = pool.copiedBytes;
+  uint64_t dispatchDataCount = pool.dispatchDataCount;
+
+  const void *buffer;
+  @autoreleasepool {
+    NSData *data = [pool dataWithDispatchData:dispatchData];
+    XCTAssertEqualObjects(data, [@"test message" dataUsingEncoding:NSUTF8StringEncoding]);
+    buffer = data.bytes;
+  }
+  XCTAssertEqual(pool.copiedBytes, copiedBytes + headData.length + tailData.length);
+  XCTAssertEqual(pool.dispatchDataCount, dispatchDataCount + 1);
+  void *reusedBuffer = [pool allocateBufferWithLength:1];
+  XCTAssertEqual(reusedBuffer, buffer);
+  [pool recycleBuffer:reusedBuffer length:1];
+}
+
+/** Tests that the buffers larger than the largest size class are not kept. */
+- (void)testLargeBufferIsNotRetained {
+  EDOBufferPool *pool = [[EDOBufferPool alloc] initWithParentPool:EDOBufferPool.sharedPool];
+  uint64_t retainedBytes = pool.retainedBytes;
+  size_t length = 64 * 1024 * 1024;
+  [pool recycleBuffer:[pool allocateBufferWithLength:length] length:length];
+  XCTAssertEqual(pool.retainedBytes, retainedBytes);
+}
+
+@end
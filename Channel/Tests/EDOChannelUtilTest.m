@@ -34,4 +34,163 @@
   XCTAssertEqual(payloadSize, dataSize);
 }
 
+/** Tests that the version 1 header advertises the latest version that can be parsed. */
+- (void)testBuildVersion1FrameAdvertisesLatestVersion {
+  NSData *testData = [@"test message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData =
+      EDOBuildFrameFromDataWithQueue(testData, dispatch_get_main_queue());
+
+  EDOFrameHeader header;
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusValid);
+  XCTAssertEqual(header.version, EDOFrameHeaderVersion1);
+  XCTAssertEqual(header.supportedVersion, EDOFrameHeaderVersionLatest);
+  XCTAssertEqual(header.headerSize, EDOGetPayloadHeaderSize());
+  XCTAssertEqual(header.payloadSize, testData.length);
+  XCTAssertEqual(dispatch_data_get_size(dispatchData), header.headerSize + testData.length);
+}
+
+/** Tests that the header from the peers prior to the version 2 header is parsed. */
+- (void)testParseLegacyFrameHeader {
+  uint32_t legacyHeader[] = {1, 0xc080c080, htonl(5)};
+  dispatch_data_t dispatchData = dispatch_data_create(legacyHeader, sizeof(legacyHeader), NULL,
+                                                      DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+
+  EDOFrameHeader header;
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusValid);
+  XCTAssertEqual(header.version, EDOFrameHeaderVersion1);
+  XCTAssertEqual(header.supportedVersion, EDOFrameHeaderVersion1);
+  XCTAssertEqual(header.capabilities, EDOFrameCapabilitiesNone);
+  XCTAssertEqual(header.payloadSize, 5u);
+  XCTAssertEqual(EDOGetPayloadSizeFromFrameData(dispatchData), 5u);
+}
+
+/** Tests that the version 2 header carries the stream ID and is parsed only when complete. */
+- (void)testBuildVersion2FrameAndParseHeader {
+  NSData *testData = [@"test message" dataUsingEncoding:NSUTF8StringEncoding];
+  EDOFrameHeader sentHeader = {
+      .version = EDOFrameHeaderVersion2,
+      .capabilities = EDOFrameCapabilitiesStreams,
+      .streamID = 42,
+  };
+  dispatch_data_t dispatchData =
+      EDOBuildFrameFromDataWithHeader(testData, sentHeader, dispatch_get_main_queue());
+
+  EDOFrameHeader header;
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusValid);
+  XCTAssertEqual(header.version, EDOFrameHeaderVersion2);
+  XCTAssertEqual(header.capabilities, EDOFrameCapabilitiesStreams);
+  XCTAssertEqual(header.flags, EDOFrameFlagsNone);
+  XCTAssertEqual(header.streamID, 42u);
+  XCTAssertEqual(header.headerSize, EDOGetFrameHeaderSize(EDOFrameHeaderVersion2));
+  XCTAssertEqual(header.payloadSize, testData.length);
+  XCTAssertEqual(EDOGetPayloadSizeFromFrameData(dispatchData), testData.length);
+
+  // The version 1 header size is enough to tell the version but not the whole header.
+  dispatch_data_t partialData =
+      dispatch_data_create_subrange(dispatchData, 0, EDOGetPayloadHeaderSize());
+  XCTAssertEqual(EDOParseFrameHeader(partialData, &header), EDOFrameHeaderStatusIncomplete);
+}
+
+/** Tests that the continuation flag is parsed and the unsupported flags are rejected. */
+- (void)testParseFrameFlags {
+  NSData *testData = [@"test message" dataUsingEncoding:NSUTF8StringEncoding];
+  EDOFrameHeader sentHeader = {
+      .version = EDOFrameHeaderVersion2,
+      .capabilities = EDOFrameCapabilitiesChunks,
+      .flags = EDOFrameFlagsContinuation,
+      .streamID = 1,
+  };
+  EDOFrameHeader header;
+  dispatch_data_t dispatchData = EDOBuildFrameFromDataWithHeader(testData, sentHeader, nil);
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusValid);
+  XCTAssertEqual(header.capabilities, EDOFrameCapabilitiesChunks);
+  XCTAssertEqual(header.flags, EDOFrameFlagsContinuation);
+
+  sentHeader.flags = EDOFrameFlagsCompressed;
+  dispatchData = EDOBuildFrameFromDataWithHeader(testData, sentHeader, nil);
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusInvalid);
+}
+
+/** Tests that the data without the frame tag is rejected. */
+- (void)testParseInvalidFrameHeader {
+  NSData *testData = [@"not a frame header" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData = dispatch_data_create(testData.bytes, testData.length, NULL,
+                                                      DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+
+  EDOFrameHeader header;
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusInvalid);
+  XCTAssertEqual(EDOGetPayloadSizeFromFrameData(dispatchData), 0u);
+}
+
+/** Tests that the data is wrapped without copying when the dispatch data is contiguous. */
+- (void)testDataFromContiguousDispatchDataIsNotCopied {
+  NSData *testData = [@"test message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData = dispatch_data_create(testData.bytes, testData.length, NULL,
+                                                      DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  const void *regionBuffer = NULL;
+  NS_VALID_UNTIL_END_OF_SCOPE dispatch_data_t mappedData =
+      dispatch_data_create_map(dispatchData, &regionBuffer, NULL);
+
+  NSData *data = EDOGetDataFromDispatchData(dispatchData);
+  XCTAssertEqual(data.bytes, regionBuffer);
+  XCTAssertEqualObjects(data, testData);
+}
+
+/** Tests that the data is flattened correctly when the dispatch data has multiple regions. */
+- (void)testDataFromDiscontiguousDispatchData {
+  NSData *headData = [@"test " dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *tailData = [@"message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData = dispatch_data_create_concat(
+      dispatch_data_create(headData.bytes, headData.length, NULL,
+                           DISPATCH_DATA_DESTRUCTOR_DEFAULT),
+      dispatch_data_create(tailData.bytes, tailData.length, NULL,
+                           DISPATCH_DATA_DESTRUCTOR_DEFAULT));
+
+  NSData *data = EDOGetDataFromDispatchData(dispatchData);
+  XCTAssertEqualObjects(data, [@"test message" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+/** Tests that the segments are concatenated by referencing their regions without copying. */
+- (void)testDispatchDataFromSegmentsIsNotCopied {
+  NSData *headData = [@"test " dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *tailData = [@"message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t dispatchData =
+      EDOCreateDispatchDataFromSegments(@[ headData, tailData ], dispatch_get_main_queue());
+
+  NSMutableArray<NSValue *> *regionBuffers = [[NSMutableArray alloc] init];
+  dispatch_data_apply(dispatchData, ^bool(dispatch_data_t region, size_t offset,
+                                          const void *buffer, size_t size) {
+    [regionBuffers addObject:[NSValue valueWithPointer:buffer]];
+    return true;
+  });
+  NSArray<NSValue *> *segmentBuffers = @[
+    [NSValue valueWithPointer:headData.bytes], [NSValue valueWithPointer:tailData.bytes]
+  ];
+  XCTAssertEqualObjects(regionBuffers, segmentBuffers);
+  XCTAssertEqualObjects(EDOGetDataFromDispatchData(dispatchData),
+                        [@"test message" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+/** Tests that the frame only prepends the header to the regions of the dispatch data. */
+- (void)testBuildFrameFromDispatchDataKeepsRegions {
+  NSData *headData = [@"test " dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *tailData = [@"message" dataUsingEncoding:NSUTF8StringEncoding];
+  dispatch_data_t payload =
+      EDOCreateDispatchDataFromSegments(@[ headData, tailData ], dispatch_get_main_queue());
+  EDOFrameHeader sentHeader = {.version = EDOFrameHeaderVersion2, .streamID = 3};
+  dispatch_data_t dispatchData = EDOBuildFrameFromDispatchDataWithHeader(payload, sentHeader);
+
+  EDOFrameHeader header;
+  XCTAssertEqual(EDOParseFrameHeader(dispatchData, &header), EDOFrameHeaderStatusValid);
+  XCTAssertEqual(header.streamID, 3u);
+  XCTAssertEqual(header.payloadSize, headData.length + tailData.length);
+  __block NSUInteger regionCount = 0;
+  dispatch_data_apply(dispatchData, ^bool(dispatch_data_t region, size_t offset,
+                                          const void *buffer, size_t size) {
+    ++regionCount;
+    return true;
+  });
+  XCTAssertEqual(regionCount, 3u);
+}
+
 @end
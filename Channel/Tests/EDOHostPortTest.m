@@ -59,6 +59,31 @@
   XCTAssertEqualObjects(port1.deviceSerialNumber, port2.deviceSerialNumber);
 }
 
+- (void)testHostPortLocalSocketPath {
+  EDOHostPort *port1 = [EDOHostPort hostPortWithLocalPort:1];
+  EDOHostPort *port2 = [EDOHostPort hostPortWithLocalPort:1 serviceName:@"test_name"];
+  XCTAssertNotNil(port1.localSocketPath);
+  XCTAssertEqualObjects(port1.localSocketPath, port2.localSocketPath);
+  XCTAssertNotEqualObjects(port1.localSocketPath,
+                           [EDOHostPort hostPortWithLocalPort:2].localSocketPath);
+  XCTAssertNotNil(port1.sharedMemorySocketPath);
+  XCTAssertNotEqualObjects(port1.localSocketPath, port1.sharedMemorySocketPath);
+
+  // The sockets are in the directory that only the current user can access.
+  NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager
+      attributesOfItemAtPath:port1.localSocketPath.stringByDeletingLastPathComponent
+                       error:nil];
+  XCTAssertEqualObjects(attributes[NSFileType], NSFileTypeDirectory);
+  XCTAssertEqualObjects(attributes[NSFilePosixPermissions], @(0700));
+  XCTAssertEqualObjects(attributes[NSFileOwnerAccountID], @(geteuid()));
+
+  // The ports identified by name or connecting to a device don't have the local socket.
+  XCTAssertNil([EDOHostPort hostPortWithName:@"test_name"].localSocketPath);
+  XCTAssertNil([EDOHostPort hostPortWithName:@"test_name"].sharedMemorySocketPath);
+  XCTAssertNil([EDOHostPort hostPortWithPort:1 name:nil deviceSerialNumber:@"test_serial"]
+                   .localSocketPath);
+}
+
 - (void)testHostPortAsDictionaryKey {
   EDOHostPort *port1 = [EDOHostPort hostPortWithLocalPort:1];
   EDOHostPort *port2 = [EDOHostPort hostPortWithName:@"test_name"];
@@ -0,0 +1,162 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "Channel/Sources/EDOChannel.h"
+#import "Channel/Sources/EDOSharedMemoryChannel.h"
+#import "Channel/Sources/EDOSocket.h"
+
+@interface EDOSharedMemoryChannelTest : XCTestCase
+/** The path of the UNIX domain socket to set up the channels. */
+@property(readonly) NSString *socketPath;
+/** The channels that the listen socket accepts. */
+@property(readonly) NSMutableArray<EDOSharedMemoryChannel *> *acceptedChannels;
+@end
+
+@implementation EDOSharedMemoryChannelTest
+
+- (void)setUp {
+  [super setUp];
+  _socketPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"edo.shm.test.sock"];
+  _acceptedChannels = [[NSMutableArray alloc] init];
+}
+
+- (void)testSendAndReceiveDataLargerThanRing {
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [self listenAndEcho];
+  EDOSharedMemoryChannel *channel = [self connectedChannel];
+
+  // The large data is written in pieces while the peer reads it.
+  NSMutableData *largeData = [NSMutableData dataWithLength:3 << 20];
+  arc4random_buf(largeData.mutableBytes, largeData.length);
+  NSArray<NSData *> *dataToSend = @[
+    [@"small" dataUsingEncoding:NSUTF8StringEncoding], [NSData data], largeData,
+    [@"last" dataUsingEncoding:NSUTF8StringEncoding]
+  ];
+  for (NSData *data in dataToSend) {
+    [channel sendData:data withCompletionHandler:nil];
+  }
+
+  XCTestExpectation *expectReceived = [self expectationWithDescription:@"Received all the data"];
+  expectReceived.expectedFulfillmentCount = dataToSend.count;
+  for (NSData *data in dataToSend) {
+    [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *received, NSError *error) {
+      XCTAssertNil(error);
+      XCTAssertEqualObjects(received, data);
+      [expectReceived fulfill];
+    }];
+  }
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+  [channel invalidate];
+}
+
+- (void)testInvalidateClosesPeer {
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [self listenAndEcho];
+  EDOSharedMemoryChannel *channel = [self connectedChannel];
+  XCTAssertTrue(channel.valid);
+
+  XCTestExpectation *expectClosed = [self expectationWithDescription:@"The channel is closed"];
+  [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertNil(data);
+    XCTAssertNil(error);
+    [expectClosed fulfill];
+  }];
+  NSMutableArray<EDOSharedMemoryChannel *> *acceptedChannels = self.acceptedChannels;
+  NSPredicate *accepted = [NSPredicate predicateWithBlock:^BOOL(id object, id bindings) {
+    @synchronized(acceptedChannels) {
+      return acceptedChannels.count == 1;
+    }
+  }];
+  XCTestExpectation *expectAccepted = [self expectationForPredicate:accepted
+                                                evaluatedWithObject:acceptedChannels
+                                                            handler:nil];
+  [self waitForExpectations:@[ expectAccepted ] timeout:1];
+  @synchronized(acceptedChannels) {
+    [acceptedChannels.firstObject invalidate];
+  }
+  [self waitForExpectations:@[ expectClosed ] timeout:1];
+  XCTAssertFalse(channel.valid);
+
+  XCTestExpectation *expectSendError = [self expectationWithDescription:@"Fails to send"];
+  [channel sendData:[NSData data]
+      withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+        XCTAssertNotNil(error);
+        [expectSendError fulfill];
+      }];
+  [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
+- (void)testFailToSetUpWithoutPeer {
+  // The empty handler only accepts the connection and drops it.
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket listenWithSocketPath:self.socketPath
+                                                                          queue:nil
+                                                                 connectedBlock:nil];
+  EDOSocket *socket = [EDOSocket socketWithSocketPath:self.socketPath queue:nil error:nil];
+  XCTAssertNotNil(socket);
+
+  NSError *error;
+  XCTAssertNil([EDOSharedMemoryChannel channelWithConnectedSocket:socket
+                                                     handlerQueue:nil
+                                                            error:&error]);
+  XCTAssertEqualObjects(error.domain, NSPOSIXErrorDomain);
+}
+
+#pragma mark - Helpers
+
+/** Listens on the @c socketPath and echoes the data received by the accepted channels. */
+- (EDOSocket *)listenAndEcho {
+  NSMutableArray<EDOSharedMemoryChannel *> *acceptedChannels = self.acceptedChannels;
+  EDOSocket *host = [EDOSocket
+      listenWithSocketPath:self.socketPath
+                     queue:nil
+            connectedBlock:^(EDOSocket *socket, NSError *error) {
+              EDOSharedMemoryChannel *channel =
+                  [EDOSharedMemoryChannel channelWithAcceptedSocket:socket
+                                                       handlerQueue:nil
+                                                              error:nil];
+              XCTAssertNotNil(channel);
+              @synchronized(acceptedChannels) {
+                [acceptedChannels addObject:channel];
+              }
+              __block __weak EDOChannelReceiveHandler weakHandler;
+              EDOChannelReceiveHandler handler = ^(id<EDOChannel> channel, NSData *data,
+                                                   NSError *error) {
+                if (data) {
+                  [channel sendData:data withCompletionHandler:nil];
+                  [channel receiveDataWithHandler:weakHandler];
+                }
+              };
+              weakHandler = handler;
+              [channel receiveDataWithHandler:handler];
+            }];
+  XCTAssertNotNil(host);
+  return host;
+}
+
+/** Connects to the @c socketPath and sets up the shared memory channel. */
+- (EDOSharedMemoryChannel *)connectedChannel {
+  NSError *error;
+  EDOSocket *socket = [EDOSocket socketWithSocketPath:self.socketPath queue:nil error:&error];
+  XCTAssertNil(error);
+  EDOSharedMemoryChannel *channel = [EDOSharedMemoryChannel channelWithConnectedSocket:socket
+                                                                          handlerQueue:nil
+                                                                                 error:&error];
+  XCTAssertNil(error);
+  XCTAssertNotNil(channel);
+  return channel;
+}
+
+@end
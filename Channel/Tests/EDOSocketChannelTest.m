@@ -17,6 +17,7 @@
 #import <XCTest/XCTest.h>
 
 #import "Channel/Sources/EDOChannel.h"
+#import "Channel/Sources/EDOChannelUtil.h"
 #import "Channel/Sources/EDOSocket.h"
 #import "Channel/Sources/EDOSocketChannel.h"
 #import "Channel/Sources/EDOSocketPort.h"
@@ -241,6 +242,616 @@
   XCTAssertTrue(memcmp(replyHugeData.bytes, receivedData[1].bytes, receivedData[1].length) == 0);
 }
 
+- (void)testSendDispatchDataAsOneFrame {
+  XCTestExpectation *expectReceived = [self expectationWithDescription:@"Received the frame"];
+  NSArray<NSData *> *segments = @[
+    [@"header" dataUsingEncoding:NSUTF8StringEncoding], [self replyHugeData:1048576],
+    [@"trailer" dataUsingEncoding:NSUTF8StringEncoding]
+  ];
+  NSMutableData *expectedData = [[NSMutableData alloc] init];
+  for (NSData *segment in segments) {
+    [expectedData appendData:segment];
+  }
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             XCTAssertEqualObjects(data, expectedData);
+             [expectReceived fulfill];
+           }];
+         }];
+
+  NSError *error;
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:&error];
+  XCTAssertNil(error);
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  XCTestExpectation *expectSent = [self expectationWithDescription:@"Sent the frame"];
+  [remoteConn sendDispatchData:EDOCreateDispatchDataFromSegments(segments, nil)
+         withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+           XCTAssertNil(error);
+           [expectSent fulfill];
+         }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+- (void)testFrameLargerThanMaximumClosesChannel {
+  XCTestExpectation *expectClosed = [self expectationWithDescription:@"The channel is closed"];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             XCTAssertNil(data);
+             [expectClosed fulfill];
+           }];
+         }];
+
+  // The header claims a payload that is far larger than the maximum, which is rejected before the
+  // rest of the frame arrives.
+  EDOFrameHeader header = {.version = EDOFrameHeaderVersion2};
+  NSMutableData *frame = [EDOGetDataFromDispatchData(
+      EDOBuildFrameFromDataWithHeader(self.replyData, header, dispatch_get_main_queue()))
+      mutableCopy];
+  uint64_t payloadSize = OSSwapHostToBigInt64((uint64_t)1 << 40);
+  size_t headerSize = EDOGetFrameHeaderSize(EDOFrameHeaderVersion2);
+  [frame replaceBytesInRange:NSMakeRange(headerSize - sizeof(payloadSize), sizeof(payloadSize))
+                   withBytes:&payloadSize];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  dispatch_fd_t socketFD = [socket releaseSocket];
+  XCTAssertEqual(write(socketFD, frame.bytes, frame.length), (ssize_t)frame.length);
+  [self waitForExpectationsWithTimeout:2 handler:nil];
+  close(socketFD);
+}
+
+- (void)testCoalesceFramesSentWithinInterval {
+  NSUInteger frameCount = 20;
+  XCTestExpectation *expectReceived = [self expectationWithDescription:@"Received all frames"];
+  expectReceived.expectedFulfillmentCount = frameCount;
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           for (NSUInteger i = 0; i < frameCount; ++i) {
+             [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                              NSError *error) {
+               NSString *expected = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+               XCTAssertEqualObjects(data, [expected dataUsingEncoding:NSUTF8StringEncoding]);
+               [expectReceived fulfill];
+             }];
+           }
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  remoteConn.writeCoalescingIntervalInNano = 100 * NSEC_PER_MSEC;
+  for (NSUInteger i = 0; i < frameCount; ++i) {
+    NSString *frame = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+    [remoteConn sendData:[frame dataUsingEncoding:NSUTF8StringEncoding] withCompletionHandler:nil];
+  }
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  // All the frames are sent within the interval and written at once.
+  XCTAssertEqual(remoteConn.sentFrameCount, frameCount);
+  XCTAssertEqual(remoteConn.writeCount, 1u);
+}
+
+- (void)testFlushWritesPendingFrames {
+  XCTestExpectation *expectReceived = [self expectationWithDescription:@"Received the frame"];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             XCTAssertEqualObjects(data, self.replyData);
+             [expectReceived fulfill];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  remoteConn.writeCoalescingIntervalInNano = 60 * NSEC_PER_SEC;
+  XCTestExpectation *expectSent = [self expectationWithDescription:@"Sent the frame"];
+  [remoteConn sendData:self.replyData
+      withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+        XCTAssertNil(error);
+        [expectSent fulfill];
+      }];
+  XCTAssertEqual(remoteConn.writeCount, 0u);
+
+  [remoteConn flush];
+  [self waitForExpectationsWithTimeout:1 handler:nil];
+  XCTAssertEqual(remoteConn.writeCount, 1u);
+}
+
+- (void)testReceiveConsecutiveFramesInOrder {
+  XCTestExpectation *expectConnected = [self expectationWithDescription:@"Connected to host"];
+  XCTestExpectation *expectSent = [self expectationWithDescription:@"All frames are sent"];
+  NSArray<NSData *> *sentData = @[
+    [@"first" dataUsingEncoding:NSUTF8StringEncoding], [self replyHugeData:1048576],
+    [@"last" dataUsingEncoding:NSUTF8StringEncoding]
+  ];
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           // The channel is released and closed after all the frames are sent.
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           for (NSData *data in sentData) {
+             [client sendData:data
+                 withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+                   if (data == sentData.lastObject) {
+                     [expectSent fulfill];
+                   }
+                 }];
+           }
+         }];
+  XCTAssertNotEqual(host.socketPort.port, 0);
+
+  __block EDOSocketChannel *remoteConn = nil;
+  [EDOSocket connectWithTCPPort:host.socketPort.port
+                          queue:nil
+                 connectedBlock:^(EDOSocket *socket, NSError *error) {
+                   remoteConn = [EDOSocketChannel channelWithSocket:socket];
+                   [expectConnected fulfill];
+                 }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  // All the frames are available at once and are handed to the handlers in the scheduled order.
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received all frames"];
+  expectReply.expectedFulfillmentCount = sentData.count;
+  XCTestExpectation *expectClosed = [self expectationWithDescription:@"The channel is closed"];
+  NSMutableArray<NSData *> *receivedData = [[NSMutableArray alloc] init];
+  for (NSUInteger i = 0; i < sentData.count; ++i) {
+    [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+      XCTAssertNil(error);
+      [receivedData addObject:data];
+      [expectReply fulfill];
+    }];
+  }
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertNil(data);
+    [expectClosed fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  XCTAssertEqualObjects(receivedData, sentData);
+  XCTAssertFalse(remoteConn.valid);
+}
+
+- (void)testLargeFrameIsSentInChunks {
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received from host"];
+  NSData *largeData = [self replyHugeData:5 * 1048576];
+
+  // The host replies once the client has advertised that it takes the chunks.
+  __block EDOSocketChannel *hostChannel = nil;
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           hostChannel = [EDOSocketChannel channelWithSocket:socket];
+           [hostChannel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                                 NSError *error) {
+             [channel sendData:largeData withCompletionHandler:nil];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(data, largeData);
+    [expectReply fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  // Each megabyte of the payload is sent as a frame.
+  XCTAssertEqual(hostChannel.sentFrameCount, 5u);
+}
+
+- (void)testReceiveChunksAsTheyArrive {
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received from host"];
+  NSData *largeData = [self replyHugeData:3 * 1048576];
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             [channel sendData:largeData withCompletionHandler:nil];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  NSMutableArray<NSData *> *chunks = [[NSMutableArray alloc] init];
+  dispatch_queue_t queue = dispatch_queue_create("com.google.edo.test.chunks", NULL);
+  [remoteConn receiveChunksWithQueue:queue
+                             handler:^(id<EDOChannel> channel, dispatch_data_t chunk,
+                                       BOOL complete, NSError *error) {
+                               XCTAssertNil(error);
+                               XCTAssertNotNil(chunk);
+                               [chunks addObject:(NSData *)chunk];
+                               if (complete) {
+                                 [expectReply fulfill];
+                               }
+                             }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  NSMutableData *receivedData = [[NSMutableData alloc] init];
+  for (NSData *chunk in chunks) {
+    [receivedData appendData:chunk];
+  }
+  XCTAssertGreaterThan(chunks.count, 1u);
+  XCTAssertEqualObjects(receivedData, largeData);
+}
+
+- (void)testSlowReaderHoldsBackSender {
+  XCTestExpectation *expectReady = [self expectationWithDescription:@"Received the first frame"];
+  XCTestExpectation *expectSent = [self expectationWithDescription:@"Sent the large frame"];
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received the large frame"];
+  NSData *largeData = [self replyHugeData:12 * 1048576];
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             [channel sendData:self.replyData withCompletionHandler:nil];
+             [channel sendData:largeData
+                 withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+                   XCTAssertNil(error);
+                   [expectSent fulfill];
+                 }];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    [expectReady fulfill];
+  }];
+  [self waitForExpectations:@[ expectReady ] timeout:5];
+
+  // The large frame doesn't fit in the window until the client receives it.
+  XCTAssertEqual([XCTWaiter waitForExpectations:@[ expectSent ] timeout:1],
+                 XCTWaiterResultTimedOut);
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertEqualObjects(data, largeData);
+    [expectReply fulfill];
+  }];
+  [self waitForExpectations:@[ expectSent, expectReply ] timeout:5];
+}
+
+- (void)testStreamsShareSocket {
+  XCTestExpectation *expectConnected = [self expectationWithDescription:@"Connected to host"];
+  XCTestExpectation *expectNegotiated = [self expectationWithDescription:@"Received from host"];
+
+  // The host echos the data back on the same stream it is received from.
+  __block void (^echoHandler)(id<EDOChannel>);
+  void (^strongEchoHandler)(id<EDOChannel>) = echoHandler = ^(id<EDOChannel> channel) {
+    void (^handler)(id<EDOChannel>) = echoHandler;
+    [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+      if (data) {
+        [channel sendData:data withCompletionHandler:nil];
+        handler(channel);
+      }
+    }];
+  };
+  NSMutableArray<EDOSocketChannel *> *hostChannels = [[NSMutableArray alloc] init];
+  NSMutableArray<id<EDOChannel>> *hostStreams = [[NSMutableArray alloc] init];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *channel = [EDOSocketChannel channelWithSocket:socket];
+           channel.streamHandler = ^(id<EDOChannel> stream) {
+             @synchronized(hostStreams) {
+               [hostStreams addObject:stream];
+             }
+             strongEchoHandler(stream);
+           };
+           @synchronized(hostChannels) {
+             [hostChannels addObject:channel];
+           }
+           strongEchoHandler(channel);
+         }];
+  XCTAssertNotEqual(host.socketPort.port, 0);
+
+  __block EDOSocketChannel *remoteConn = nil;
+  [EDOSocket connectWithTCPPort:host.socketPort.port
+                          queue:nil
+                 connectedBlock:^(EDOSocket *socket, NSError *error) {
+                   remoteConn = [EDOSocketChannel channelWithSocket:socket];
+                   [expectConnected fulfill];
+                 }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  // The streams can only be opened after the host advertises it.
+  XCTAssertFalse(remoteConn.multiplexingSupported);
+  XCTAssertNil([remoteConn openStream]);
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    [expectNegotiated fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+  XCTAssertTrue(remoteConn.multiplexingSupported);
+
+  // The data sent on each stream is only received on that stream.
+  NSArray<id<EDOChannel>> *streams = @[ [remoteConn openStream], [remoteConn openStream] ];
+  NSMutableDictionary<NSNumber *, NSData *> *receivedData = [[NSMutableDictionary alloc] init];
+  for (NSUInteger i = 0; i < streams.count; ++i) {
+    XCTestExpectation *expectReply = [self expectationWithDescription:@"Received on the stream"];
+    NSData *data = [[NSString stringWithFormat:@"stream %lu", (unsigned long)i]
+        dataUsingEncoding:NSUTF8StringEncoding];
+    [streams[i] sendData:data withCompletionHandler:nil];
+    [streams[i] receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+      XCTAssertEqual(channel, streams[i]);
+      @synchronized(receivedData) {
+        receivedData[@(i)] = data;
+      }
+      [expectReply fulfill];
+    }];
+  }
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  XCTAssertEqual(hostChannels.count, 1u);
+  XCTAssertEqual(hostStreams.count, 2u);
+  XCTAssertEqualObjects(receivedData[@0], [@"stream 0" dataUsingEncoding:NSUTF8StringEncoding]);
+  XCTAssertEqualObjects(receivedData[@1], [@"stream 1" dataUsingEncoding:NSUTF8StringEncoding]);
+
+  // Closing the stream closes it on the host as well.
+  [streams.firstObject invalidate];
+  XCTAssertFalse(streams.firstObject.valid);
+  XCTAssertTrue(streams.lastObject.valid);
+  [self expectationForPredicate:[NSPredicate predicateWithFormat:@"valid == false"]
+            evaluatedWithObject:hostStreams.firstObject
+                        handler:nil];
+  [self waitForExpectationsWithTimeout:2 handler:nil];
+}
+
+- (void)testStreamNotReceivingDoesNotHoldBackOtherStreams {
+  XCTestExpectation *expectNegotiated = [self expectationWithDescription:@"Received from host"];
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received on the stream"];
+  NSMutableArray<EDOSocketChannel *> *hostChannels = [[NSMutableArray alloc] init];
+  NSMutableArray<id<EDOChannel>> *hostStreams = [[NSMutableArray alloc] init];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *channel = [EDOSocketChannel channelWithSocket:socket];
+           // The first stream is never received from, and the others echo the data back.
+           channel.streamHandler = ^(id<EDOChannel> stream) {
+             @synchronized(hostStreams) {
+               [hostStreams addObject:stream];
+               if (hostStreams.count == 1) {
+                 return;
+               }
+             }
+             [stream receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                              NSError *error) {
+               [channel sendData:data withCompletionHandler:nil];
+             }];
+           };
+           @synchronized(hostChannels) {
+             [hostChannels addObject:channel];
+           }
+           [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                             NSError *error) {
+             [channel sendData:data withCompletionHandler:nil];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    [expectNegotiated fulfill];
+  }];
+  [self waitForExpectations:@[ expectNegotiated ] timeout:5];
+
+  // The large frame uses up the window of the first stream, which the host never credits.
+  id<EDOChannel> blockedStream = [remoteConn openStream];
+  id<EDOChannel> stream = [remoteConn openStream];
+  [blockedStream sendData:[self replyHugeData:12 * 1048576] withCompletionHandler:nil];
+  [stream sendData:self.replyData withCompletionHandler:nil];
+  [stream receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertEqualObjects(data, self.replyData);
+    [expectReply fulfill];
+  }];
+  [self waitForExpectations:@[ expectReply ] timeout:5];
+}
+
+- (void)testLateFrameOfClosedStreamIsDropped {
+  XCTestExpectation *expectOpened = [self expectationWithDescription:@"The streams are opened"];
+  expectOpened.expectedFulfillmentCount = 2;
+  expectOpened.assertForOverFulfill = YES;
+  NSMutableArray<EDOSocketChannel *> *hostChannels = [[NSMutableArray alloc] init];
+  NSMutableArray<id<EDOChannel>> *hostStreams = [[NSMutableArray alloc] init];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *channel = [EDOSocketChannel channelWithSocket:socket];
+           channel.streamHandler = ^(id<EDOChannel> stream) {
+             @synchronized(hostStreams) {
+               [hostStreams addObject:stream];
+             }
+             [expectOpened fulfill];
+           };
+           @synchronized(hostChannels) {
+             [hostChannels addObject:channel];
+           }
+           [channel receiveDataWithHandler:nil];
+         }];
+
+  // The frame of the stream 1 that arrives after the stream is closed doesn't open it again, while
+  // the stream 3 is opened.
+  NSArray<NSArray<NSNumber *> *> *streamFrames =
+      @[ @[ @1, @YES ], @[ @1, @NO ], @[ @1, @YES ], @[ @3, @YES ] ];
+  NSMutableData *frames = [[NSMutableData alloc] init];
+  for (NSArray<NSNumber *> *frame in streamFrames) {
+    EDOFrameHeader header = {.version = EDOFrameHeaderVersion2,
+                             .streamID = frame[0].unsignedIntValue};
+    // The empty frame closes the stream.
+    NSData *payload = frame[1].boolValue ? self.replyData : NSData.data;
+    [frames appendData:EDOGetDataFromDispatchData(EDOBuildFrameFromDataWithHeader(
+                           payload, header, dispatch_get_main_queue()))];
+  }
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  dispatch_fd_t socketFD = [socket releaseSocket];
+  XCTAssertEqual(write(socketFD, frames.bytes, frames.length), (ssize_t)frames.length);
+  [self waitForExpectationsWithTimeout:2 handler:nil];
+  XCTAssertFalse(hostStreams.firstObject.valid);
+  XCTAssertTrue(hostStreams.lastObject.valid);
+  close(socketFD);
+}
+
+- (void)testUnixSocketCanSendAndReceiveData {
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received from host"];
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"edo.test.sock"];
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithSocketPath:path
+                     queue:nil
+            connectedBlock:^(EDOSocket *socket, NSError *error) {
+              XCTAssertEqualObjects(socket.socketPort.localPath, path);
+              EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+              [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                               NSError *error) {
+                [channel sendData:data withCompletionHandler:nil];
+              }];
+            }];
+  XCTAssertNotNil(host);
+  XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:path]);
+
+  NSError *error;
+  EDOSocket *socket = [EDOSocket socketWithSocketPath:path queue:nil error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqualObjects(socket.socketPort.localPath, path);
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertEqualObjects(data, self.replyData);
+    [expectReply fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:1 handler:nil];
+
+  // The socket file is removed once the host stops listening.
+  [host invalidate];
+  [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id object, id bindings) {
+          return ![NSFileManager.defaultManager fileExistsAtPath:path];
+        }]
+            evaluatedWithObject:path
+                        handler:nil];
+  [self waitForExpectationsWithTimeout:2 handler:nil];
+
+  XCTAssertNil([EDOSocket socketWithSocketPath:path queue:nil error:&error]);
+  XCTAssertEqualObjects(error.domain, NSPOSIXErrorDomain);
+}
+
+- (void)testUnixSocketDoesNotReplaceFilesInUse {
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"edo.test.inuse.sock"];
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket listenWithSocketPath:path
+                                                                          queue:nil
+                                                                 connectedBlock:nil];
+  XCTAssertNotNil(host);
+
+  // Another listener can't take over the path while the host listens on it.
+  XCTAssertNil([EDOSocket listenWithSocketPath:path queue:nil connectedBlock:nil]);
+  XCTAssertNotNil([EDOSocket socketWithSocketPath:path queue:nil error:nil]);
+  [host invalidate];
+
+  // The file that isn't a socket is kept as is.
+  NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"edo.test.file"];
+  XCTAssertTrue([NSData.data writeToFile:filePath atomically:NO]);
+  XCTAssertNil([EDOSocket listenWithSocketPath:filePath queue:nil connectedBlock:nil]);
+  XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:filePath]);
+  [NSFileManager.defaultManager removeItemAtPath:filePath error:nil];
+}
+
+- (void)testChannelsUseSharedReactor {
+  XCTestExpectation *expectReply = [self expectationWithDescription:@"Received from host"];
+  XCTestExpectation *expectClosed = [self expectationWithDescription:@"The channel is closed"];
+  EDOSocketChannel.usesSharedReactor = YES;
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             [channel sendData:data withCompletionHandler:nil];
+           }];
+         }];
+
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:self.replyData withCompletionHandler:nil];
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertEqualObjects(data, self.replyData);
+    [expectReply fulfill];
+  }];
+  [self waitForExpectations:@[ expectReply ] timeout:1];
+
+  // Invalidating the channel ends the pending receive as the reactor stops reading.
+  [remoteConn receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    XCTAssertNil(data);
+    [expectClosed fulfill];
+  }];
+  [remoteConn invalidate];
+  [self waitForExpectations:@[ expectClosed ] timeout:1];
+  EDOSocketChannel.usesSharedReactor = NO;
+}
+
+- (void)testLargeFrameIsWrittenOnSharedReactor {
+  XCTestExpectation *expectSent = [self expectationWithDescription:@"Sent to host"];
+  XCTestExpectation *expectReceived = [self expectationWithDescription:@"Received by host"];
+  NSData *largeData = [self replyHugeData:4 * 1048576];
+  EDOSocketChannel.usesSharedReactor = YES;
+
+  NS_VALID_UNTIL_END_OF_SCOPE EDOSocket *host = [EDOSocket
+      listenWithTCPPort:0
+                  queue:nil
+         connectedBlock:^(EDOSocket *socket, NSError *error) {
+           EDOSocketChannel *client = [EDOSocketChannel channelWithSocket:socket];
+           [client receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data,
+                                            NSError *error) {
+             XCTAssertEqualObjects(data, largeData);
+             [expectReceived fulfill];
+           }];
+         }];
+
+  // The frame doesn't fit in the socket buffer, so the reactor thread finishes the write.
+  EDOSocket *socket = [EDOSocket socketWithTCPPort:host.socketPort.port queue:nil error:nil];
+  EDOSocketChannel *remoteConn = [EDOSocketChannel channelWithSocket:socket];
+  [remoteConn sendData:largeData
+      withCompletionHandler:^(id<EDOChannel> channel, NSError *error) {
+        XCTAssertNil(error);
+        [expectSent fulfill];
+      }];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+  EDOSocketChannel.usesSharedReactor = NO;
+}
+
 - (void)testEmptyAcceptBlock {
   XCTestExpectation *expectConnected = [self expectationWithDescription:@"Conntected to host"];
   XCTestExpectation *expectDisconnected =
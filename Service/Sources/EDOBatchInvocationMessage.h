@@ -0,0 +1,54 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Service/Sources/EDOServiceRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOInvocationRequest;
+@class EDOInvocationResponse;
+
+/**
+ * The request to make a list of remote invocations in one round trip.
+ *
+ * The invocations are made in order on the executor of the service, the same as if each of them
+ * is sent alone, and the exception of one invocation doesn't stop the ones after it.
+ */
+@interface EDOBatchInvocationRequest : EDOServiceRequest
+
+/** The invocations to make in order. */
+@property(nonatomic, readonly) NSArray<EDOInvocationRequest *> *invocations;
+
+/** Creates a request with the invocations to make in order. */
++ (instancetype)requestWithInvocations:(NSArray<EDOInvocationRequest *> *)invocations;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/** The response for the batch invocation request. */
+@interface EDOBatchInvocationResponse : EDOServiceResponse
+
+/** The responses of the invocations in the order of the request. */
+@property(nonatomic, readonly) NSArray<EDOInvocationResponse *> *responses;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,151 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOBatchInvocationMessage.h"
+
+#import "Service/Sources/EDOHostService.h"
+#import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOMessage.h"
+
+static NSString *const kEDOBatchInvocationCoderInvocationsKey = @"invocations";
+static NSString *const kEDOBatchInvocationCoderResponsesKey = @"responses";
+
+#pragma mark -
+
+@implementation EDOBatchInvocationResponse
+
++ (BOOL)supportsSecureCoding {
+  return YES;
+}
+
++ (instancetype)responseWithResponses:(NSArray<EDOInvocationResponse *> *)responses
+                           forRequest:(EDOServiceRequest *)request {
+  return [[self alloc] initWithResponses:responses forRequest:request];
+}
+
+- (instancetype)initWithResponses:(NSArray<EDOInvocationResponse *> *)responses
+                       forRequest:(EDOServiceRequest *)request {
+  self = [super initWithMessageID:request.messageID];
+  if (self) {
+    _responses = [responses copy];
+  }
+  return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+  self = [super initWithCoder:aDecoder];
+  if (self) {
+    NSSet *classes = [NSSet setWithObjects:[NSArray class], [EDOInvocationResponse class], nil];
+    _responses = [aDecoder decodeObjectOfClasses:classes
+                                          forKey:kEDOBatchInvocationCoderResponsesKey];
+  }
+  return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+  [super encodeWithCoder:aCoder];
+  [aCoder encodeObject:self.responses forKey:kEDOBatchInvocationCoderResponsesKey];
+}
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _responses = [decoder decodeArray];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeArray:self.responses];
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"Batch invocation response (%llx)", self.messageID];
+}
+
+@end
+
+#pragma mark -
+
+@implementation EDOBatchInvocationRequest
+
++ (BOOL)supportsSecureCoding {
+  return YES;
+}
+
++ (EDORequestHandler)requestHandler {
+  return ^(EDOServiceRequest *originalRequest, EDOHostService *service) {
+    EDOBatchInvocationRequest *request = (EDOBatchInvocationRequest *)originalRequest;
+    NSAssert([request isKindOfClass:[EDOBatchInvocationRequest class]],
+             @"EDOBatchInvocationRequest is expected.");
+    EDORequestHandler invocationHandler = [EDOInvocationRequest requestHandler];
+    NSMutableArray<EDOInvocationResponse *> *responses =
+        [[NSMutableArray alloc] initWithCapacity:request.invocations.count];
+    for (EDOInvocationRequest *invocation in request.invocations) {
+      // The invocation handler catches the exception of the invocation into its response.
+      [responses addObject:(EDOInvocationResponse *)invocationHandler(invocation, service)];
+    }
+    return [EDOBatchInvocationResponse responseWithResponses:responses forRequest:request];
+  };
+}
+
++ (instancetype)requestWithInvocations:(NSArray<EDOInvocationRequest *> *)invocations {
+  return [[self alloc] initWithInvocations:invocations];
+}
+
+- (instancetype)initWithInvocations:(NSArray<EDOInvocationRequest *> *)invocations {
+  self = [super init];
+  if (self) {
+    _invocations = [invocations copy];
+  }
+  return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+  self = [super initWithCoder:aDecoder];
+  if (self) {
+    NSSet *classes = [NSSet setWithObjects:[NSArray class], [EDOInvocationRequest class], nil];
+    _invocations = [aDecoder decodeObjectOfClasses:classes
+                                            forKey:kEDOBatchInvocationCoderInvocationsKey];
+  }
+  return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+  [super encodeWithCoder:aCoder];
+  [aCoder encodeObject:self.invocations forKey:kEDOBatchInvocationCoderInvocationsKey];
+}
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _invocations = [decoder decodeArray];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeArray:self.invocations];
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"Batch invocation request (%llx) with %lu invocations",
+                                    self.messageID, (unsigned long)self.invocations.count];
+}
+
+@end
@@ -81,8 +81,24 @@ static NSString *const kEDOObjectCoderHostPortKey = @"hostPort";
   [aCoder encodeObject:self.hostPort forKey:kEDOObjectCoderHostPortKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _className = [decoder decodeInternedString];
+    _hostPort = [decoder decodeObject];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeInternedString:self.className];
+  [encoder encodeObject:self.hostPort];
+}
+
 - (NSString *)description {
-  return [NSString stringWithFormat:@"Class request (%@) name: %@", self.messageID, self.className];
+  return [NSString
+      stringWithFormat:@"Class request (%llx) name: %@", self.messageID, self.className];
 }
 
 @end
@@ -96,7 +112,7 @@ static NSString *const kEDOObjectCoderHostPortKey = @"hostPort";
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"Class response (%@)", self.messageID];
+  return [NSString stringWithFormat:@"Class response (%llx)", self.messageID];
 }
 
 @end
@@ -25,8 +25,19 @@ NS_ASSUME_NONNULL_BEGIN
 @class EDOObject;
 @class EDOExecutor;
 @class EDOHostPort;
+@class EDOMessageInternTable;
 @class EDOServiceRequest;
 @class EDOServiceResponse;
+@protocol EDOChannel;
+
+/**
+ * The handler of the response to a request sent without waiting for it.
+ *
+ * @param response The response from the service, or @c nil if the request fails.
+ * @param error    The error if the request fails, including the error returned by the service.
+ */
+typedef void (^EDOClientServiceResponseHandler)(EDOServiceResponse *_Nullable response,
+                                                NSError *_Nullable error);
 
 /** Propagates @c error to eDO client error handler. */
 void EDOExportEDOClientError(NSError *error);
@@ -53,6 +64,14 @@ void EDOExportEDOClientError(NSError *error);
 /** Try to get the object from local cache. Update the cache if @c object is not in it. */
 + (id)cachedEDOFromObjectUpdateIfNeeded:(id)object;
 
+/**
+ * Returns the table of the strings interned for the messages sent or received on the @c channel.
+ *
+ * The service interns the strings per channel, so the table goes with the channel whether it's
+ * used by one request at a time or by the pipeline, and it goes away with the channel.
+ */
++ (EDOMessageInternTable *)internTableForChannel:(id<EDOChannel>)channel sending:(BOOL)sending;
+
 /**
  * Synchronously sends the request and waits for the response with the executor to process
  * any incoming requests.
@@ -72,6 +91,23 @@ void EDOExportEDOClientError(NSError *error);
                                         onPort:(EDOHostPort *)port
                                   withExecutor:(EDOExecutor *)executor;
 
+/**
+ * Synchronously sends the request and waits for the response while running the executor.
+ *
+ * @param      request  The request to be sent.
+ * @param      port     The service host port.
+ * @param      executor The executor to run and process the incoming requests.
+ * @param[out] errorOut The error if it fails to communicate with the service, which is reported to
+ *                      the client error handler instead if it's @c NULL.
+ * @throw NSDestinationInvalidException if the service replies with an error.
+ *
+ * @return The response from the service, or @c nil if it fails to communicate with the service.
+ */
++ (nullable EDOServiceResponse *)sendSynchronousRequest:(EDOServiceRequest *)request
+                                                 onPort:(EDOHostPort *)port
+                                           withExecutor:(nullable EDOExecutor *)executor
+                                                  error:(NSError *_Nullable *_Nullable)errorOut;
+
 /**
  * Synchronously sends the request and waits for the response.
  *
@@ -84,6 +120,24 @@ void EDOExportEDOClientError(NSError *error);
 + (EDOServiceResponse *)sendSynchronousRequest:(EDOServiceRequest *)request
                                         onPort:(EDOHostPort *)port;
 
+/**
+ * Sends the request and returns without waiting for the response.
+ *
+ * Unlike the synchronous requests, no thread is blocked while the request is in flight, so many
+ * requests can be sent at the same time. The requests to the same service are pipelined on one
+ * channel, so a request is written without waiting for the responses to the earlier ones. The
+ * incoming requests, for example, the nested remote invocations, are handled by the executor of
+ * their queue as usual, which processes them on the queue unless it's waiting.
+ *
+ * @param request The request to be sent.
+ * @param port    The service host port.
+ * @param handler The handler to be invoked on an arbitrary queue once the response is received or
+ *                the request fails.
+ */
++ (void)sendRequest:(EDOServiceRequest *)request
+               onPort:(EDOHostPort *)port
+    completionHandler:(EDOClientServiceResponseHandler)handler;
+
 /**
  * Unwraps an @c object to a local object if it comes from the local process.
  *
@@ -25,23 +25,24 @@
 #import "Service/Sources/EDOClassMessage.h"
 #import "Service/Sources/EDOClientService+Private.h"
 #import "Service/Sources/EDOClientServiceStatsCollector.h"
+#import "Service/Sources/EDODeadline+Private.h"
 #import "Service/Sources/EDOExecutor.h"
 #import "Service/Sources/EDOHostNamingService.h"
 #import "Service/Sources/EDOHostService+Private.h"
 #import "Service/Sources/EDOHostService.h"
 #import "Service/Sources/EDOMessage.h"
+#import "Service/Sources/EDOMessageCoder.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObject.h"
 #import "Service/Sources/EDOObjectAliveMessage.h"
 #import "Service/Sources/EDOObjectMessage.h"
 #import "Service/Sources/EDOObjectReleaseMessage.h"
+#import "Service/Sources/EDORequestPipeline.h"
 #import "Service/Sources/EDOServiceError.h"
 #import "Service/Sources/EDOServiceException.h"
 #import "Service/Sources/EDOServicePort.h"
 #import "Service/Sources/EDOServiceRequest.h"
 #import "Service/Sources/EDOTimingFunctions.h"
-#import "Service/Sources/NSKeyedArchiver+EDOAdditions.h"
-#import "Service/Sources/NSKeyedUnarchiver+EDOAdditions.h"
 
 /** Timeout for ping health check. */
 static const int64_t kPingTimeoutSeconds = 10 * NSEC_PER_SEC;
@@ -256,6 +257,10 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
                                   withExecutor:(EDOExecutor *)executor
                                          error:(NSError **)errorOut {
   EDOClientServiceStatsCollector *stats = EDOClientServiceStatsCollector.sharedServiceStats;
+  // The deadline is read on the calling thread, as the executor waits for the response on another
+  // thread. The release requests don't wait for the response, so they are sent regardless.
+  BOOL isReleaseRequest = [request class] == [EDOObjectReleaseRequest class];
+  EDODeadline *deadline = isReleaseRequest ? nil : EDODeadline.currentDeadline;
 
   int maxAttempts = 2;
   int currentAttempt = 0;
@@ -269,12 +274,19 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
         dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, qosClass, 0);
     dispatch_queue_t connectionQueue =
         dispatch_queue_create("com.google.edo.connectChannel", queueAttributes);
+    dispatch_time_t connectionDeadline = deadline ? deadline.dispatchTime : DISPATCH_TIME_FOREVER;
     id<EDOChannel> channel = [EDOChannelPool.sharedChannelPool channelWithPort:port
                                                                connectionQueue:connectionQueue
+                                                                      deadline:connectionDeadline
                                                                          error:&connectionError];
     [stats reportConnectionDuration:EDOGetMillisecondsSinceMachTime(connectionStartTime)];
 
-    if (connectionError) {
+    if (connectionError && deadline.expired) {
+      [stats reportError];
+      [self edo_reportError:[EDODeadline deadlineExceededErrorForRequest:request port:port]
+                    toError:errorOut];
+      return nil;
+    } else if (connectionError) {
       [stats reportError];
       NSDictionary<NSErrorUserInfoKey, id> *userInfo = @{
         EDOErrorPortKey : port,
@@ -285,11 +297,7 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
       NSError *error = [NSError errorWithDomain:EDOServiceErrorDomain
                                            code:EDOServiceErrorCannotConnect
                                        userInfo:userInfo];
-      if (errorOut != NULL) {
-        *errorOut = error;
-      } else {
-        gEDOClientErrorHandler(error);
-      }
+      [self edo_reportError:error toError:errorOut];
       return nil;
     }
 
@@ -297,31 +305,51 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
     // protocol (check if channel is alive, send ping message, report errors, etc.). If the message
     // wasn't able to sent then it's most likely that the host side is dead and there's no need
     // to retry or try to handle it.
-    if ([request class] == [EDOObjectReleaseRequest class]) {
+    if (isReleaseRequest) {
       [stats reportReleaseObject];
-      NSData *requestData = [NSKeyedArchiver edo_archivedDataWithObject:request];
+      NSData *requestData =
+          [EDOMessageCoder dataWithMessage:request
+                              binaryCoding:[self usesBinaryCodingOnPort:port]
+                               internTable:[self internTableForChannel:channel sending:YES]];
       [channel sendData:requestData withCompletionHandler:nil];
       [EDOChannelPool.sharedChannelPool addChannel:channel forPort:port];
       return nil;
     } else {
+      // The service rejects the request that expires before it runs. The remaining time of 0
+      // means no deadline, so the request that already expires isn't sent.
+      request.remainingTime = deadline.remainingTime;
+      if (deadline && request.remainingTime <= 0) {
+        [EDOChannelPool.sharedChannelPool addChannel:channel forPort:port];
+        [self edo_reportError:[EDODeadline deadlineExceededErrorForRequest:request port:port]
+                      toError:errorOut];
+        return nil;
+      }
+
       uint64_t requestStartTime = mach_absolute_time();
       __block NSData *responseData = nil;
-      NSData *requestData = [NSKeyedArchiver edo_archivedDataWithObject:request];
+      NSData *requestData =
+          [EDOMessageCoder dataWithMessage:request
+                              binaryCoding:[self usesBinaryCodingOnPort:port]
+                               internTable:[self internTableForChannel:channel sending:YES]];
 
       if (executor) {
         // if the current queue has a pending request, send it over.
         [executor loopWithBlock:^{
-          responseData = [self sendRequestData:requestData withChannel:channel];
+          responseData = [self sendRequestData:requestData
+                                   withChannel:channel
+                                      deadline:deadline];
         }];
       } else {
-        responseData = [self sendRequestData:requestData withChannel:channel];
+        responseData = [self sendRequestData:requestData withChannel:channel deadline:deadline];
       }
 
       EDOServiceResponse *response;
       Class errorResponseClass = [EDOErrorResponse class];
       if (responseData) {
-        response = [NSKeyedUnarchiver edo_unarchiveObjectWithData:responseData];
-        NSAssert([request.messageID isEqualToString:response.messageID] ||
+        response = [EDOMessageCoder
+            messageWithData:responseData
+                internTable:[self internTableForChannel:channel sending:NO]];
+        NSAssert(request.messageID == response.messageID ||
                      [response isKindOfClass:errorResponseClass],
                  @"The response (%@) Id is mismatched with the request (%@)", response, request);
       }
@@ -331,19 +359,36 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
               responseDuration:response.duration];
       if (response) {
         [EDOChannelPool.sharedChannelPool addChannel:channel forPort:port];
+        [self setUsesBinaryCoding:response.binaryCodingSupported onPort:port];
         if ([response isKindOfClass:errorResponseClass]) {
+          EDOErrorResponse *errorResponse = (EDOErrorResponse *)response;
+          // The service rejects the request that expires before it runs, which is reported the
+          // same as the request that the client gives up waiting for.
+          if ([errorResponse.error.domain isEqualToString:EDOServiceErrorDomain] &&
+              errorResponse.error.code == EDOServiceErrorDeadlineExceeded) {
+            [self edo_reportError:errorResponse.error toError:errorOut];
+            return nil;
+          }
           // We raise an exception here for now, but the caller should also be able to handle the
           // error responses. We will refactor this with a better error reporting logic.
-          EDOErrorResponse *errorResponse = (EDOErrorResponse *)response;
           NSString *reason =
               [NSString stringWithFormat:@"eDO call failed at server side, underlying error:\n%@",
                                          errorResponse.error.description];
           [[self exceptionWithReason:reason port:port error:errorResponse.error] raise];
         }
         return response;
+      } else if (deadline.expired) {
+        // The response may still come after the deadline, so the channel can't be reused.
+        [channel invalidate];
+        [stats reportError];
+        [self edo_reportError:[EDODeadline deadlineExceededErrorForRequest:request port:port]
+                      toError:errorOut];
+        return nil;
       } else {
-        // Cleanup broken channels before retry.
+        // Cleanup broken channels before retry. The service may be replaced by an older one that
+        // doesn't decode the binary coding.
         [EDOChannelPool.sharedChannelPool removeChannelsWithPort:port];
+        [self setUsesBinaryCoding:NO onPort:port];
         currentAttempt += 1;
       }
     }
@@ -359,16 +404,177 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
   NSError *error = [NSError errorWithDomain:EDOServiceErrorDomain
                                        code:EDOServiceErrorConnectTimeout
                                    userInfo:userInfo];
+  [self edo_reportError:error toError:errorOut];
+  return nil;
+}
+
++ (void)sendRequest:(EDOServiceRequest *)request
+               onPort:(EDOHostPort *)port
+    completionHandler:(EDOClientServiceResponseHandler)handler {
+  EDODeadline *deadline = EDODeadline.currentDeadline;
+  if (deadline) {
+    handler = [self edo_handler:handler withDeadline:deadline forRequest:request onPort:port];
+  }
+  [self edo_sendRequest:request onPort:port deadline:deadline attempt:0 completionHandler:handler];
+}
+
+#pragma mark - Private
+
+/**
+ * Sends the request without waiting for the response, retrying once on a new pipeline if the
+ * pipeline breaks.
+ *
+ * The pipeline is connected on a global queue, and the response is handled by the receive handler
+ * of its channel, so no thread waits for the response.
+ */
++ (void)edo_sendRequest:(EDOServiceRequest *)request
+                 onPort:(EDOHostPort *)port
+               deadline:(nullable EDODeadline *)deadline
+                attempt:(int)attempt
+      completionHandler:(EDOClientServiceResponseHandler)handler {
+  dispatch_async(dispatch_get_global_queue(qos_class_self(), 0), ^{
+    NSError *connectionError;
+    EDORequestPipeline *pipeline = [self requestPipelineForPort:port error:&connectionError];
+    if (connectionError) {
+      [EDOClientServiceStatsCollector.sharedServiceStats reportError];
+      NSDictionary<NSErrorUserInfoKey, id> *userInfo = @{
+        EDOErrorPortKey : port,
+        EDOErrorRequestKey : request.description,
+        EDOErrorConnectAttemptKey : @(attempt),
+        NSUnderlyingErrorKey : connectionError
+      };
+      handler(nil, [NSError errorWithDomain:EDOServiceErrorDomain
+                                       code:EDOServiceErrorCannotConnect
+                                   userInfo:userInfo]);
+      return;
+    }
+
+    // The same as the synchronous requests, the request that already expires isn't sent.
+    request.remainingTime = deadline.remainingTime;
+    if (deadline && request.remainingTime <= 0) {
+      handler(nil, [EDODeadline deadlineExceededErrorForRequest:request port:port]);
+      return;
+    }
+
+    uint64_t requestStartTime = mach_absolute_time();
+    EDORequestPipelineResponseHandler responseHandler = ^(EDOServiceResponse *response) {
+      [self edo_handleResponse:response
+                    forRequest:request
+                        onPort:port
+                      deadline:deadline
+                      pipeline:pipeline
+                       attempt:attempt
+                     startTime:requestStartTime
+             completionHandler:handler];
+    };
+    if (![pipeline sendRequest:request
+                  binaryCoding:[self usesBinaryCodingOnPort:port]
+             completionHandler:responseHandler]) {
+      // The pipeline breaks after it's picked.
+      responseHandler(nil);
+    }
+  });
+}
+
+/** Handles the response of the request sent without waiting for the response. */
++ (void)edo_handleResponse:(nullable EDOServiceResponse *)response
+                forRequest:(EDOServiceRequest *)request
+                    onPort:(EDOHostPort *)port
+                  deadline:(nullable EDODeadline *)deadline
+                  pipeline:(EDORequestPipeline *)pipeline
+                   attempt:(int)attempt
+                 startTime:(uint64_t)requestStartTime
+         completionHandler:(EDOClientServiceResponseHandler)handler {
+  [EDOClientServiceStatsCollector.sharedServiceStats
+      reportRequestType:[request class]
+        requestDuration:EDOGetMillisecondsSinceMachTime(requestStartTime)
+       responseDuration:response.duration];
+  if (!response) {
+    // Cleanup broken channels before retry, the same as the synchronous requests.
+    [self removeRequestPipeline:pipeline forPort:port];
+    [EDOChannelPool.sharedChannelPool removeChannelsWithPort:port];
+    [self setUsesBinaryCoding:NO onPort:port];
+    [self edo_retryRequest:request
+                    onPort:port
+                  deadline:deadline
+                   attempt:attempt
+         completionHandler:handler];
+    return;
+  }
+
+  [self setUsesBinaryCoding:response.binaryCodingSupported onPort:port];
+  if ([response isKindOfClass:[EDOErrorResponse class]]) {
+    handler(nil, ((EDOErrorResponse *)response).error);
+  } else {
+    handler(response, nil);
+  }
+}
+
+/** Retries the request that hasn't got the response, or fails it after the last attempt. */
++ (void)edo_retryRequest:(EDOServiceRequest *)request
+                  onPort:(EDOHostPort *)port
+                deadline:(nullable EDODeadline *)deadline
+                 attempt:(int)attempt
+       completionHandler:(EDOClientServiceResponseHandler)handler {
+  if (attempt + 1 < 2) {
+    [self edo_sendRequest:request
+                   onPort:port
+                 deadline:deadline
+                  attempt:attempt + 1
+        completionHandler:handler];
+    return;
+  }
+  NSString *description = @"The remote service may be unresponsive due to a crash or hang. Check "
+                          @"full logs for more information.";
+  NSDictionary<NSErrorUserInfoKey, id> *userInfo = @{
+    EDOErrorPortKey : port,
+    EDOErrorRequestKey : request.description,
+    NSLocalizedDescriptionKey : description,
+  };
+  handler(nil, [NSError errorWithDomain:EDOServiceErrorDomain
+                                   code:EDOServiceErrorConnectTimeout
+                               userInfo:userInfo]);
+}
+
+/**
+ * Wraps the handler of the request sent without waiting for the response, so it's invoked with the
+ * @c EDOServiceErrorDeadlineExceeded error if the response isn't received before the deadline.
+ *
+ * The wrapped handler is only invoked once, and the response received after the deadline is
+ * dropped.
+ */
++ (EDOClientServiceResponseHandler)edo_handler:(EDOClientServiceResponseHandler)handler
+                                  withDeadline:(EDODeadline *)deadline
+                                    forRequest:(EDOServiceRequest *)request
+                                        onPort:(EDOHostPort *)port {
+  NSObject *lock = [[NSObject alloc] init];
+  __block EDOClientServiceResponseHandler pendingHandler = handler;
+  EDOClientServiceResponseHandler deadlineHandler = ^(EDOServiceResponse *response,
+                                                      NSError *error) {
+    EDOClientServiceResponseHandler handlerToInvoke;
+    @synchronized(lock) {
+      handlerToInvoke = pendingHandler;
+      pendingHandler = nil;
+    }
+    if (handlerToInvoke) {
+      handlerToInvoke(response, error);
+    }
+  };
+  dispatch_after(deadline.dispatchTime, dispatch_get_global_queue(qos_class_self(), 0), ^{
+    deadlineHandler(nil, [EDODeadline deadlineExceededErrorForRequest:request port:port]);
+  });
+  return deadlineHandler;
+}
+
+/** Reports the @c error to @c errorOut if it's given, or to the client error handler. */
++ (void)edo_reportError:(NSError *)error toError:(NSError **)errorOut {
   if (errorOut != NULL) {
     *errorOut = error;
   } else {
     gEDOClientErrorHandler(error);
   }
-  return nil;
 }
 
-#pragma mark - Private
-
 /**
  * Sends EDOObjectAliveRequest to the service that the given object belongs to in the current
  * process and check it is still alive.
@@ -410,8 +616,132 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
                                                      error:error];
 }
 
-/** Sends the request data through the given @c channel and waits for the response synchronously. */
-+ (NSData *)sendRequestData:(NSData *)requestData withChannel:(id<EDOChannel>)channel {
+/** The ports of the services that have advertised they decode the binary coding. */
++ (NSMutableSet<EDOHostPort *> *)binaryCodingPorts {
+  static NSMutableSet<EDOHostPort *> *binaryCodingPorts;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    binaryCodingPorts = [[NSMutableSet alloc] init];
+  });
+  return binaryCodingPorts;
+}
+
+/**
+ * Whether the requests to the service on the @c port are sent in the binary coding.
+ *
+ * The requests are sent with @c NSKeyedArchiver until the service advertises the binary coding in
+ * a response, which every version of the service can decode.
+ */
++ (BOOL)usesBinaryCodingOnPort:(EDOHostPort *)port {
+  NSMutableSet<EDOHostPort *> *binaryCodingPorts = self.binaryCodingPorts;
+  @synchronized(binaryCodingPorts) {
+    return [binaryCodingPorts containsObject:port];
+  }
+}
+
+/** Sets whether the requests to the service on the @c port are sent in the binary coding. */
++ (void)setUsesBinaryCoding:(BOOL)binaryCoding onPort:(EDOHostPort *)port {
+  NSMutableSet<EDOHostPort *> *binaryCodingPorts = self.binaryCodingPorts;
+  @synchronized(binaryCodingPorts) {
+    if (binaryCoding) {
+      [binaryCodingPorts addObject:port];
+    } else {
+      [binaryCodingPorts removeObject:port];
+    }
+  }
+}
+
++ (EDOMessageInternTable *)internTableForChannel:(id<EDOChannel>)channel sending:(BOOL)sending {
+  static char kSendingInternTableKey;
+  static char kReceivingInternTableKey;
+  const void *key = sending ? &kSendingInternTableKey : &kReceivingInternTableKey;
+  EDOMessageInternTable *internTable = objc_getAssociatedObject(channel, key);
+  if (!internTable) {
+    internTable = [[EDOMessageInternTable alloc] init];
+    objc_setAssociatedObject(channel, key, internTable, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return internTable;
+}
+
+/** The pipelines of the requests sent without waiting for the responses, by the host ports. */
++ (NSMutableDictionary<EDOHostPort *, EDORequestPipeline *> *)requestPipelines {
+  static NSMutableDictionary<EDOHostPort *, EDORequestPipeline *> *requestPipelines;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    requestPipelines = [[NSMutableDictionary alloc] init];
+  });
+  return requestPipelines;
+}
+
+/**
+ * Returns the pipeline of the requests to the service on the @c port, connecting a new one if
+ * there is none or it's broken.
+ *
+ * The pipeline takes its own channel out of the pool, and all the requests sent without waiting
+ * share it.
+ */
++ (EDORequestPipeline *)requestPipelineForPort:(EDOHostPort *)port error:(NSError **)error {
+  NSMutableDictionary<EDOHostPort *, EDORequestPipeline *> *requestPipelines =
+      self.requestPipelines;
+  @synchronized(requestPipelines) {
+    EDORequestPipeline *pipeline = requestPipelines[port];
+    if (pipeline.valid) {
+      return pipeline;
+    }
+  }
+
+  EDOClientServiceStatsCollector *stats = EDOClientServiceStatsCollector.sharedServiceStats;
+  uint64_t connectionStartTime = mach_absolute_time();
+  dispatch_queue_attr_t queueAttributes =
+      dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, qos_class_self(), 0);
+  dispatch_queue_t connectionQueue =
+      dispatch_queue_create("com.google.edo.connectChannel", queueAttributes);
+  id<EDOChannel> channel = [EDOChannelPool.sharedChannelPool channelWithPort:port
+                                                             connectionQueue:connectionQueue
+                                                                       error:error];
+  [stats reportConnectionDuration:EDOGetMillisecondsSinceMachTime(connectionStartTime)];
+  if (!channel) {
+    return nil;
+  }
+
+  @synchronized(requestPipelines) {
+    EDORequestPipeline *pipeline = requestPipelines[port];
+    // Another request has connected the pipeline in the meantime.
+    if (pipeline.valid) {
+      [EDOChannelPool.sharedChannelPool addChannel:channel forPort:port];
+      return pipeline;
+    }
+    pipeline = [[EDORequestPipeline alloc] initWithChannel:channel pingTimeout:kPingTimeoutSeconds];
+    requestPipelines[port] = pipeline;
+    return pipeline;
+  }
+}
+
+/** Removes the broken @c pipeline unless it's already replaced by a new one. */
++ (void)removeRequestPipeline:(EDORequestPipeline *)pipeline forPort:(EDOHostPort *)port {
+  NSMutableDictionary<EDOHostPort *, EDORequestPipeline *> *requestPipelines =
+      self.requestPipelines;
+  @synchronized(requestPipelines) {
+    if (requestPipelines[port] == pipeline) {
+      [requestPipelines removeObjectForKey:port];
+    }
+  }
+  [pipeline invalidate];
+}
+
+/**
+ * Sends the request data through the given @c channel and waits for the response synchronously.
+ *
+ * @param requestData The encoded request to send.
+ * @param channel     The channel to send the request on.
+ * @param deadline    The deadline to give up waiting for the response, or @c nil to wait until the
+ *                    channel breaks.
+ *
+ * @return The response data, or @c nil if the channel breaks or the deadline expires.
+ */
++ (NSData *)sendRequestData:(NSData *)requestData
+                withChannel:(id<EDOChannel>)channel
+                   deadline:(nullable EDODeadline *)deadline {
   __block NSData *responseData;
   // The channel is asynchronous and not I/O re-entrant so we chain the sending and receiving,
   // and capture the response in the callback blocks.
@@ -426,21 +756,29 @@ EDOClientErrorHandler EDOSetClientErrorHandler(EDOClientErrorHandler errorHandle
         dispatch_semaphore_signal(waitLock);
       };
 
-  // Check ping response to make sure channel is healthy.
+  // Check the channel is healthy. The service pings the request if it doesn't complete within its
+  // ping delay, and the fast request is answered by the response alone.
   [channel receiveDataWithQueue:dispatch_get_global_queue(qos_class_self(), 0)
                         handler:receiveHandler];
 
+  dispatch_time_t deadlineTime = deadline ? deadline.dispatchTime : DISPATCH_TIME_FOREVER;
   dispatch_time_t timeoutInSeconds = dispatch_time(DISPATCH_TIME_NOW, kPingTimeoutSeconds);
-  long result = dispatch_semaphore_wait(waitLock, timeoutInSeconds);
+  long result = dispatch_semaphore_wait(waitLock, MIN(timeoutInSeconds, deadlineTime));
 
-  // Continue to receive the response if the ping is received.
-  if ([responseData isEqualToData:EDOClientService.pingMessageData]) {
+  // Continue to receive the response if the ping is received, until the deadline if there is one.
+  if (result == 0 && [responseData isEqualToData:EDOClientService.pingMessageData]) {
     [channel receiveDataWithHandler:receiveHandler];
-    dispatch_semaphore_wait(waitLock, DISPATCH_TIME_FOREVER);
+    if (dispatch_semaphore_wait(waitLock, deadlineTime) != 0) {
+      NSLog(@"The edo request on channel %@ misses its deadline.", channel);
+      return nil;
+    }
   }
 
-  // The ping hasn't been received, or nothing has been received, timing out.
-  if (result != 0 || serviceClosed) {
+  if (result != 0 && deadline.expired) {
+    NSLog(@"The edo request on channel %@ misses its deadline.", channel);
+    return nil;
+  } else if (result != 0 || serviceClosed) {
+    // Neither the ping nor the response has been received, timing out.
     NSLog(@"The edo channel %@ is broken.", channel);
   }
 
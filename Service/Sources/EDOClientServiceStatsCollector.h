@@ -50,6 +50,10 @@ NS_ASSUME_NONNULL_BEGIN
 @property(readonly, nonatomic) uint64_t errorCount;
 /** The number of remote releases ocurred. */
 @property(readonly, nonatomic) uint64_t releaseCount;
+/** The ratio of the received frames that are decoded from the reused buffers. */
+@property(readonly, nonatomic) double receiveBufferHitRate;
+/** The number of bytes kept by the receive buffer pool for reuse. */
+@property(readonly, nonatomic) uint64_t receiveBufferRetainedBytes;
 /** The measurement for the connection. */
 @property(readonly, nonatomic) EDONumericMeasure *connectionMeasure;
 /** The measurement matrix for the requests by the request name. */
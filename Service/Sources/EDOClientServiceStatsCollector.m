@@ -16,6 +16,7 @@
 
 #import "Service/Sources/EDOClientServiceStatsCollector.h"
 
+#import "Channel/Sources/EDOBufferPool.h"
 #import "Measure/Sources/EDONumericMeasure.h"
 
 @implementation EDORequestMeasurement
@@ -70,6 +71,14 @@
   return self;
 }
 
+- (double)receiveBufferHitRate {
+  return EDOBufferPool.sharedPool.hitRate;
+}
+
+- (uint64_t)receiveBufferRetainedBytes {
+  return EDOBufferPool.sharedPool.retainedBytes;
+}
+
 - (void)reportConnectionDuration:(double)duration {
   dispatch_async(_statsIsolation, ^{
     [self->_connectionMeasure addSingleValue:duration];
@@ -129,11 +138,13 @@
                                        self.allRequestMeasurements[requestName]];
     }
   });
-  NSString *desc =
-      [NSString stringWithFormat:@"Client service: # of releases (%" PRIu64 "), # of errors"
-                                 @"(%" PRIu64 ")\n Connections: %@\nRequests:\n%@",
-                                 self.releaseCount, self.errorCount, self.connectionMeasure,
-                                 requestDescription];
+  NSString *desc = [NSString
+      stringWithFormat:@"Client service: # of releases (%" PRIu64 "), # of errors"
+                       @"(%" PRIu64 ")\n Receive buffers: hit rate (%lf), retained bytes"
+                       @"(%" PRIu64 ")\n Connections: %@\nRequests:\n%@",
+                       self.releaseCount, self.errorCount, self.receiveBufferHitRate,
+                       self.receiveBufferRetainedBytes, self.connectionMeasure,
+                       requestDescription];
   return desc;
 }
 
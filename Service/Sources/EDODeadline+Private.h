@@ -0,0 +1,62 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Service/Sources/EDODeadline.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOHostPort;
+@class EDOObject;
+@class EDOServiceRequest;
+
+/** The internal use of an @c EDODeadline. */
+@interface EDODeadline (Private)
+
+/** The dispatch time of the deadline to wait until. */
+@property(readonly) dispatch_time_t dispatchTime;
+
+/**
+ * Creates the @c EDOServiceErrorDeadlineExceeded error of the request that misses its deadline.
+ *
+ * @param request The request that misses its deadline.
+ * @param port    The port of the service that the request is sent to.
+ *
+ * @return The error to report.
+ */
++ (NSError *)deadlineExceededErrorForRequest:(EDOServiceRequest *)request
+                                        port:(nullable EDOHostPort *)port;
+
+@end
+
+/**
+ * The proxy for @c EDOObject to make the remote invocations with the deadline that is the timeout
+ * from when each invocation is made.
+ */
+@interface EDODeadlineObject : NSProxy
+
+/** The remote object to make the invocations on. */
+@property(nonatomic, readonly) EDOObject *remoteObject;
+/** The timeout in seconds of each invocation. */
+@property(nonatomic, readonly) NSTimeInterval timeout;
+
+/** Initialize the @c EDODeadlineObject as the proxy of given @c remoteObject. */
+- (instancetype)initWithRemoteObject:(EDOObject *)remoteObject timeout:(NSTimeInterval)timeout;
+
+@end
+
+NS_ASSUME_NONNULL_END
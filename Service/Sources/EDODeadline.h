@@ -0,0 +1,89 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The deadline of the remote invocations.
+ *
+ * The deadline bounds the time to connect to the service, and to wait for the response of the
+ * remote invocations made on the current thread while it's in effect. The time left is sent along
+ * with each request, so the service rejects the request that expires before it runs, and the
+ * remote invocations that the service makes to handle the request have the same deadline.
+ *
+ * The invocation that misses its deadline fails with the @c EDOServiceErrorDeadlineExceeded error,
+ * which is reported to the client error handler.
+ */
+@interface EDODeadline : NSObject
+
+/** The deadline in effect on the current thread, or @c nil if there is none. */
+@property(class, readonly, nullable) EDODeadline *currentDeadline;
+
+/** The time in seconds left until the deadline, which is 0 once it expires. */
+@property(readonly) NSTimeInterval remainingTime;
+
+/** Whether the deadline has passed. */
+@property(readonly, getter=isExpired) BOOL expired;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/** Creates the deadline that is the given @c timeout in seconds from now. */
++ (instancetype)deadlineWithTimeout:(NSTimeInterval)timeout;
+
+/**
+ * Runs the block with the deadline in effect on the current thread.
+ *
+ * If another deadline is already in effect, the earlier one of them is in effect for the block, so
+ * the nested scope can't extend the deadline of the outer scope.
+ *
+ * @code
+ *   [[EDODeadline deadlineWithTimeout:5] performBlock:^{
+ *     [remoteObject doSomething];
+ *     [remoteObject doSomethingElse];
+ *   }];
+ * @endcode
+ *
+ * @param block The block to run.
+ */
+- (void)performBlock:(NS_NOESCAPE void (^)(void))block;
+
+@end
+
+/** The API to make a remote invocation with a deadline. */
+@interface NSObject (EDODeadline)
+
+/**
+ * Method to be called on invocation target to make the next remote invocation with a deadline.
+ *
+ * The message sent to the returned proxy is sent to the remote object with the deadline that is
+ * the @c timeout from when the message is sent.
+ *
+ * @code
+ *   [[remoteObject edo_withTimeout:5] doSomethingWithObject:object];
+ * @endcode
+ *
+ * @note This should not be called on a non-remote object.
+ * @param timeout The timeout in seconds of the invocation.
+ *
+ * @return The proxy to make the invocation.
+ */
+- (instancetype)edo_withTimeout:(NSTimeInterval)timeout;
+
+@end
+
+NS_ASSUME_NONNULL_END
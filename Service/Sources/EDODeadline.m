@@ -0,0 +1,160 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDODeadline.h"
+
+#include <mach/mach_time.h>
+
+#import "Service/Sources/EDODeadline+Private.h"
+#import "Service/Sources/EDOObject.h"
+#import "Service/Sources/EDOServiceError.h"
+#import "Service/Sources/EDOServiceRequest.h"
+
+/** The key to save the deadline in effect to the thread dictionary. */
+static NSString *const kEDOCurrentDeadlineKey = @"EDOCurrentDeadline";
+
+/** The longest timeout in seconds, which keeps the mach time of the deadline from overflowing. */
+static const NSTimeInterval kEDOMaxTimeout = 365 * 24 * 60 * 60;
+
+/** Converts the nanoseconds to the mach absolute time units, or back if @c toMachTime is NO. */
+static uint64_t EDOConvertMachTime(uint64_t value, BOOL toMachTime) {
+  static mach_timebase_info_data_t timebaseInfo;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebaseInfo);
+  });
+  // The conversion is in double to not overflow with the long timeouts.
+  double ratio = (double)timebaseInfo.numer / timebaseInfo.denom;
+  return (uint64_t)(toMachTime ? value / ratio : value * ratio);
+}
+
+@implementation EDODeadline {
+  // The mach absolute time of the deadline.
+  uint64_t _machTime;
+}
+
++ (EDODeadline *)currentDeadline {
+  return NSThread.currentThread.threadDictionary[kEDOCurrentDeadlineKey];
+}
+
++ (instancetype)deadlineWithTimeout:(NSTimeInterval)timeout {
+  timeout = MIN(MAX(timeout, 0), kEDOMaxTimeout);
+  uint64_t timeoutInNanoseconds = (uint64_t)(timeout * NSEC_PER_SEC);
+  return [[self alloc] initWithMachTime:mach_absolute_time() +
+                                        EDOConvertMachTime(timeoutInNanoseconds, YES)];
+}
+
+- (instancetype)initWithMachTime:(uint64_t)machTime {
+  self = [super init];
+  if (self) {
+    _machTime = machTime;
+  }
+  return self;
+}
+
+- (NSTimeInterval)remainingTime {
+  uint64_t now = mach_absolute_time();
+  if (now >= _machTime) {
+    return 0;
+  }
+  return (NSTimeInterval)EDOConvertMachTime(_machTime - now, NO) / NSEC_PER_SEC;
+}
+
+- (BOOL)isExpired {
+  return mach_absolute_time() >= _machTime;
+}
+
+- (dispatch_time_t)dispatchTime {
+  return dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.remainingTime * NSEC_PER_SEC));
+}
+
++ (NSError *)deadlineExceededErrorForRequest:(EDOServiceRequest *)request
+                                        port:(EDOHostPort *)port {
+  NSMutableDictionary<NSErrorUserInfoKey, id> *userInfo = [@{
+    EDOErrorRequestKey : request.description ?: @"(empty request)",
+    NSLocalizedDescriptionKey : @"The remote invocation didn't complete before its deadline.",
+  } mutableCopy];
+  userInfo[EDOErrorPortKey] = port;
+  return [NSError errorWithDomain:EDOServiceErrorDomain
+                             code:EDOServiceErrorDeadlineExceeded
+                         userInfo:userInfo];
+}
+
+- (void)performBlock:(NS_NOESCAPE void (^)(void))block {
+  NSMutableDictionary<id, id> *threadDictionary = NSThread.currentThread.threadDictionary;
+  EDODeadline *outerDeadline = threadDictionary[kEDOCurrentDeadlineKey];
+  BOOL earlier = !outerDeadline || _machTime < outerDeadline->_machTime;
+  threadDictionary[kEDOCurrentDeadlineKey] = earlier ? self : outerDeadline;
+  @try {
+    block();
+  } @finally {
+    threadDictionary[kEDOCurrentDeadlineKey] = outerDeadline;
+  }
+}
+
+- (NSString *)description {
+  return [NSString stringWithFormat:@"EDODeadline (%.3fs remaining)", self.remainingTime];
+}
+
+@end
+
+@implementation EDODeadlineObject
+
+- (instancetype)initWithRemoteObject:(EDOObject *)remoteObject timeout:(NSTimeInterval)timeout {
+  _remoteObject = remoteObject;
+  _timeout = timeout;
+  return self;
+}
+
+// Replace the timeout when it's called again.
+- (instancetype)edo_withTimeout:(NSTimeInterval)timeout {
+  return [[EDODeadlineObject alloc] initWithRemoteObject:_remoteObject timeout:timeout];
+}
+
+- (NSString *)description {
+  return [_remoteObject description];
+}
+
+#pragma mark - NSProxy
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+  [[EDODeadline deadlineWithTimeout:_timeout] performBlock:^{
+    [invocation invokeWithTarget:self->_remoteObject];
+  }];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)sel {
+  __block NSMethodSignature *signature;
+  [[EDODeadline deadlineWithTimeout:_timeout] performBlock:^{
+    signature = [self->_remoteObject methodSignatureForSelector:sel];
+  }];
+  return signature;
+}
+
+@end
+
+@implementation NSObject (EDODeadline)
+
+- (instancetype)edo_withTimeout:(NSTimeInterval)timeout {
+  NSString *reason =
+      @"Not a remote object. edo_withTimeout: call isn't supported on non-remote objects.";
+  NSException *exception =
+      [NSException exceptionWithName:NSObjectNotAvailableException reason:reason userInfo:nil];
+  @throw exception;  // NOLINT
+  return nil;
+}
+
+@end
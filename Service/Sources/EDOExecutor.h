@@ -71,6 +71,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)handleBlock:(void (^)(void))executeBlock error:(NSError *_Nullable *_Nullable)errorOrNil;
 
+/**
+ * Attaches @c executeBlock to an internal EDOBlockingQueue without waiting for its completion.
+ *
+ * The blocks are executed in the order they are handled, the same as
+ * EDOExecutor::handleBlock:error:, but the caller can go on to handle the next block while this
+ * one waits to be executed.
+ *
+ * @param      executeBlock   The block to be handled and executed.
+ * @param[out] errorOrNil     Error that will be populated on failure.
+ *
+ * @return @c YES if the block is successfully scheduled to be executed by the executor; @c NO
+ *         otherwise, in which case the block won't get invoked.
+ */
+- (BOOL)handleBlockAsynchronously:(void (^)(void))executeBlock
+                            error:(NSError *_Nullable *_Nullable)errorOrNil;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -95,6 +95,29 @@
            @"Only enqueue a request from a non-tracked queue.");
 #pragma clang diagnostic pop
 
+  EDOExecutorMessage *message = [self dispatchBlock:executeBlock error:errorOrNil];
+  [message waitForCompletion];
+  return message != nil;
+}
+
+- (BOOL)handleBlockAsynchronously:(void (^)(void))executeBlock
+                            error:(NSError *_Nullable *_Nullable)errorOrNil {
+  return [self dispatchBlock:executeBlock error:errorOrNil] != nil;
+}
+
+#pragma mark - Private
+
+/**
+ * Enqueues the block to the message queue that the executor is looping, or dispatches it to the
+ * @c executionQueue if the executor is not looping.
+ *
+ * @param      executeBlock The block to be executed.
+ * @param[out] errorOrNil   Error that will be populated on failure.
+ *
+ * @return The message of the block to wait for, or @c nil if the execution queue is released.
+ */
+- (EDOExecutorMessage *)dispatchBlock:(void (^)(void))executeBlock
+                                error:(NSError *_Nullable *_Nullable)errorOrNil {
   EDOExecutorMessage *message = [[EDOExecutorMessage alloc] initWithBlock:executeBlock];
   if (![self enqueueMessage:message]) {
     dispatch_queue_t executionQueue = self.executionQueue;
@@ -110,15 +133,12 @@
                                           code:EDOServiceErrorRequestNotHandled
                                       userInfo:@{@"reason" : reason}];
       }
-      return NO;
+      return nil;
     }
   }
-  [message waitForCompletion];
-  return YES;
+  return message;
 }
 
-#pragma mark - Private
-
 /**
  * Check if a message can be enqueued to a message queue that will be executed on the
  * @c executionQueue. The message is appended to the message queue if this passes.
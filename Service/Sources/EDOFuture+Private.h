@@ -0,0 +1,67 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Service/Sources/EDOFuture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOExecutor;
+@class EDOObject;
+
+/** The internal use to complete an @c EDOFuture. */
+@interface EDOFuture (Private)
+
+/** Creates a future that isn't done yet. */
+- (instancetype)initInternal;
+
+/**
+ * Sets the executor of the temporary service that the invocation is made with on the current
+ * thread, which handles the incoming requests while the future is waited on the same thread.
+ */
+- (void)setTemporaryExecutorForCurrentThread:(EDOExecutor *)executor;
+
+/**
+ * Completes the future, which only takes effect the first time.
+ *
+ * @param result    The value returned by the invocation.
+ * @param exception The exception that the invocation raises.
+ * @param error     The error if the invocation fails to be sent or received.
+ */
+- (void)finishWithResult:(nullable id)result
+               exception:(nullable NSException *)exception
+                   error:(nullable NSError *)error;
+
+@end
+
+/**
+ * The proxy for @c EDOObject to make the next remote invocation asynchronously, whose result is
+ * delivered to the future of the proxy.
+ */
+@interface EDOAsyncObject : NSProxy
+
+/** The remote object to make the invocation on. */
+@property(nonatomic, readonly) EDOObject *remoteObject;
+/** The future of the invocation. */
+@property(nonatomic, readonly) EDOFuture *future;
+
+/** Initialize the @c EDOAsyncObject as the proxy of given @c remoteObject. */
+- (instancetype)initWithRemoteObject:(EDOObject *)remoteObject;
+
+@end
+
+NS_ASSUME_NONNULL_END
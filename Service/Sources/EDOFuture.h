@@ -0,0 +1,96 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The future result of a remote invocation that is made asynchronously.
+ *
+ * The future is done once the response of the invocation is received, or the invocation fails.
+ * Its properties are only set when it's done.
+ */
+@interface EDOFuture : NSObject
+
+/** Whether the invocation has completed. */
+@property(readonly, getter=isDone) BOOL done;
+
+/**
+ * The value returned by the invocation.
+ *
+ * The object is returned as is, the other types are boxed in an @c NSValue, and it's @c nil if the
+ * method returns @c void.
+ */
+@property(readonly, nullable) id result;
+
+/** The exception that the remote invocation raises. */
+@property(readonly, nullable) NSException *exception;
+
+/** The error if the invocation fails to be sent or received. */
+@property(readonly, nullable) NSError *error;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Waits for the invocation to complete.
+ *
+ * If the current queue has a host service, its executor handles the incoming requests while
+ * waiting, so the remote invocation can call back to the objects served on the current queue.
+ *
+ * @throw The remote exception if the invocation raises one. The error is reported to the client
+ *        error handler, which raises an exception by default.
+ *
+ * @return The @c result of the invocation.
+ */
+- (nullable id)waitForResult;
+
+/**
+ * Invokes the handler once the invocation completes, or right away if it has completed.
+ *
+ * @param queue   The queue to invoke the handler on.
+ * @param handler The handler to be invoked with the future.
+ */
+- (void)notifyOnQueue:(dispatch_queue_t)queue handler:(void (^)(EDOFuture *future))handler;
+
+@end
+
+/** The API to make the remote invocations asynchronously. */
+@interface NSObject (EDOAsync)
+
+/**
+ * Method to be called on invocation target to make the next remote invocation asynchronously.
+ *
+ * The message sent to the returned proxy is sent to the remote object without waiting for the
+ * response, and it returns zero or @c nil. The result is delivered to the @c future. The arguments
+ * can't point to the objects to be filled back, for example, an @c NSError **.
+ *
+ * @code
+ *   EDOFuture *future;
+ *   [[remoteObject edo_asyncWithFuture:&future] doSomethingWithObject:object];
+ *   id result = [future waitForResult];
+ * @endcode
+ *
+ * @note This should not be called on a non-remote object.
+ * @param[out] future The future of the invocation made by the returned proxy.
+ *
+ * @return The proxy to make the invocation.
+ */
+- (instancetype)edo_asyncWithFuture:(EDOFuture *_Nullable *_Nonnull)future;
+
+@end
+
+NS_ASSUME_NONNULL_END
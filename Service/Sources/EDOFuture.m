@@ -0,0 +1,163 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOFuture.h"
+
+#import "Service/Sources/EDOClientService+Private.h"
+#import "Service/Sources/EDOExecutor.h"
+#import "Service/Sources/EDOFuture+Private.h"
+#import "Service/Sources/EDOHostService+Private.h"
+#import "Service/Sources/EDOHostService.h"
+#import "Service/Sources/EDOObject+Private.h"
+#import "Service/Sources/EDOObject.h"
+
+@interface EDOFuture ()
+@property(readwrite, getter=isDone) BOOL done;
+@property(readwrite, nullable) id result;
+@property(readwrite, nullable) NSException *exception;
+@property(readwrite, nullable) NSError *error;
+@end
+
+@implementation EDOFuture {
+  // The group that is entered until the future is done.
+  dispatch_group_t _group;
+  // The executor of the temporary service and the thread that it is created for.
+  EDOExecutor *_temporaryExecutor;
+  __weak NSThread *_temporaryExecutorThread;
+}
+
+- (instancetype)initInternal {
+  self = [super init];
+  if (self) {
+    _group = dispatch_group_create();
+    dispatch_group_enter(_group);
+  }
+  return self;
+}
+
+- (void)setTemporaryExecutorForCurrentThread:(EDOExecutor *)executor {
+  @synchronized(self) {
+    _temporaryExecutor = executor;
+    _temporaryExecutorThread = [NSThread currentThread];
+  }
+}
+
+- (void)finishWithResult:(id)result exception:(NSException *)exception error:(NSError *)error {
+  @synchronized(self) {
+    if (self.done) {
+      return;
+    }
+    self.result = result;
+    self.exception = exception;
+    self.error = error;
+    self.done = YES;
+    _temporaryExecutor = nil;
+  }
+  dispatch_group_leave(_group);
+}
+
+- (id)waitForResult {
+  EDOExecutor *executor = [EDOHostService serviceForCurrentExecutingQueue].executor;
+  @synchronized(self) {
+    if (!executor && _temporaryExecutorThread == [NSThread currentThread]) {
+      executor = _temporaryExecutor;
+    }
+  }
+
+  dispatch_group_t group = _group;
+  if (executor && !self.done) {
+    // The executor handles the incoming requests, which the remote invocation may make to the
+    // objects of the current queue, until the future is done.
+    [executor loopWithBlock:^{
+      dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }];
+  } else {
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+  }
+
+  if (self.error) {
+    EDOExportEDOClientError(self.error);
+    return nil;
+  }
+  if (self.exception) {
+    // Note: we throw here rather than -[raise] because we can't make an assumption of what user's
+    //       code will throw.
+    @throw self.exception;  // NOLINT
+  }
+  return self.result;
+}
+
+- (void)notifyOnQueue:(dispatch_queue_t)queue handler:(void (^)(EDOFuture *future))handler {
+  dispatch_group_notify(_group, queue, ^{
+    handler(self);
+  });
+}
+
+@end
+
+@implementation EDOAsyncObject {
+  // Whether the proxy has made its invocation.
+  BOOL _invoked;
+}
+
+- (instancetype)initWithRemoteObject:(EDOObject *)remoteObject {
+  _remoteObject = remoteObject;
+  _future = [[EDOFuture alloc] initInternal];
+  return self;
+}
+
+// Keep the original behavior when nested async is called.
+- (instancetype)edo_asyncWithFuture:(EDOFuture **)future {
+  *future = _future;
+  return self;
+}
+
+- (NSString *)description {
+  return [_remoteObject description];
+}
+
+#pragma mark - NSProxy
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+  @synchronized(self) {
+    if (_invoked) {
+      [[NSException exceptionWithName:NSInternalInconsistencyException
+                               reason:@"The asynchronous proxy only makes one invocation."
+                             userInfo:nil] raise];
+    }
+    _invoked = YES;
+  }
+  [_remoteObject edo_forwardInvocation:invocation selector:invocation.selector future:_future];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)sel {
+  return [_remoteObject methodSignatureForSelector:sel];
+}
+
+@end
+
+@implementation NSObject (EDOAsync)
+
+- (instancetype)edo_asyncWithFuture:(EDOFuture **)future {
+  NSString *reason =
+      @"Not a remote object. edo_asyncWithFuture: call isn't supported on non-remote objects.";
+  NSException *exception =
+      [NSException exceptionWithName:NSObjectNotAvailableException reason:reason userInfo:nil];
+  @throw exception;  // NOLINT
+  return nil;
+}
+
+@end
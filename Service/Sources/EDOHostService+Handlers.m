@@ -16,6 +16,7 @@
 
 #import "Service/Sources/EDOHostService+Handlers.h"
 
+#import "Service/Sources/EDOBatchInvocationMessage.h"
 #import "Service/Sources/EDOClassMessage.h"
 #import "Service/Sources/EDOInvocationMessage.h"
 #import "Service/Sources/EDOMethodSignatureMessage.h"
@@ -32,6 +33,7 @@
   dispatch_once(&onceToken, ^{
     handlers = [[NSMutableDictionary alloc] init];
     NSArray *requestClasses = @[
+      [EDOBatchInvocationRequest class],
       [EDOClassRequest class],
       [EDOInvocationRequest class],
       [EDOMethodSignatureRequest class],
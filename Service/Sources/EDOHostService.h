@@ -31,6 +31,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @interface EDOHostService : NSObject
 
+/**
+ * Whether the services created afterwards also listen on a UNIX domain socket besides the TCP port.
+ *
+ * The clients on the same machine connect to the UNIX domain socket if it's available, which
+ * avoids the TCP stack for the local connections. The default value is @c NO.
+ */
+@property(class) BOOL listensOnLocalSocket;
+
+/**
+ * Whether the services created afterwards also accept the shared memory channels besides the TCP
+ * port.
+ *
+ * The clients on the same machine prefer the shared memory channel if it's available, which
+ * exchanges the data through the memory mapped into both processes and wakes up the peer only if
+ * it is waiting. The default value is @c NO.
+ */
+@property(class) BOOL listensOnSharedMemory;
+
 /** The port to identify the service. */
 @property(readonly, nonatomic) EDOServicePort *port;
 
@@ -59,6 +77,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property(nonatomic, readonly, nullable) dispatch_queue_t executingQueue;
 
+/**
+ * The time in seconds a request runs before the service pings the client that it's handling it.
+ *
+ * The client times out the request if it receives neither the ping nor the response in 10 seconds,
+ * so the delay should be well below that. The requests that complete within the delay are answered
+ * with the response alone. Setting it to 0 pings every request as soon as it's received, as the
+ * earlier services do. The default value is 1 second.
+ */
+@property NSTimeInterval pingDelay;
+
 /**
  * Creates a service with the object and its associated execution queue.
  *
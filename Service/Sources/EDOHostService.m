@@ -20,6 +20,7 @@
 
 #import "Channel/Sources/EDOChannel.h"
 #import "Channel/Sources/EDOHostPort.h"
+#import "Channel/Sources/EDOSharedMemoryChannel.h"
 #import "Channel/Sources/EDOSocket.h"
 #import "Channel/Sources/EDOSocketChannel.h"
 #import "Channel/Sources/EDOSocketPort.h"
@@ -27,11 +28,13 @@
 #import "Service/Sources/EDOBlockObject.h"
 #import "Service/Sources/EDOClientService+Private.h"
 #import "Service/Sources/EDOClientService.h"
+#import "Service/Sources/EDODeadline+Private.h"
 #import "Service/Sources/EDOExecutor.h"
 #import "Service/Sources/EDOHostNamingService+Private.h"
 #import "Service/Sources/EDOHostNamingService.h"
 #import "Service/Sources/EDOHostService+Handlers.h"
 #import "Service/Sources/EDOHostService+Private.h"
+#import "Service/Sources/EDOMessageCoder.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObject.h"
 #import "Service/Sources/EDOObjectReleaseMessage.h"
@@ -39,8 +42,6 @@
 #import "Service/Sources/EDOServicePort.h"
 #import "Service/Sources/EDOServiceRequest.h"
 #import "Service/Sources/EDOTimingFunctions.h"
-#import "Service/Sources/NSKeyedArchiver+EDOAdditions.h"
-#import "Service/Sources/NSKeyedUnarchiver+EDOAdditions.h"
 
 /** The context key to save the service to the dispatch queue. This shall be removed later. */
 static const char *gServiceKey = "com.google.edo.servicekey";
@@ -57,6 +58,15 @@ static NSString *const kCacheTemporaryHostServiceKey = @"EDOTemporaryHostService
 /** Release the context saved to the dispatch queue. */
 static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 
+/** Whether the services also listen on the UNIX domain socket. */
+static BOOL gListensOnLocalSocket = NO;
+
+/** Whether the services also accept the shared memory channels. */
+static BOOL gListensOnSharedMemory = NO;
+
+/** The default time in seconds a request runs before the service pings the client. */
+static const NSTimeInterval kDefaultPingDelay = 1;
+
 #pragma mark - EDODispatchQueueWeakRef
 
 /**
@@ -92,6 +102,10 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 @property(nonatomic, readonly) dispatch_queue_t handlerSyncQueue;
 /** The listen socket. */
 @property(nonatomic, readonly) EDOSocket *listenSocket;
+/** The listen socket of the UNIX domain socket if @c listensOnLocalSocket is enabled. */
+@property(nonatomic, readonly) EDOSocket *localListenSocket;
+/** The listen socket for the shared memory channels if @c listensOnSharedMemory is enabled. */
+@property(nonatomic, readonly) EDOSocket *sharedMemoryListenSocket;
 /**
  * The tracked objects in the service. The key is the address of a tracked object and the value is
  * the object.
@@ -127,6 +141,22 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 
 @synthesize port = _port;
 
++ (BOOL)listensOnLocalSocket {
+  return gListensOnLocalSocket;
+}
+
++ (void)setListensOnLocalSocket:(BOOL)listensOnLocalSocket {
+  gListensOnLocalSocket = listensOnLocalSocket;
+}
+
++ (BOOL)listensOnSharedMemory {
+  return gListensOnSharedMemory;
+}
+
++ (void)setListensOnSharedMemory:(BOOL)listensOnSharedMemory {
+  gListensOnSharedMemory = listensOnSharedMemory;
+}
+
 + (instancetype)serviceForCurrentOriginatingQueue {
   EDOWeakReference *weakRef =
       (__bridge EDOWeakReference *)dispatch_get_specific(&kEDOOriginatingQueueKey);
@@ -232,6 +262,7 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 
     _executionQueue = queue;
     _executor = [[EDOExecutor alloc] initWithQueue:queue];
+    _pingDelay = kDefaultPingDelay;
 
     // Only creates the listen socket when the port is given or the root object is given so we need
     // to serve them at launch.
@@ -245,6 +276,7 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
       _listenSocket = [self edo_createListenSocket:port];
       _port = [EDOServicePort servicePortWithPort:_listenSocket.socketPort.port
                                       serviceName:serviceName];
+      [self edo_startListeningOnLocalSocketsIfNeeded];
       [EDOHostNamingService.sharedService addServicePort:_port];
       NSLog(@"The EDOHostService (%p) is created and listening on %d", self, _port.hostPort.port);
     }
@@ -279,6 +311,8 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
   }
   [EDOHostNamingService.sharedService removeServicePort:_port];
   [self.listenSocket invalidate];
+  [self.localListenSocket invalidate];
+  [self.sharedMemoryListenSocket invalidate];
 
   [self edo_removeServiceFromOriginatingQueues];
 
@@ -297,6 +331,7 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
   if (!_port) {
     _listenSocket = [self edo_createListenSocket:0];
     _port = [EDOServicePort servicePortWithPort:_listenSocket.socketPort.port serviceName:nil];
+    [self edo_startListeningOnLocalSocketsIfNeeded];
     NSLog(@"The EDOHostService (%p) is created lazily and listening on %d", self,
           _port.hostPort.port);
   }
@@ -432,6 +467,11 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 - (void)startReceivingRequestsForChannel:(id<EDOChannel>)channel {
   __block __weak EDOChannelReceiveHandler weakHandlerBlock;
   __weak EDOHostService *weakSelf = self;
+  // The requests on the channel are decoded in the order they are received, and the responses are
+  // encoded in the order they are sent, so each end of the channel interns the strings in the same
+  // order.
+  EDOMessageInternTable *requestInternTable = [[EDOMessageInternTable alloc] init];
+  EDOMessageInternTable *responseInternTable = [[EDOMessageInternTable alloc] init];
 
   // This handler block will be executed recursively by calling itself at the end of the
   // block in order to accept new request after last one is executed.
@@ -477,9 +517,11 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
       return;
     }
     EDOServiceRequest *request;
+    // The responses are sent in the coding of the request, which the client can decode.
+    BOOL binaryCoding = [EDOMessageCoder isBinaryCodedData:data];
 
     @try {
-      request = [NSKeyedUnarchiver edo_unarchiveObjectWithData:data];
+      request = [EDOMessageCoder messageWithData:data internTable:requestInternTable];
     } @catch (NSException *e) {
       // TODO(haowoo): Handle exceptions in a better way.
       exception = e;
@@ -496,16 +538,23 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
         error = [NSError errorWithDomain:NSPOSIXErrorDomain code:0 userInfo:nil];
       }
       EDOServiceResponse *errorResponse = [EDOErrorResponse errorResponse:error forRequest:request];
-      NSData *errorData = [NSKeyedArchiver edo_archivedDataWithObject:errorResponse];
-      [targetChannel sendData:errorData
-          withCompletionHandler:^(id<EDOChannel> _Nonnull _channel, NSError *_Nullable error) {
-            dispatch_queue_t handlerSyncQueue = strongSelf.handlerSyncQueue;
-            if (handlerSyncQueue) {
-              dispatch_sync(handlerSyncQueue, ^{
-                [strongSelf.handlerSet removeObject:strongHandlerBlock];
-              });
-            }
-          }];
+      errorResponse.legacyMessageID = request.legacyMessageID;
+      // The earlier requests may still be completing, so the response is encoded and sent under
+      // the same lock as theirs.
+      @synchronized(responseInternTable) {
+        NSData *errorData = [EDOMessageCoder dataWithMessage:errorResponse
+                                                binaryCoding:binaryCoding
+                                                 internTable:responseInternTable];
+        [targetChannel sendData:errorData
+            withCompletionHandler:^(id<EDOChannel> _Nonnull _channel, NSError *_Nullable error) {
+              dispatch_queue_t handlerSyncQueue = strongSelf.handlerSyncQueue;
+              if (handlerSyncQueue) {
+                dispatch_sync(handlerSyncQueue, ^{
+                  [strongSelf.handlerSet removeObject:strongHandlerBlock];
+                });
+              }
+            }];
+      }
     } else {
       // For release request, we don't handle it in executor since response is not
       // needed for this request. The request handler will process this request
@@ -520,28 +569,76 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
           [EDOObjectReleaseRequest requestHandler](request, strongSelf);
         }
       } else {
-        // Health check for the channel.
-        [targetChannel sendData:EDOClientService.pingMessageData withCompletionHandler:nil];
+        // Health check for the channel. The client is only pinged if the request is still running
+        // after the ping delay, so the fast request is answered by the response alone, which the
+        // client accepts in place of the ping. The ping is sent under the same lock as the
+        // response, so it's never sent after the response.
+        __block BOOL responded = NO;
+        void (^sendPing)(void) = ^{
+          @synchronized(responseInternTable) {
+            if (!responded) {
+              [targetChannel sendData:EDOClientService.pingMessageData withCompletionHandler:nil];
+            }
+          }
+        };
+        NSTimeInterval pingDelay = strongSelf.pingDelay;
+        if (pingDelay > 0) {
+          dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(pingDelay * NSEC_PER_SEC)),
+                         dispatch_get_global_queue(qos_class_self(), 0), sendPing);
+        } else {
+          sendPing();
+        }
+        // The client can pipeline the requests on the channel, so the next request is received
+        // while this one is handled. The response is sent as soon as the request completes, which
+        // can be before the earlier requests complete if they wait for the nested invocations, and
+        // the client matches the responses by their message IDs.
+        void (^sendResponse)(EDOServiceResponse *) = ^(EDOServiceResponse *response) {
+          response = response ?: [EDOErrorResponse unhandledErrorResponseForRequest:request];
+          response.legacyMessageID = request.legacyMessageID;
+          @synchronized(responseInternTable) {
+            responded = YES;
+            NSData *responseData = [EDOMessageCoder dataWithMessage:response
+                                                       binaryCoding:binaryCoding
+                                                        internTable:responseInternTable];
+            [targetChannel sendData:responseData withCompletionHandler:nil];
+          }
+        };
         NSString *requestClassName = NSStringFromClass([request class]);
         EDORequestHandler handler = EDOHostService.handlers[requestClassName];
-        __block EDOServiceResponse *response = nil;
-        NSError *error;
+        // The deadline of the request counts from when it's received, as the clocks of the client
+        // and the service may not agree. The request that expires before it runs is rejected, and
+        // the remote invocations made to handle it have the same deadline.
+        EDODeadline *deadline = request.remainingTime > 0
+                                    ? [EDODeadline deadlineWithTimeout:request.remainingTime]
+                                    : nil;
+        EDOHostPort *hostPort = strongSelf.port.hostPort;
         if (handler) {
-          __weak EDOServiceRequest *weakRequest = request;
           void (^requestHandler)(void) = ^{
+            if (deadline.expired) {
+              NSError *error = [EDODeadline deadlineExceededErrorForRequest:request port:hostPort];
+              sendResponse([EDOErrorResponse errorResponse:error forRequest:request]);
+              return;
+            }
             uint64_t currentTime = mach_absolute_time();
-            response = handler(weakRequest, weakSelf);
+            __block EDOServiceResponse *response;
+            void (^handleRequest)(void) = ^{
+              response = handler(request, weakSelf);
+            };
+            if (deadline) {
+              [deadline performBlock:handleRequest];
+            } else {
+              handleRequest();
+            }
             response.duration = EDOGetMillisecondsSinceMachTime(currentTime);
+            sendResponse(response);
           };
-          BOOL isHandled = [strongSelf.executor handleBlock:requestHandler error:&error];
-          if (!isHandled) {
-            response = [EDOErrorResponse errorResponse:error forRequest:request];
+          NSError *error;
+          if (![strongSelf.executor handleBlockAsynchronously:requestHandler error:&error]) {
+            sendResponse([EDOErrorResponse errorResponse:error forRequest:request]);
           }
+        } else {
+          sendResponse(nil);
         }
-
-        response = response ?: [EDOErrorResponse unhandledErrorResponseForRequest:request];
-        NSData *responseData = [NSKeyedArchiver edo_archivedDataWithObject:response];
-        [targetChannel sendData:responseData withCompletionHandler:nil];
       }
       if ([strongSelf edo_shouldReceiveData:channel]) {
         [targetChannel receiveDataWithHandler:strongHandlerBlock];
@@ -557,6 +654,14 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
   receiveHandler = [receiveHandler copy];
   weakHandlerBlock = receiveHandler;
 
+  // The clients can open streams on the socket to send requests concurrently, and each stream is
+  // received in the same way as a separate channel.
+  if ([channel isKindOfClass:[EDOSocketChannel class]]) {
+    ((EDOSocketChannel *)channel).streamHandler = ^(id<EDOChannel> stream) {
+      [weakSelf startReceivingRequestsForChannel:stream];
+    };
+  }
+
   // The channel is strongly referenced in receiveHandler until the channel or the host service is
   // invalidated.
   [channel receiveDataWithHandler:receiveHandler];
@@ -567,32 +672,76 @@ static void ReleaseContext(void *context) { CFBridgingRelease(context); }
 }
 
 - (EDOSocket *)edo_createListenSocket:(UInt16)port {
-  __weak EDOHostService *weakSelf = self;
   return [EDOSocket listenWithTCPPort:port
                                 queue:nil
-                       connectedBlock:^(EDOSocket *socket, NSError *error) {
-                         EDOHostService *strongSelf = weakSelf;
-                         if (!strongSelf) {
-                           // TODO(haowoo): Add more info to the response when the service becomes
-                           // invalid.
-                           [socket invalidate];
-                           return;
-                         }
-
-                         dispatch_queue_t handlerQueue = nil;
-                         dispatch_queue_t executionQueue = strongSelf.executionQueue;
-                         if (executionQueue) {
-                           dispatch_queue_attr_t queueAttributes =
-                               dispatch_queue_attr_make_with_qos_class(
-                                   DISPATCH_QUEUE_SERIAL,
-                                   dispatch_queue_get_qos_class(executionQueue, nil), 0);
-                           handlerQueue = dispatch_queue_create(
-                               "com.google.edo.socketChannel.handler", queueAttributes);
-                         }
-                         id<EDOChannel> clientChannel =
-                             [EDOSocketChannel channelWithSocket:socket handlerQueue:handlerQueue];
-                         [strongSelf startReceivingRequestsForChannel:clientChannel];
-                       }];
+                       connectedBlock:[self edo_connectedBlockWithSharedMemory:NO]];
+}
+
+/** Listens on the UNIX domain sockets for the TCP port if they are enabled. */
+- (void)edo_startListeningOnLocalSocketsIfNeeded {
+  EDOHostPort *hostPort = _port.hostPort;
+  if (gListensOnLocalSocket && hostPort.localSocketPath) {
+    _localListenSocket =
+        [self edo_listenOnSocketPath:hostPort.localSocketPath
+                      connectedBlock:[self edo_connectedBlockWithSharedMemory:NO]];
+  }
+  if (gListensOnSharedMemory && hostPort.sharedMemorySocketPath) {
+    _sharedMemoryListenSocket =
+        [self edo_listenOnSocketPath:hostPort.sharedMemorySocketPath
+                      connectedBlock:[self edo_connectedBlockWithSharedMemory:YES]];
+  }
+}
+
+- (EDOSocket *)edo_listenOnSocketPath:(NSString *)path
+                       connectedBlock:(EDOSocketConnectedBlock)connectedBlock {
+  EDOSocket *listenSocket = [EDOSocket listenWithSocketPath:path
+                                                      queue:nil
+                                             connectedBlock:connectedBlock];
+  if (!listenSocket) {
+    NSLog(@"[eDistantObject] The EDOHostService (%p) fails to listen on %@", self, path);
+  }
+  return listenSocket;
+}
+
+/**
+ * The block to start receiving requests from the connections accepted by the listen sockets.
+ *
+ * @param sharedMemory Whether the accepted connections set up the shared memory channels.
+ */
+- (EDOSocketConnectedBlock)edo_connectedBlockWithSharedMemory:(BOOL)sharedMemory {
+  __weak EDOHostService *weakSelf = self;
+  return ^(EDOSocket *socket, NSError *error) {
+    EDOHostService *strongSelf = weakSelf;
+    if (!strongSelf) {
+      // TODO(haowoo): Add more info to the response when the service becomes invalid.
+      [socket invalidate];
+      return;
+    }
+
+    dispatch_queue_t handlerQueue = nil;
+    dispatch_queue_t executionQueue = strongSelf.executionQueue;
+    if (executionQueue) {
+      dispatch_queue_attr_t queueAttributes = dispatch_queue_attr_make_with_qos_class(
+          DISPATCH_QUEUE_SERIAL, dispatch_queue_get_qos_class(executionQueue, nil), 0);
+      handlerQueue =
+          dispatch_queue_create("com.google.edo.socketChannel.handler", queueAttributes);
+    }
+    id<EDOChannel> clientChannel;
+    if (sharedMemory) {
+      NSError *channelError;
+      clientChannel = [EDOSharedMemoryChannel channelWithAcceptedSocket:socket
+                                                           handlerQueue:handlerQueue
+                                                                  error:&channelError];
+      if (!clientChannel) {
+        NSLog(@"[eDistantObject] The EDOHostService (%p) fails to set up the shared memory: %@",
+              strongSelf, channelError);
+        return;
+      }
+    } else {
+      clientChannel = [EDOSocketChannel channelWithSocket:socket handlerQueue:handlerQueue];
+    }
+    [strongSelf startReceivingRequestsForChannel:clientChannel];
+  };
 }
 
 - (void)edo_registerServiceAsyncOnDevice {
@@ -0,0 +1,69 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOFuture;
+
+/**
+ * The batch of remote invocations that are recorded and then made in one round trip per service.
+ *
+ * The messages sent to a recorder are recorded in the batch instead of being sent right away, and
+ * they return zero or @c nil. @c -flush sends all the recorded invocations at once, which the
+ * remote service makes in the order they are recorded.
+ *
+ * @code
+ *   EDOInvocationBatch *batch = [[EDOInvocationBatch alloc] init];
+ *   id recorder = [batch recorderForObject:remoteObject];
+ *   [recorder setName:@"name"];
+ *   [recorder setCount:3];
+ *   NSArray<EDOFuture *> *futures = [batch flush];
+ * @endcode
+ *
+ * The arguments can't point to the objects to be filled back, for example, an @c NSError **.
+ */
+@interface EDOInvocationBatch : NSObject
+
+/** The number of the invocations recorded since the last flush. */
+@property(readonly) NSUInteger count;
+
+/**
+ * Returns the proxy that records the messages sent to it as the invocations on @c remoteObject.
+ *
+ * @param remoteObject The remote object to make the invocations on.
+ *
+ * @return The recorder of the invocations on @c remoteObject.
+ */
+- (id)recorderForObject:(id)remoteObject;
+
+/**
+ * Makes the recorded invocations and waits for them to complete.
+ *
+ * The consecutive invocations on the objects of the same service are sent in one request. Each of
+ * them is made even if the one before it raises an exception.
+ *
+ * @throw The first remote exception of the invocations once all of them complete. The error is
+ *        reported to the client error handler, which raises an exception by default.
+ *
+ * @return The futures of the invocations in the order they are recorded, which are all done.
+ */
+- (NSArray<EDOFuture *> *)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
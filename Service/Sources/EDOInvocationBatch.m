@@ -0,0 +1,220 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOInvocationBatch.h"
+
+#include <objc/runtime.h>
+
+#import "Channel/Sources/EDOHostPort.h"
+#import "Service/Sources/EDOBatchInvocationMessage.h"
+#import "Service/Sources/EDOClientService+Private.h"
+#import "Service/Sources/EDOFuture+Private.h"
+#import "Service/Sources/EDOHostService+Private.h"
+#import "Service/Sources/EDOHostService.h"
+#import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOInvocationPlan.h"
+#import "Service/Sources/EDOObject+Private.h"
+#import "Service/Sources/EDOServicePort.h"
+
+/** The invocation recorded in the batch. */
+@interface EDORecordedInvocation : NSObject
+/** The request of the invocation. */
+@property(nonatomic) EDOInvocationRequest *request;
+/** The plan of the method signature to read the result with. */
+@property(nonatomic) EDOInvocationPlan *plan;
+/**
+ * The remote object to make the invocation on, which is kept until the invocation completes as the
+ * request only has its address.
+ */
+@property(nonatomic) EDOObject *target;
+/** The host port of the service to send the invocation to. */
+@property(nonatomic) EDOHostPort *hostPort;
+/** The service that wraps the arguments, which is kept until the invocation completes. */
+@property(nonatomic) EDOHostService *service;
+/** The future of the invocation. */
+@property(nonatomic) EDOFuture *future;
+@end
+
+@implementation EDORecordedInvocation
+@end
+
+@interface EDOInvocationBatch ()
+/** Records the @c invocation on the @c remoteObject. */
+- (void)edo_recordInvocation:(NSInvocation *)invocation onObject:(EDOObject *)remoteObject;
+@end
+
+/** The proxy that records the messages sent to it in the batch. */
+@interface EDOBatchRecorder : NSProxy
+- (instancetype)initWithBatch:(EDOInvocationBatch *)batch remoteObject:(EDOObject *)remoteObject;
+@end
+
+@implementation EDOBatchRecorder {
+  EDOInvocationBatch *_batch;
+  EDOObject *_remoteObject;
+}
+
+- (instancetype)initWithBatch:(EDOInvocationBatch *)batch remoteObject:(EDOObject *)remoteObject {
+  _batch = batch;
+  _remoteObject = remoteObject;
+  return self;
+}
+
+- (NSString *)description {
+  return [_remoteObject description];
+}
+
+#pragma mark - NSProxy
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+  [_batch edo_recordInvocation:invocation onObject:_remoteObject];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)sel {
+  return [_remoteObject methodSignatureForSelector:sel];
+}
+
+@end
+
+@implementation EDOInvocationBatch {
+  // The invocations recorded since the last flush.
+  NSMutableArray<EDORecordedInvocation *> *_invocations;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _invocations = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (NSUInteger)count {
+  @synchronized(self) {
+    return _invocations.count;
+  }
+}
+
+- (id)recorderForObject:(id)remoteObject {
+  if (object_getClass(remoteObject) != [EDOObject class]) {
+    NSString *reason = @"Not a remote object. Only the invocations on the remote objects can be "
+                       @"recorded in the batch.";
+    [[NSException exceptionWithName:NSObjectNotAvailableException reason:reason
+                           userInfo:nil] raise];
+  }
+  return [[EDOBatchRecorder alloc] initWithBatch:self remoteObject:remoteObject];
+}
+
+- (NSArray<EDOFuture *> *)flush {
+  NSArray<EDORecordedInvocation *> *invocations;
+  @synchronized(self) {
+    invocations = [_invocations copy];
+    [_invocations removeAllObjects];
+  }
+
+  // The incoming requests are processed while waiting, the same as the synchronous invocations.
+  EDOExecutor *executor = [EDOHostService serviceForCurrentExecutingQueue].executor;
+  if (!executor && ![EDOHostService serviceForCurrentOriginatingQueue]) {
+    EDOHostService *temporaryService = [EDOHostService temporaryServiceForCurrentThread];
+    executor = temporaryService.valid ? temporaryService.executor : nil;
+  }
+
+  NSException *firstException;
+  NSError *firstError;
+  NSUInteger start = 0;
+  while (start < invocations.count) {
+    // The consecutive invocations to the same service are sent in one request.
+    EDOHostPort *hostPort = invocations[start].hostPort;
+    NSUInteger end = start + 1;
+    while (end < invocations.count && [invocations[end].hostPort isEqual:hostPort]) {
+      ++end;
+    }
+    NSArray<EDORecordedInvocation *> *group =
+        [invocations subarrayWithRange:NSMakeRange(start, end - start)];
+    start = end;
+
+    NSError *error;
+    EDOBatchInvocationRequest *request = [self edo_requestWithInvocations:group];
+    EDOBatchInvocationResponse *response =
+        (EDOBatchInvocationResponse *)[EDOClientService sendSynchronousRequest:request
+                                                                        onPort:hostPort
+                                                                  withExecutor:executor
+                                                                         error:&error];
+    [group enumerateObjectsUsingBlock:^(EDORecordedInvocation *invocation, NSUInteger idx,
+                                        BOOL *stop) {
+      EDOInvocationResponse *invocationResponse =
+          idx < response.responses.count ? response.responses[idx] : nil;
+      id result = invocationResponse ? [EDOObject edo_resultFromResponse:invocationResponse
+                                                                    plan:invocation.plan]
+                                     : nil;
+      [invocation.future finishWithResult:result
+                                exception:invocationResponse.exception
+                                    error:error];
+    }];
+    firstError = firstError ?: error;
+    for (EDOInvocationResponse *invocationResponse in response.responses) {
+      firstException = firstException ?: invocationResponse.exception;
+    }
+  }
+
+  if (firstError) {
+    EDOExportEDOClientError(firstError);
+  }
+  if (firstException) {
+    // Note: we throw here rather than -[raise] because we can't make an assumption of what user's
+    //       code will throw.
+    @throw firstException;  // NOLINT
+  }
+  NSMutableArray<EDOFuture *> *futures =
+      [[NSMutableArray alloc] initWithCapacity:invocations.count];
+  for (EDORecordedInvocation *invocation in invocations) {
+    [futures addObject:invocation.future];
+  }
+  return futures;
+}
+
+#pragma mark - Private
+
+- (void)edo_recordInvocation:(NSInvocation *)invocation onObject:(EDOObject *)remoteObject {
+  EDORecordedInvocation *recordedInvocation = [[EDORecordedInvocation alloc] init];
+  EDOHostService *service = [EDOHostService serviceForCurrentOriginatingQueue]
+                                ?: [EDOHostService temporaryServiceForCurrentThread];
+  EDOInvocationPlan *plan;
+  recordedInvocation.request = [remoteObject edo_requestWithInvocation:invocation
+                                                              selector:invocation.selector
+                                                               service:service
+                                                                  plan:&plan];
+  recordedInvocation.plan = plan;
+  recordedInvocation.target = remoteObject;
+  recordedInvocation.hostPort = remoteObject.servicePort.hostPort;
+  recordedInvocation.service = service;
+  recordedInvocation.future = [[EDOFuture alloc] initInternal];
+  @synchronized(self) {
+    [_invocations addObject:recordedInvocation];
+  }
+}
+
+/** Creates the request of the recorded invocations. */
+- (EDOBatchInvocationRequest *)edo_requestWithInvocations:
+    (NSArray<EDORecordedInvocation *> *)invocations {
+  NSMutableArray<EDOInvocationRequest *> *requests =
+      [[NSMutableArray alloc] initWithCapacity:invocations.count];
+  for (EDORecordedInvocation *invocation in invocations) {
+    [requests addObject:invocation.request];
+  }
+  return [EDOBatchInvocationRequest requestWithInvocations:requests];
+}
+
+@end
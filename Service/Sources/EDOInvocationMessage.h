@@ -23,6 +23,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class EDOHostPort;
 @class EDOHostService;
+@class EDOInvocationPlan;
 @class EDOParameter;
 typedef EDOParameter EDOBoxedValueType;
 
@@ -54,6 +55,7 @@ typedef EDOParameter EDOBoxedValueType;
  * Creates an invocation request from an @c invocation on an EDOObject.
  *
  * @param invocation    The invocation.
+ * @param plan          The plan of the method signature of the @c invocation.
  * @param target        The EDOObject.
  * @param selector      The selector to be sent. When this is nil, the case for a block invocation,
  *                      the index of the actual arguments starts at 1; otherwise the case for an
@@ -65,6 +67,7 @@ typedef EDOParameter EDOBoxedValueType;
  * @return An instance of EDOInvocationRequest.
  */
 + (instancetype)requestWithInvocation:(NSInvocation *)invocation
+                                 plan:(EDOInvocationPlan *)plan
                                target:(EDOObject *)target
                              selector:(SEL _Nullable)selector
                         returnByValue:(BOOL)returnByValue
@@ -24,7 +24,9 @@
 #import "Service/Sources/EDOClientService.h"
 #import "Service/Sources/EDOHostService+Private.h"
 #import "Service/Sources/EDOHostService.h"
+#import "Service/Sources/EDOInvocationPlan.h"
 #import "Service/Sources/EDOMessage.h"
+#import "Service/Sources/EDOMethodDispatch.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObject.h"
 #import "Service/Sources/EDOParameter.h"
@@ -54,92 +56,6 @@ static NSString *const kEDOInvocationCoderReturnValueKey = @"returnValue";
 static NSString *const kEDOInvocationCoderOutValuesKey = @"outValues";
 static NSString *const kEDOInvocationCoderExceptionKey = @"exception";
 
-/** The list of method families that should retain the returned object. */
-typedef NS_ENUM(NSUInteger, EDOMethodFamily) {
-  EDOMethodFamilyNone,
-  EDOMethodFamilyAlloc,
-  EDOMethodFamilyCopy,
-  EDOMethodFamilyNew,
-  EDOMethodFamilyMutableCopy,
-};
-
-/** A struct representing an Objective-C method family. */
-typedef struct MethodFamily {
-  /** The method family type. */
-  EDOMethodFamily family;
-  /** The prefix identifying the method family. */
-  const char *prefix;
-  /** The length of the prefix of the method family. */
-  size_t length;
-} MethodFamily;
-
-/** The helper macro to define a @c MethodFamily above. */
-#define METHOD_FAMILY(__family, __str) \
-  ((MethodFamily){.family = (__family), .prefix = (__str), .length = sizeof(__str) - 1})
-
-/** The methods family that should retain the returned object. */
-const MethodFamily kRetainReturnsMethodsFamily[] = {
-    METHOD_FAMILY(EDOMethodFamilyAlloc, "alloc"),
-    METHOD_FAMILY(EDOMethodFamilyCopy, "copy"),
-    METHOD_FAMILY(EDOMethodFamilyNew, "new"),
-    METHOD_FAMILY(EDOMethodFamilyMutableCopy, "mutableCopy"),
-};
-
-/**
- * Gets the family type of the method belonging to the ns_returns_retained family.
- *
- * More info here:
- * https://clang.llvm.org/docs/AutomaticReferenceCounting.html#retained-return-values.
- *
- * @param methodName The method name.
- * @return The method family type.
- */
-static EDOMethodFamily MethodTypeOfRetainsReturn(const char *methodName, Class targetClass) {
-  if (!methodName ||
-      [targetClass isSubclassOfClass:NSClassFromString(@"ComGoogleProtobufGeneratedMessage")]) {
-    return EDOMethodFamilyNone;
-  }
-
-  /**
-   * To find out if a selector is in a certain method family:
-   *
-   * A selector is in a certain selector family if, ignoring any leading underscores, the first
-   * component of the selector either consists entirely of the name of the method family or it
-   * begins with that name followed by a character other than a lowercase letter.
-   * http://clang.llvm.org/docs/AutomaticReferenceCounting.html#method-families
-   */
-
-  // Skip the leading underscore as it is considered to be the same method family.
-  while (*methodName == '_') {
-    ++methodName;
-  }
-
-  // Skip the first component if it begins with a method family that is implicitly annotated with
-  // the ns_returns_retained attribute.
-  BOOL matchesMethodFamily = NO;
-  int familySize = sizeof(kRetainReturnsMethodsFamily) / sizeof(MethodFamily);
-  int methodIdx = 0;
-  for (; methodIdx < familySize; methodIdx++) {
-    MethodFamily family = kRetainReturnsMethodsFamily[methodIdx];
-    if (strncmp(methodName, family.prefix, family.length) == 0) {
-      methodName += family.length;
-      matchesMethodFamily = YES;
-      break;
-    }
-  }
-
-  if (!matchesMethodFamily) {
-    return EDOMethodFamilyNone;
-  }
-
-  // It should end or be followed by a character other than a lowercase letter.
-  if (*methodName == '\0' || !islower(*methodName)) {
-    return kRetainReturnsMethodsFamily[methodIdx].family;
-  } else {
-    return EDOMethodFamilyNone;
-  }
-}
-
 static EDORemoteException *CreateRemoteException(id localException) {
   if (!localException) {
     return nil;
@@ -160,6 +76,8 @@ static EDORemoteException *CreateRemoteException(id localException) {
 @property(nonatomic, readonly) EDOPointerType target;
 /** The selector name. */
 @property(nonatomic, readonly) NSString *selectorName;
+/** The selector of the selector name, which is resolved once it's decoded. */
+@property(nonatomic, readonly, nullable) SEL selector;
 /** The boxed arguments. */
 @property(nonatomic, readonly) NSArray<EDOBoxedValueType *> *arguments;
 /** The flag indicationg return-by-value. */
@@ -180,26 +98,25 @@ static EDORemoteException *CreateRemoteException(id localException) {
                               exception:(EDORemoteException *)exception
                               outValues:(NSArray<EDOBoxedValueType *> *)outValues
                              forRequest:(EDOInvocationRequest *)request
-                            targetClass:(Class)targetClass {
+                           methodFamily:(EDOMethodFamily)methodFamily {
   return [[self alloc] initWithReturnValue:value
                                  exception:exception
                                  outValues:outValues
                                 forRequest:request
-                               targetClass:targetClass];
+                              methodFamily:methodFamily];
 }
 
 - (instancetype)initWithReturnValue:(EDOBoxedValueType *)value
                           exception:(EDORemoteException *)exception
                           outValues:(NSArray<EDOBoxedValueType *> *)outValues
                          forRequest:(EDOInvocationRequest *)request
-                        targetClass:(Class)targetClass {
+                       methodFamily:(EDOMethodFamily)methodFamily {
   self = [super initWithMessageID:request.messageID];
   if (self) {
     _returnValue = value;
     _exception = exception;
     _outValues = outValues;
-    _returnRetained = MethodTypeOfRetainsReturn(request.selectorName.UTF8String, targetClass) !=
-                      EDOMethodFamilyNone;
+    _returnRetained = methodFamily != EDOMethodFamilyNone;
   }
   return self;
 }
@@ -228,8 +145,27 @@ static EDORemoteException *CreateRemoteException(id localException) {
   [aCoder encodeObject:self.outValues forKey:kEDOInvocationCoderOutValuesKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _returnRetained = [decoder decodeBool];
+    _returnValue = [decoder decodeObject];
+    _exception = [decoder decodeObject];
+    _outValues = [decoder decodeArray];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeBool:self.returnRetained];
+  [encoder encodeObject:self.returnValue];
+  [encoder encodeObject:self.exception];
+  [encoder encodeArray:self.outValues];
+}
+
 - (NSString *)description {
-  return [NSString stringWithFormat:@"Invocation response (%@)", self.messageID];
+  return [NSString stringWithFormat:@"Invocation response (%llx)", self.messageID];
 }
 
 @end
@@ -255,13 +191,15 @@ static EDORemoteException *CreateRemoteException(id localException) {
 }
 
 + (instancetype)requestWithInvocation:(NSInvocation *)invocation
+                                 plan:(EDOInvocationPlan *)plan
                                target:(EDOObject *)target
                              selector:(SEL _Nullable)selector
                         returnByValue:(BOOL)returnByValue
                               service:(EDOHostService *)service {
-  NSMethodSignature *signature = invocation.methodSignature;
-  char const *returnType = signature.methodReturnType;
-  if (EDO_IS_POINTER(returnType)) {
+  NSAssert(plan.signature == invocation.methodSignature,
+           @"The plan is not made from the method signature of the invocation.");
+  if (plan.returnKind == EDOInvocationValueKindObjectPointer ||
+      plan.returnKind == EDOInvocationValueKindPointer) {
     NSString *errorMessage =
         [NSString stringWithFormat:
                       @"Failed to make remote invocation to [%@ %@]: the return type is a pointer!",
@@ -270,60 +208,73 @@ static EDORemoteException *CreateRemoteException(id localException) {
                            userInfo:nil] raise];
   }
 
-  NSUInteger numOfArgs = signature.numberOfArguments;
+  NSUInteger numOfArgs = plan.signature.numberOfArguments;
   // If the target is a block, the first argument starts at index 1, whereas for a regular object
   // invocation, the first argument starts at index 2, with the selector being the second argument.
-  NSUInteger firstArgumentIndex = selector ? 2 : 1;
+  NSUInteger firstArgumentIndex = plan.firstArgumentIndex;
+  NSAssert(firstArgumentIndex == (selector ? 2 : 1),
+           @"The plan is not made for the %@ invocation.", selector ? @"object" : @"block");
   NSMutableArray<id> *arguments =
       [[NSMutableArray alloc] initWithCapacity:(numOfArgs - firstArgumentIndex)];
+  // The buffer is shared by all the arguments that are copied by their bytes.
+  void *argBuffer = alloca(MAX(plan.maxArgumentSize, 1));
 
   for (NSUInteger i = firstArgumentIndex; i < numOfArgs; ++i) {
-    char const *ctype = [signature getArgumentTypeAtIndex:i];
+    const EDOInvocationArgumentPlan *argument = [plan argumentAtIndex:i];
     EDOBoxedValueType *value = nil;
 
-    if (EDO_IS_OBJECT_OR_CLASS(ctype)) {
-      id __unsafe_unretained obj;
-      [invocation getArgument:&obj atIndex:i];
-      value = BOX_VALUE(obj, target, service, nil);
-    } else if (EDO_IS_OBJPOINTER(ctype)) {
-      id __unsafe_unretained *objRef;
-      [invocation getArgument:&objRef atIndex:i];
-
-      // Convert and pass the value as an object and decode it on remote side.
-      value = objRef ? BOX_VALUE(*objRef, target, service, nil)
-                     : [EDOBoxedValueType parameterForDoublePointerNullValue];
-    } else if (EDO_IS_POINTER(ctype)) {
-      void *objRef;
-      [invocation getArgument:&objRef atIndex:i];
-
-      // Don't assert if the pointer is NULL.  The purpose for disallowing non-Objective-C pointer
-      // parameters is because there's no way to know how big a C pointer's underlying data is.  But
-      // if the pointer is NULL, then there's nothing to pass, so just pass NULL and don't throw an
-      // exception.  This opens up partial support for key-value observing and other APIs that take
-      // optional context pointers (so long as the caller doesn't provide one).
-      if (objRef != NULL) {
-        NSString *errorMessage =
-            [NSString stringWithFormat:
-                          @"Failed to make remote invocation to [%@ %@]: the %@%@ parameter is a "
-                          @"non-nil C pointer!",
-                          target.className, selector ? NSStringFromSelector(selector) : @"(block)",
-                          @(i - firstArgumentIndex + 1),
-                          i == firstArgumentIndex       ? @"st"
-                          : i == firstArgumentIndex + 1 ? @"nd"
-                          : i == firstArgumentIndex + 2 ? @"rd"
-                                                        : @"th"];
-        [[NSException exceptionWithName:EDOTypeEncodingException reason:errorMessage
-                               userInfo:nil] raise];
+    switch (argument->kind) {
+      case EDOInvocationValueKindObject: {
+        id __unsafe_unretained obj;
+        [invocation getArgument:&obj atIndex:i];
+        value = BOX_VALUE(obj, target, service, nil);
+        break;
+      }
+      case EDOInvocationValueKindObjectPointer: {
+        id __unsafe_unretained *objRef;
+        [invocation getArgument:&objRef atIndex:i];
+
+        // Convert and pass the value as an object and decode it on remote side.
+        value = objRef ? BOX_VALUE(*objRef, target, service, nil)
+                       : [EDOBoxedValueType parameterForDoublePointerNullValue];
+        break;
+      }
+      case EDOInvocationValueKindPointer: {
+        void *objRef;
+        [invocation getArgument:&objRef atIndex:i];
+
+        // Don't assert if the pointer is NULL.  The purpose for disallowing non-Objective-C pointer
+        // parameters is because there's no way to know how big a C pointer's underlying data is.
+        // But if the pointer is NULL, then there's nothing to pass, so just pass NULL and don't
+        // throw an exception.  This opens up partial support for key-value observing and other
+        // APIs that take optional context pointers (so long as the caller doesn't provide one).
+        if (objRef != NULL) {
+          NSString *errorMessage = [NSString
+              stringWithFormat:
+                  @"Failed to make remote invocation to [%@ %@]: the %@%@ parameter is a "
+                  @"non-nil C pointer!",
+                  target.className, selector ? NSStringFromSelector(selector) : @"(block)",
+                  @(i - firstArgumentIndex + 1),
+                  i == firstArgumentIndex       ? @"st"
+                  : i == firstArgumentIndex + 1 ? @"nd"
+                  : i == firstArgumentIndex + 2 ? @"rd"
+                                                : @"th"];
+          [[NSException exceptionWithName:EDOTypeEncodingException reason:errorMessage
+                                 userInfo:nil] raise];
+        }
+        value = [EDOBoxedValueType parameterForNilValue];
+        break;
+      }
+      default: {
+        [invocation getArgument:argBuffer atIndex:i];
+
+        // save struct or other POD to NSValue
+        value = [EDOBoxedValueType parameterWithBytes:argBuffer
+                                             objCType:argument->objCType
+                                                 size:argument->size
+                                         typeEncoding:argument->typeEncoding];
+        break;
       }
-      value = [EDOBoxedValueType parameterForNilValue];
-    } else {
-      NSUInteger typeSize = 0L;
-      NSGetSizeAndAlignment(ctype, &typeSize, NULL);
-      void *argBuffer = alloca(typeSize);
-      [invocation getArgument:argBuffer atIndex:i];
-
-      // save struct or other POD to NSValue
-      value = [EDOBoxedValueType parameterWithBytes:argBuffer objCType:ctype];
     }
     [arguments addObject:value];
   }
@@ -342,17 +293,32 @@ static EDORemoteException *CreateRemoteException(id localException) {
              @"EDOInvocationRequest is expected.");
     EDOHostPort *hostPort = request.hostPort;
     id target = (__bridge id)(void *)request.target;
-    SEL sel = NSSelectorFromString(request.selectorName);
+    SEL sel = request.selector;
 
     EDOBoxedValueType *returnValue;
     NSException *invocationException;
+    EDOMethodFamily family = EDOMethodFamilyNone;
     NSMutableArray<EDOBoxedValueType *> *outValues = [[NSMutableArray alloc] init];
 
     @try {
+      // The method that the target class implements is resolved once for the class, and the
+      // forwarded method or the block is looked up for every invocation.
+      EDOMethodDispatch *dispatch =
+          sel ? [EDOMethodDispatch dispatchForTarget:target selector:sel] : nil;
       // TODO(haowoo): Throw non-existing method exception.
-      NSMethodSignature *methodSignature = EDOGetMethodSignature(target, sel);
-      NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:methodSignature];
-      invocation.target = target;
+      NSMethodSignature *methodSignature =
+          dispatch ? dispatch.signature : EDOGetMethodSignature(target, sel);
+      family = dispatch ? dispatch.methodFamily
+                        : EDOGetMethodFamily(request.selectorName.UTF8String, [target class]);
+
+      // The common methods are called directly with the arguments in words, and the others are
+      // invoked by the NSInvocation.
+      NSInvocation *invocation;
+      uintptr_t argumentWords[kEDOMethodDispatchMaxArguments];
+      if (!dispatch.invokesDirectly) {
+        invocation = [NSInvocation invocationWithMethodSignature:methodSignature];
+        invocation.target = target;
+      }
 
       NSUInteger numOfArgs = methodSignature.numberOfArguments;
       NSUInteger firstArgumentIndex = sel ? 2 : 1;
@@ -400,7 +366,11 @@ static EDORemoteException *CreateRemoteException(id localException) {
             *objRef = [EDOClientService unwrappedObjectFromObject:*objRef];
             *objRef = [EDOClientService cachedEDOFromObjectUpdateIfNeeded:*objRef];
           }
-          [invocation setArgument:&objRef atIndex:curArgIdx];
+          if (invocation) {
+            [invocation setArgument:&objRef atIndex:curArgIdx];
+          } else {
+            argumentWords[curArgIdx - firstArgumentIndex] = (uintptr_t)objRef;
+          }
         } else if (EDO_IS_OBJECT_OR_CLASS(ctype)) {
           id __unsafe_unretained obj;
           [argument getValue:&obj];
@@ -412,7 +382,25 @@ static EDORemoteException *CreateRemoteException(id localException) {
             [service addWeakObject:obj];
           }
 
-          [invocation setArgument:&obj atIndex:curArgIdx];
+          if (invocation) {
+            [invocation setArgument:&obj atIndex:curArgIdx];
+          } else {
+            argumentWords[curArgIdx - firstArgumentIndex] = (uintptr_t)(__bridge void *)obj;
+          }
+        } else if (!invocation) {
+          // The value is copied into a word, so a value of another type from the client whose
+          // signature doesn't match must not be copied even if the assertion is compiled out.
+          if (strcmp(ctype, argument.objCType) != 0) {
+            NSString *reason = [NSString
+                stringWithFormat:@"The argument type is not matched (%s : %s) for the method %@.",
+                                 ctype, argument.objCType, request.selectorName];
+            [[NSException exceptionWithName:EDOTypeEncodingException reason:reason
+                                   userInfo:nil] raise];
+          }
+          uintptr_t word = 0;
+          [argument getValue:&word];
+          argumentWords[curArgIdx - firstArgumentIndex] = [EDOMethodDispatch wordWithBytes:&word
+                                                                                  objCType:ctype];
         } else {
           NSUInteger valueSize = 0;
           NSGetSizeAndAlignment(argument.objCType, &valueSize, NULL);
@@ -422,16 +410,23 @@ static EDORemoteException *CreateRemoteException(id localException) {
         }
       }
 
-      [invocation invoke];
+      uintptr_t returnWord = 0;
+      if (invocation) {
+        [invocation invoke];
+      } else {
+        returnWord = [dispatch invokeWithTarget:target arguments:argumentWords];
+      }
 
       NSUInteger length = methodSignature.methodReturnLength;
       if (length > 0) {
         char const *returnType = methodSignature.methodReturnType;
         if (EDO_IS_OBJECT_OR_CLASS(returnType)) {
           id __unsafe_unretained obj;
-          [invocation getReturnValue:&obj];
-          EDOMethodFamily family =
-              MethodTypeOfRetainsReturn(request.selectorName.UTF8String, [target class]);
+          if (invocation) {
+            [invocation getReturnValue:&obj];
+          } else {
+            obj = (__bridge id)(void *)returnWord;
+          }
           if (family == EDOMethodFamilyAlloc &&
               (request.returnByValue || [obj edo_isEDOValueType])) {
             // We cannot serialize and deserialize the result from +alloc as it is not properly
@@ -468,7 +463,12 @@ static EDORemoteException *CreateRemoteException(id localException) {
           NSAssert(NO, @"Doesn't support pointer returns and it should be caught at client.");
         } else {
           void *returnBuf = alloca(length);
-          [invocation getReturnValue:returnBuf];
+          if (invocation) {
+            [invocation getReturnValue:returnBuf];
+          } else {
+            // The integers are returned in the low bytes of the word.
+            memcpy(returnBuf, &returnWord, length);
+          }
 
           // Save any c-struct/POD into the NSValue.
           returnValue = [EDOBoxedValueType parameterWithBytes:returnBuf
@@ -493,7 +493,7 @@ static EDORemoteException *CreateRemoteException(id localException) {
                                                 exception:CreateRemoteException(invocationException)
                                                 outValues:(outValues.count > 0 ? outValues : nil)
                                                forRequest:request
-                                              targetClass:[target class]];
+                                             methodFamily:family];
   };
 }
 
@@ -505,6 +505,7 @@ static EDORemoteException *CreateRemoteException(id localException) {
   self = [super init];
   if (self) {
     _target = target;
+    _selector = selector;
     _selectorName = selector ? NSStringFromSelector(selector) : nil;
     _arguments = [arguments copy];
     _hostPort = hostPort;
@@ -521,6 +522,7 @@ static EDORemoteException *CreateRemoteException(id localException) {
     _target = [aDecoder decodeInt64ForKey:kEDOInvocationCoderTargetKey];
     _selectorName = [aDecoder decodeObjectOfClass:[NSString class]
                                            forKey:kEDOInvocationCoderSelectorNameKey];
+    _selector = _selectorName ? NSSelectorFromString(_selectorName) : NULL;
     _arguments = [aDecoder decodeObjectOfClasses:anyClasses forKey:kEDOInvocationCoderArgumentsKey];
     _hostPort = [aDecoder decodeObjectOfClass:[EDOHostPort class]
                                        forKey:kEDOInvocationCoderHostPortKey];
@@ -538,9 +540,31 @@ static EDORemoteException *CreateRemoteException(id localException) {
   [aCoder encodeBool:self.returnByValue forKey:kEDOInvocationReturnByValueKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _target = [decoder decodeInt64];
+    _selectorName = [decoder decodeInternedSelectorName:&_selector];
+    _arguments = [decoder decodeArray];
+    _hostPort = [decoder decodeObject];
+    _returnByValue = [decoder decodeBool];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeInt64:self.target];
+  [encoder encodeInternedString:self.selectorName];
+  [encoder encodeArray:self.arguments];
+  [encoder encodeObject:self.hostPort];
+  [encoder encodeBool:self.returnByValue];
+}
+
 - (NSString *)description {
-  return [NSString stringWithFormat:@"Invocation request (%@) on target (%llx) with selector (%@)",
-                                    self.messageID, self.target, self.selectorName];
+  return [NSString
+      stringWithFormat:@"Invocation request (%llx) on target (%llx) with selector (%@)",
+                       self.messageID, self.target, self.selectorName];
 }
 
 @end
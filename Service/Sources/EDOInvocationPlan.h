@@ -0,0 +1,93 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** The kind of an argument or the return value, which decides how it is sent to the remote. */
+typedef NS_ENUM(uint8_t, EDOInvocationValueKind) {
+  /** No value, which is only the return of a void method. */
+  EDOInvocationValueKindVoid = 0,
+  /** An object or a class, which is boxed by value or by reference. */
+  EDOInvocationValueKindObject,
+  /** A pointer to an object, which is sent as the object it points to and filled back after. */
+  EDOInvocationValueKindObjectPointer,
+  /** A C pointer, which can only be sent if it is NULL. */
+  EDOInvocationValueKindPointer,
+  /** Any other value, which is copied by its bytes. */
+  EDOInvocationValueKindBytes,
+};
+
+/** The type information of an argument, which is parsed once for its method signature. */
+typedef struct EDOInvocationArgumentPlan {
+  /** The kind of the argument. */
+  EDOInvocationValueKind kind;
+  /** The type encoding of the argument, which is owned by the method signature. */
+  const char *objCType;
+  /** The type encoding as a string, which is shared by the parameters of the argument. */
+  __unsafe_unretained NSString *typeEncoding;
+  /** The size of the argument. */
+  NSUInteger size;
+} EDOInvocationArgumentPlan;
+
+/**
+ * The plan to forward the invocations of a method signature.
+ *
+ * The kinds and the sizes of the arguments and the return value are parsed from the method
+ * signature once, so the invocations only copy the argument values when they are forwarded. The
+ * plan is immutable and can be shared by the invocations on any thread.
+ */
+@interface EDOInvocationPlan : NSObject
+
+/** The method signature that the plan is made from. */
+@property(readonly, nonatomic) NSMethodSignature *signature;
+/** The index of the first argument, which is 1 for a block and 2 for a method. */
+@property(readonly, nonatomic) NSUInteger firstArgumentIndex;
+/** The largest size of the arguments copied by their bytes. */
+@property(readonly, nonatomic) NSUInteger maxArgumentSize;
+/** The number of the arguments that point to an object. */
+@property(readonly, nonatomic) NSUInteger numberOfObjectPointerArguments;
+/** The kind of the return value. */
+@property(readonly, nonatomic) EDOInvocationValueKind returnKind;
+/** The size of the return value. */
+@property(readonly, nonatomic) NSUInteger returnSize;
+
+/**
+ * Creates the plan for the method signature.
+ *
+ * @param signature          The method signature.
+ * @param firstArgumentIndex The index of the first argument in the signature.
+ *
+ * @return The plan of the signature.
+ */
++ (instancetype)planWithMethodSignature:(NSMethodSignature *)signature
+                     firstArgumentIndex:(NSUInteger)firstArgumentIndex;
+
+/**
+ * Gets the plan of the argument.
+ *
+ * @param index The index of the argument in the signature, from @c firstArgumentIndex.
+ *
+ * @return The plan of the argument, which lives as long as the invocation plan.
+ */
+- (const EDOInvocationArgumentPlan *)argumentAtIndex:(NSUInteger)index;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,89 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOInvocationPlan.h"
+
+#import "Service/Sources/EDOParameter.h"
+
+/** Gets the kind of the value of the @c objCType. */
+static EDOInvocationValueKind EDOGetInvocationValueKind(const char *objCType) {
+  if (EDO_IS_OBJECT_OR_CLASS(objCType)) {
+    return EDOInvocationValueKindObject;
+  } else if (EDO_IS_OBJPOINTER(objCType)) {
+    return EDOInvocationValueKindObjectPointer;
+  } else if (EDO_IS_POINTER(objCType)) {
+    return EDOInvocationValueKindPointer;
+  }
+  return EDOInvocationValueKindBytes;
+}
+
+@implementation EDOInvocationPlan {
+  // The plans of the arguments from the first argument, in the order of the signature.
+  EDOInvocationArgumentPlan *_arguments;
+  // The type encodings that the argument plans refer to.
+  NSArray<NSString *> *_typeEncodings;
+}
+
++ (instancetype)planWithMethodSignature:(NSMethodSignature *)signature
+                     firstArgumentIndex:(NSUInteger)firstArgumentIndex {
+  return [[self alloc] initWithMethodSignature:signature firstArgumentIndex:firstArgumentIndex];
+}
+
+- (instancetype)initWithMethodSignature:(NSMethodSignature *)signature
+                     firstArgumentIndex:(NSUInteger)firstArgumentIndex {
+  self = [super init];
+  if (self) {
+    _signature = signature;
+    _firstArgumentIndex = firstArgumentIndex;
+
+    NSUInteger numOfArgs = signature.numberOfArguments;
+    NSUInteger count = numOfArgs > firstArgumentIndex ? numOfArgs - firstArgumentIndex : 0;
+    NSMutableArray<NSString *> *typeEncodings = [[NSMutableArray alloc] initWithCapacity:count];
+    _arguments = calloc(MAX(count, 1), sizeof(EDOInvocationArgumentPlan));
+    for (NSUInteger i = 0; i < count; ++i) {
+      EDOInvocationArgumentPlan *argument = &_arguments[i];
+      argument->objCType = [signature getArgumentTypeAtIndex:firstArgumentIndex + i];
+      argument->kind = EDOGetInvocationValueKind(argument->objCType);
+      if (argument->kind == EDOInvocationValueKindObjectPointer) {
+        ++_numberOfObjectPointerArguments;
+      } else if (argument->kind == EDOInvocationValueKindBytes) {
+        NSGetSizeAndAlignment(argument->objCType, &argument->size, NULL);
+        _maxArgumentSize = MAX(_maxArgumentSize, argument->size);
+      }
+      [typeEncodings addObject:@(argument->objCType)];
+      argument->typeEncoding = typeEncodings.lastObject;
+    }
+    _typeEncodings = typeEncodings;
+
+    _returnSize = signature.methodReturnLength;
+    const char *returnType = signature.methodReturnType;
+    _returnKind = returnType[0] == _C_VOID ? EDOInvocationValueKindVoid
+                                           : EDOGetInvocationValueKind(returnType);
+  }
+  return self;
+}
+
+- (void)dealloc {
+  free(_arguments);
+}
+
+- (const EDOInvocationArgumentPlan *)argumentAtIndex:(NSUInteger)index {
+  NSAssert(index >= _firstArgumentIndex && index < _signature.numberOfArguments,
+           @"The argument index %lu is out of the range of the signature.", (unsigned long)index);
+  return &_arguments[index - _firstArgumentIndex];
+}
+
+@end
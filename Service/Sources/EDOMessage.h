@@ -16,32 +16,50 @@
 
 #import <Foundation/Foundation.h>
 
+#import "Service/Sources/EDOMessageCoder.h"
+
 NS_ASSUME_NONNULL_BEGIN
 
-/** The type for the message ID. */
-typedef NSString EDOMessageID;
+/**
+ * The type for the message ID.
+ *
+ * The upper 16 bits are the epoch of the process that creates the message, which is picked at
+ * random when the process starts, and the lower 48 bits are the sequence number of the message in
+ * the process.
+ */
+typedef uint64_t EDOMessageID;
 
 /** The base class for the message to be transferred within a single service. */
-@interface EDOMessage : NSObject <NSSecureCoding>
+@interface EDOMessage : NSObject <EDOMessageCoding, NSSecureCoding>
 
 /** The unique message identifier to track the request and response. */
-@property(nonatomic, readonly) EDOMessageID *messageID;
+@property(nonatomic, readonly) EDOMessageID messageID;
 
-/** Init with a random UUID message Id. */
+/**
+ * The message identifier in the keyed archive from the older clients, which is a UUID string.
+ *
+ * The keyed archive has the identifier in a string, and the older clients match the response by
+ * the string of its request, so the response of their request carries it back.
+ */
+@property(nonatomic, copy, nullable) NSString *legacyMessageID;
+
+/** Init with the next message Id of the process. */
 - (instancetype)init;
 
 /** @see -[NSCoding initWithCoder:]. */
 - (instancetype)initWithCoder:(NSCoder *)aDecoder NS_DESIGNATED_INITIALIZER;
 
+/** @see -[EDOMessageCoding initWithMessageDecoder:]. */
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder NS_DESIGNATED_INITIALIZER;
+
 /**
  * Init with a given message identifier.
  *
  * @param messageID The message identifier.
- * @remark The message Id is a unique identifier to track, it is usually generated via UUID
- *         generator. For instance, the message Id will be the same if the response is for a
- *         request.
+ * @remark The message Id is a unique identifier to track, it is usually generated by @c -init.
+ *         For instance, the message Id will be the same if the response is for a request.
  */
-- (instancetype)initWithMessageID:(NSString *)messageID NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithMessageID:(EDOMessageID)messageID NS_DESIGNATED_INITIALIZER;
 
 @end
 
@@ -16,6 +16,25 @@
 
 #import "Service/Sources/EDOMessage.h"
 
+#include <stdatomic.h>
+
+/** The number of bits of the sequence number in the message ID. */
+static const int kEDOMessageIDSequenceBits = 48;
+
+/** The sequence number of the last message ID created by the process. */
+static _Atomic(uint64_t) gEDOMessageIDSequence = 0;
+
+/** Creates the next message ID of the process. */
+static EDOMessageID EDONextMessageID(void) {
+  static EDOMessageID epoch;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    epoch = (EDOMessageID)arc4random_uniform(1 << 16) << kEDOMessageIDSequenceBits;
+  });
+  uint64_t sequence = atomic_fetch_add(&gEDOMessageIDSequence, 1);
+  return epoch | ((sequence + 1) & ((1ULL << kEDOMessageIDSequenceBits) - 1));
+}
+
 static NSString *const kEDOEDOMessageCoderMessageIDKey = @"messageID";
 
 @implementation EDOMessage
@@ -25,10 +44,10 @@ static NSString *const kEDOEDOMessageCoderMessageIDKey = @"messageID";
 }
 
 - (instancetype)init {
-  return [self initWithMessageID:[NSUUID UUID].UUIDString];
+  return [self initWithMessageID:EDONextMessageID()];
 }
 
-- (instancetype)initWithMessageID:(NSString *)messageID {
+- (instancetype)initWithMessageID:(EDOMessageID)messageID {
   self = [super init];
   if (self) {
     _messageID = messageID;
@@ -39,14 +58,37 @@ static NSString *const kEDOEDOMessageCoderMessageIDKey = @"messageID";
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
   self = [super init];
   if (self) {
-    _messageID = [aDecoder decodeObjectOfClass:[NSString class]
-                                        forKey:kEDOEDOMessageCoderMessageIDKey];
+    // The keyed archive keeps the string identifier for the older peers. The identifier is in
+    // decimal unless it's a UUID from an older client, which is kept to send back as it is.
+    NSString *messageID = [aDecoder decodeObjectOfClass:[NSString class]
+                                                 forKey:kEDOEDOMessageCoderMessageIDKey];
+    NSScanner *scanner = messageID ? [NSScanner scannerWithString:messageID] : nil;
+    unsigned long long value = 0;
+    if ([scanner scanUnsignedLongLong:&value] && scanner.isAtEnd) {
+      _messageID = (EDOMessageID)value;
+    } else {
+      _messageID = (EDOMessageID)messageID.hash;
+      _legacyMessageID = [messageID copy];
+    }
   }
   return self;
 }
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
-  [aCoder encodeObject:self.messageID forKey:kEDOEDOMessageCoderMessageIDKey];
+  NSString *messageID = self.legacyMessageID ?: [NSString stringWithFormat:@"%llu", self.messageID];
+  [aCoder encodeObject:messageID forKey:kEDOEDOMessageCoderMessageIDKey];
+}
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super init];
+  if (self) {
+    _messageID = (EDOMessageID)[decoder decodeInt64];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [encoder encodeInt64:(int64_t)self.messageID];
 }
 
 @end
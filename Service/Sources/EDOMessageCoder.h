@@ -0,0 +1,186 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOMessage;
+@class EDOMessageDecoder;
+
+/**
+ * The table of the values interned on a connection.
+ *
+ * The values that repeat in every message, such as the selectors, the class names and the service
+ * ports, are sent in full along with the first message that has them, and they are referenced by
+ * their indexes in the table afterwards. Each end of a connection keeps one table for the messages
+ * it sends and another for the messages it receives, and the messages must be decoded in the same
+ * order as they are encoded.
+ */
+@interface EDOMessageInternTable : NSObject
+@end
+
+/** The writer of the binary coding of the messages. */
+@interface EDOMessageEncoder : NSObject
+
+/** Encodes a boolean value in a byte. */
+- (void)encodeBool:(BOOL)value;
+
+/** Encodes a 64-bit integer in 8 bytes. */
+- (void)encodeInt64:(int64_t)value;
+
+/** Encodes a double value in 8 bytes. */
+- (void)encodeDouble:(double)value;
+
+/** Encodes the bytes of a fixed length, which the decoder must know to decode them. */
+- (void)encodeBytes:(const void *)bytes length:(size_t)length;
+
+/** Encodes a string in UTF-8 with its length. */
+- (void)encodeString:(nullable NSString *)string;
+
+/** Encodes a string by its index in the intern table, adding it to the table if it's new. */
+- (void)encodeInternedString:(nullable NSString *)string;
+
+/**
+ * Encodes an object of a registered class by its index in the intern table, adding it to the table
+ * if it's new.
+ *
+ * The object is looked up by its identity, so it should be an immutable value shared by many
+ * messages, such as a service port. The decoder resolves all the references to the same instance.
+ */
+- (void)encodeInternedObject:(nullable id)object;
+
+/**
+ * Encodes an object of any type.
+ *
+ * The objects of the message classes, the strings, the data, and the arrays of them are encoded in
+ * the binary coding, and the other objects are archived by @c NSKeyedArchiver.
+ */
+- (void)encodeObject:(nullable id)object;
+
+/** Encodes an array with each of its elements encoded by @c -encodeObject:. */
+- (void)encodeArray:(nullable NSArray *)array;
+
+@end
+
+/**
+ * The reader of the binary coding of the messages.
+ *
+ * The values are decoded in the same order as they are encoded. An @c
+ * NSInvalidUnarchiveOperationException is raised if the data is malformed.
+ */
+@interface EDOMessageDecoder : NSObject
+
+- (BOOL)decodeBool;
+- (int64_t)decodeInt64;
+- (double)decodeDouble;
+- (const void *)decodeBytesWithLength:(size_t)length NS_RETURNS_INNER_POINTER;
+- (nullable NSString *)decodeString;
+- (nullable NSString *)decodeInternedString;
+
+/**
+ * Decodes a selector name encoded by @c -encodeInternedString:.
+ *
+ * @param selector The selector of the name, which is only registered once per table entry.
+ *
+ * @return The selector name.
+ */
+- (nullable NSString *)decodeInternedSelectorName:(SEL _Nullable *_Nonnull)selector;
+
+/** Decodes an object encoded by @c -encodeInternedObject:. */
+- (nullable id)decodeInternedObject;
+- (nullable id)decodeObject;
+- (nullable NSArray *)decodeArray;
+
+@end
+
+/**
+ * The object that encodes its own fields in the binary coding of the messages.
+ *
+ * Only the classes registered in @c EDOMessageCoder are encoded this way, and their subclasses are
+ * archived by @c NSKeyedArchiver unless they are registered too.
+ */
+@protocol EDOMessageCoding <NSObject>
+
+/** Encodes the fields of the object in order. */
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder;
+
+/** Initializes the object by decoding its fields in the order they are encoded. */
+- (nullable instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder;
+
+@end
+
+/**
+ * The coder of the messages sent between the client and the host services.
+ *
+ * The messages were archived by @c NSKeyedArchiver, which encodes every field with its key and
+ * every object with its class name. The binary coding instead writes the fields of the message
+ * classes in a fixed order, and the classes by their indexes in a fixed table, so only the user
+ * objects sent by value are still archived by @c NSKeyedArchiver.
+ *
+ * The binary-coded data starts with a magic prefix, which the keyed archive never starts with, so
+ * both codings are decoded by @c +messageWithData:. The host replies in the coding of the request,
+ * and the client only sends the binary coding to the host that advertises it can decode it.
+ */
+@interface EDOMessageCoder : NSObject
+
+/**
+ * Encodes the message.
+ *
+ * @param message      The message to encode.
+ * @param binaryCoding Whether to use the binary coding instead of @c NSKeyedArchiver.
+ *
+ * @return The encoded data.
+ */
++ (NSData *)dataWithMessage:(EDOMessage *)message binaryCoding:(BOOL)binaryCoding;
+
+/**
+ * Encodes the message to send on a connection.
+ *
+ * @param message      The message to encode.
+ * @param binaryCoding Whether to use the binary coding instead of @c NSKeyedArchiver.
+ * @param internTable  The table of the values interned for the messages sent on the connection,
+ *                     which is only used by the binary coding.
+ *
+ * @return The encoded data.
+ */
++ (NSData *)dataWithMessage:(EDOMessage *)message
+               binaryCoding:(BOOL)binaryCoding
+                internTable:(nullable EDOMessageInternTable *)internTable;
+
+/** Decodes the message from the data in either coding. */
++ (nullable __kindof EDOMessage *)messageWithData:(NSData *)data;
+
+/**
+ * Decodes the message received on a connection.
+ *
+ * @param data        The data in either coding.
+ * @param internTable The table of the values interned for the messages received on the
+ *                    connection, which is only used by the binary coding.
+ *
+ * @return The decoded message.
+ */
++ (nullable __kindof EDOMessage *)messageWithData:(NSData *)data
+                                      internTable:(nullable EDOMessageInternTable *)internTable;
+
+/** Whether the data is encoded in the binary coding. */
++ (BOOL)isBinaryCodedData:(NSData *)data;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,739 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOMessageCoder.h"
+
+#include <objc/runtime.h>
+
+#import "Channel/Sources/EDOHostPort.h"
+#import "Service/Sources/EDOBatchInvocationMessage.h"
+#import "Service/Sources/EDOClassMessage.h"
+#import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOMessage.h"
+#import "Service/Sources/EDOMethodSignatureMessage.h"
+#import "Service/Sources/EDOObject.h"
+#import "Service/Sources/EDOObjectAliveMessage.h"
+#import "Service/Sources/EDOObjectMessage.h"
+#import "Service/Sources/EDOObjectReleaseMessage.h"
+#import "Service/Sources/EDOParameter.h"
+#import "Service/Sources/EDOServicePort.h"
+#import "Service/Sources/EDOServiceRequest.h"
+#import "Service/Sources/NSKeyedArchiver+EDOAdditions.h"
+#import "Service/Sources/NSKeyedUnarchiver+EDOAdditions.h"
+
+/** The prefix of the binary-coded data, which a binary property list never starts with. */
+static const uint8_t kEDOMessageCoderMagic[] = {0xED, 0x0B, 'E', 1};
+
+/** The type of an object encoded by @c -[EDOMessageEncoder encodeObject:]. */
+typedef NS_ENUM(uint8_t, EDOMessageValueType) {
+  /** The nil object. */
+  EDOMessageValueTypeNil = 0,
+  /** The string in UTF-8. */
+  EDOMessageValueTypeString = 1,
+  /** The bytes of the data. */
+  EDOMessageValueTypeData = 2,
+  /** The object of a registered class, followed by the index of the class and its fields. */
+  EDOMessageValueTypeMessageCoding = 3,
+  /** The object archived by NSKeyedArchiver. */
+  EDOMessageValueTypeKeyedArchive = 4,
+  /** The immutable array, followed by its elements that are encoded in the binary coding. */
+  EDOMessageValueTypeArray = 5,
+};
+
+/**
+ * The classes that are encoded in the binary coding.
+ *
+ * The class is encoded by its index in the table, so the new classes must be appended to the end.
+ */
+static NSArray<Class> *EDOMessageCodingClasses(void) {
+  static NSArray<Class> *classes;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    classes = @[
+      [EDOServiceResponse class],
+      [EDOErrorResponse class],
+      [EDOInvocationRequest class],
+      [EDOInvocationResponse class],
+      [EDOMethodSignatureRequest class],
+      [EDOMethodSignatureResponse class],
+      [EDOObjectRequest class],
+      [EDOObjectResponse class],
+      [EDOClassRequest class],
+      [EDOClassResponse class],
+      [EDOObjectReleaseRequest class],
+      [EDOObjectAliveRequest class],
+      [EDOObjectAliveResponse class],
+      [EDOParameter class],
+      [EDOServicePort class],
+      [EDOHostPort class],
+      [EDOObject class],
+      [EDOBatchInvocationRequest class],
+      [EDOBatchInvocationResponse class],
+    ];
+  });
+  return classes;
+}
+
+/**
+ * The maximum number of the values interned on a connection.
+ *
+ * The values beyond it are encoded in place, so the peer that sends many distinct values doesn't
+ * grow the tables without bound.
+ */
+static const NSUInteger kEDOMessageInternTableCapacity = 4096;
+
+/** The reference to an interned nil value. */
+static const size_t kEDOInternedValueNil = 0;
+/** The reference to a value that is encoded in place, not interned. */
+static const size_t kEDOInternedValueInPlace = 1;
+/** The reference to the first value in the intern table; the other indexes follow it. */
+static const size_t kEDOInternedValueFirstIndex = 2;
+
+/** Raises the exception for the malformed data. */
+static void EDORaiseMalformedDataException(NSString *reason) {
+  [[NSException exceptionWithName:NSInvalidUnarchiveOperationException
+                           reason:[@"The binary-coded message is malformed: "
+                                      stringByAppendingString:reason]
+                         userInfo:nil] raise];
+}
+
+/**
+ * Returns how the @c object is encoded by @c -[EDOMessageEncoder encodeObject:].
+ *
+ * @param object     The object to encode.
+ * @param allowArray Whether the array is encoded in the binary coding. The arrays are only encoded
+ *                   this way at the top level, and only if all their elements are.
+ */
+static EDOMessageValueType EDOGetMessageValueType(id object, BOOL allowArray) {
+  if (!object) {
+    return EDOMessageValueTypeNil;
+  }
+  // The class is checked without messaging the object, which may be a proxy of a remote object.
+  Class objectClass = object_getClass(object);
+  if ([EDOMessageCodingClasses() indexOfObjectIdenticalTo:objectClass] != NSNotFound) {
+    return EDOMessageValueTypeMessageCoding;
+  }
+  // The mutable collections are archived so they are decoded as mutable.
+  if ([objectClass isSubclassOfClass:[NSString class]] &&
+      [object classForCoder] == [NSString class]) {
+    return EDOMessageValueTypeString;
+  }
+  if ([objectClass isSubclassOfClass:[NSData class]] && [object classForCoder] == [NSData class]) {
+    return EDOMessageValueTypeData;
+  }
+  if (allowArray && [objectClass isSubclassOfClass:[NSArray class]] &&
+      [object classForCoder] == [NSArray class]) {
+    for (id element in (NSArray *)object) {
+      if (EDOGetMessageValueType(element, NO) == EDOMessageValueTypeKeyedArchive) {
+        return EDOMessageValueTypeKeyedArchive;
+      }
+    }
+    return EDOMessageValueTypeArray;
+  }
+  return EDOMessageValueTypeKeyedArchive;
+}
+
+@interface EDOMessageInternTable ()
+/** The number of the interned values. */
+@property(readonly, nonatomic) NSUInteger edo_count;
+/** Returns the index of the @c string, or @c NSNotFound if it isn't interned. */
+- (NSUInteger)edo_indexOfString:(NSString *)string;
+/** Returns the index of the @c object by its identity, or @c NSNotFound if it isn't interned. */
+- (NSUInteger)edo_indexOfObject:(id)object;
+/** Returns the value at the @c index. */
+- (id)edo_valueAtIndex:(NSUInteger)index;
+/** Returns the selector of the string at the @c index. */
+- (SEL)edo_selectorAtIndex:(NSUInteger)index;
+/** Interns the @c string, which must not be interned yet. */
+- (void)edo_addString:(NSString *)string;
+/** Interns the @c object by its identity, which must not be interned yet. */
+- (void)edo_addObject:(id)object;
+/** Removes the values after the first @c count values. */
+- (void)edo_truncateToCount:(NSUInteger)count;
+@end
+
+@interface EDOMessageEncoder ()
+/** The encoded bytes. */
+@property(readonly, nonatomic) NSData *edo_data;
+/**
+ * Initializes the encoder to intern the values in the @c internTable, or to encode them in place
+ * if it is nil.
+ */
+- (instancetype)initWithInternTable:(nullable EDOMessageInternTable *)internTable;
+/** Encodes a length in the variable-length quantity of 7 bits per byte. */
+- (void)edo_encodeLength:(size_t)length;
+@end
+
+@interface EDOMessageDecoder ()
+/**
+ * Initializes the decoder to decode the data from the @c offset, and to look up the interned
+ * values in the @c internTable.
+ */
+- (instancetype)initWithData:(NSData *)data
+                      offset:(size_t)offset
+                 internTable:(EDOMessageInternTable *)internTable;
+/** Decodes a length encoded by -[EDOMessageEncoder edo_encodeLength:]. */
+- (size_t)edo_decodeLength;
+@end
+
+#pragma mark - Intern Table
+
+@implementation EDOMessageInternTable {
+  // The interned values by their indexes.
+  NSMutableArray *_values;
+  // The indexes of the interned strings.
+  NSMutableDictionary<NSString *, NSNumber *> *_stringIndexes;
+  // The indexes of the interned objects, which are looked up by their identities.
+  NSMapTable<id, NSNumber *> *_objectIndexes;
+  // The selectors of the interned strings, which are registered on the first lookup.
+  NSPointerArray *_selectors;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _values = [[NSMutableArray alloc] init];
+    _stringIndexes = [[NSMutableDictionary alloc] init];
+    NSPointerFunctionsOptions keyOptions =
+        NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality;
+    _objectIndexes = [[NSMapTable alloc] initWithKeyOptions:keyOptions
+                                               valueOptions:NSPointerFunctionsStrongMemory
+                                                   capacity:0];
+    _selectors = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsOpaqueMemory |
+                                                         NSPointerFunctionsOpaquePersonality];
+  }
+  return self;
+}
+
+- (NSUInteger)edo_count {
+  return _values.count;
+}
+
+- (NSUInteger)edo_indexOfString:(NSString *)string {
+  NSNumber *index = _stringIndexes[string];
+  return index ? index.unsignedIntegerValue : NSNotFound;
+}
+
+- (NSUInteger)edo_indexOfObject:(id)object {
+  NSNumber *index = [_objectIndexes objectForKey:object];
+  return index ? index.unsignedIntegerValue : NSNotFound;
+}
+
+- (id)edo_valueAtIndex:(NSUInteger)index {
+  return _values[index];
+}
+
+- (SEL)edo_selectorAtIndex:(NSUInteger)index {
+  SEL selector = (SEL)[_selectors pointerAtIndex:index];
+  if (!selector) {
+    selector = NSSelectorFromString(_values[index]);
+    [_selectors replacePointerAtIndex:index withPointer:(void *)selector];
+  }
+  return selector;
+}
+
+- (void)edo_addString:(NSString *)string {
+  _stringIndexes[string] = @(_values.count);
+  [_values addObject:string];
+  [_selectors addPointer:NULL];
+}
+
+- (void)edo_addObject:(id)object {
+  [_objectIndexes setObject:@(_values.count) forKey:object];
+  [_values addObject:object];
+  [_selectors addPointer:NULL];
+}
+
+- (void)edo_truncateToCount:(NSUInteger)count {
+  for (NSUInteger index = count; index < _values.count; ++index) {
+    id value = _values[index];
+    if ([value isKindOfClass:[NSString class]]) {
+      [_stringIndexes removeObjectForKey:value];
+    } else {
+      [_objectIndexes removeObjectForKey:value];
+    }
+  }
+  [_values removeObjectsInRange:NSMakeRange(count, _values.count - count)];
+  _selectors.count = count;
+}
+
+@end
+
+#pragma mark - EDOHostPort
+
+/** The host port is a channel class, so its binary coding is added here. */
+@interface EDOHostPort (EDOMessageCoding) <EDOMessageCoding>
+@end
+
+@implementation EDOHostPort (EDOMessageCoding)
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  UInt16 port = (UInt16)[decoder decodeInt64];
+  NSString *name = [decoder decodeInternedString];
+  NSString *deviceSerialNumber = [decoder decodeInternedString];
+  return [self initWithPort:port name:name deviceSerialNumber:deviceSerialNumber];
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [encoder encodeInt64:self.port];
+  [encoder encodeInternedString:self.name];
+  [encoder encodeInternedString:self.deviceSerialNumber];
+}
+
+@end
+
+#pragma mark - Encoder
+
+@implementation EDOMessageEncoder {
+  // The encoded bytes.
+  NSMutableData *_data;
+  // The table to intern the values in, or nil to encode them in place.
+  EDOMessageInternTable *_internTable;
+}
+
+- (instancetype)init {
+  return [self initWithInternTable:[[EDOMessageInternTable alloc] init]];
+}
+
+- (instancetype)initWithInternTable:(EDOMessageInternTable *)internTable {
+  self = [super init];
+  if (self) {
+    _data = [[NSMutableData alloc] initWithCapacity:256];
+    _internTable = internTable;
+  }
+  return self;
+}
+
+- (void)encodeBool:(BOOL)value {
+  uint8_t byte = value ? 1 : 0;
+  [_data appendBytes:&byte length:sizeof(byte)];
+}
+
+- (void)encodeInt64:(int64_t)value {
+  uint64_t littleEndianValue = OSSwapHostToLittleInt64((uint64_t)value);
+  [_data appendBytes:&littleEndianValue length:sizeof(littleEndianValue)];
+}
+
+- (void)encodeDouble:(double)value {
+  int64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  [self encodeInt64:bits];
+}
+
+- (void)encodeBytes:(const void *)bytes length:(size_t)length {
+  [_data appendBytes:bytes length:length];
+}
+
+- (void)encodeString:(NSString *)string {
+  if (!string) {
+    [self edo_encodeLength:0];
+    return;
+  }
+  const char *utf8String = string.UTF8String;
+  size_t length = strlen(utf8String);
+  // The length is offset by one to tell the nil string from the empty one.
+  [self edo_encodeLength:length + 1];
+  [_data appendBytes:utf8String length:length];
+}
+
+- (void)encodeInternedString:(NSString *)string {
+  if (!string) {
+    [self edo_encodeLength:kEDOInternedValueNil];
+    return;
+  }
+  NSUInteger index = [_internTable edo_indexOfString:string];
+  if (index == NSNotFound) {
+    if (![self edo_canInternValue]) {
+      [self edo_encodeLength:kEDOInternedValueInPlace];
+      [self encodeString:string];
+      return;
+    }
+    index = _internTable.edo_count;
+    [_internTable edo_addString:[string copy]];
+  }
+  [self edo_encodeLength:kEDOInternedValueFirstIndex + index];
+}
+
+- (void)encodeInternedObject:(id)object {
+  if (!object) {
+    [self edo_encodeLength:kEDOInternedValueNil];
+    return;
+  }
+  NSUInteger index = [_internTable edo_indexOfObject:object];
+  if (index == NSNotFound) {
+    if (![self edo_canInternValue]) {
+      [self edo_encodeLength:kEDOInternedValueInPlace];
+      [self encodeObject:object];
+      return;
+    }
+    index = _internTable.edo_count;
+    [_internTable edo_addObject:object];
+  }
+  [self edo_encodeLength:kEDOInternedValueFirstIndex + index];
+}
+
+- (void)encodeObject:(id)object {
+  EDOMessageValueType type = EDOGetMessageValueType(object, YES);
+  [self edo_encodeType:type];
+  switch (type) {
+    case EDOMessageValueTypeNil:
+      break;
+    case EDOMessageValueTypeString:
+      [self encodeString:object];
+      break;
+    case EDOMessageValueTypeData:
+      [self edo_encodeLength:((NSData *)object).length];
+      [_data appendData:object];
+      break;
+    case EDOMessageValueTypeMessageCoding:
+      [self edo_encodeLength:[EDOMessageCodingClasses()
+                                 indexOfObjectIdenticalTo:object_getClass(object)]];
+      [(id<EDOMessageCoding>)object encodeWithMessageEncoder:self];
+      break;
+    case EDOMessageValueTypeKeyedArchive: {
+      NSData *data = [NSKeyedArchiver edo_archivedDataWithObject:object];
+      [self edo_encodeLength:data.length];
+      [_data appendData:data];
+      break;
+    }
+    case EDOMessageValueTypeArray:
+      [self encodeArray:object];
+      break;
+  }
+}
+
+- (void)encodeArray:(NSArray *)array {
+  if (!array) {
+    [self edo_encodeLength:0];
+    return;
+  }
+  // The count is offset by one to tell the nil array from the empty one.
+  [self edo_encodeLength:array.count + 1];
+  for (id object in array) {
+    [self encodeObject:object];
+  }
+}
+
+- (NSData *)edo_data {
+  return _data;
+}
+
+#pragma mark - Private
+
+/**
+ * Whether a new value can be added to the intern table.
+ *
+ * The new values are sent ahead of the message by +[EDOMessageCoder dataWithMessage:...], and
+ * they are encoded in place instead once the table is full.
+ */
+- (BOOL)edo_canInternValue {
+  return _internTable && _internTable.edo_count < kEDOMessageInternTableCapacity;
+}
+
+/** Encodes the type of the object in a byte. */
+- (void)edo_encodeType:(EDOMessageValueType)type {
+  [_data appendBytes:&type length:sizeof(type)];
+}
+
+- (void)edo_encodeLength:(size_t)length {
+  uint8_t bytes[10];
+  size_t count = 0;
+  do {
+    bytes[count] = (uint8_t)(length & 0x7F);
+    length >>= 7;
+    if (length > 0) {
+      bytes[count] |= 0x80;
+    }
+    ++count;
+  } while (length > 0);
+  [_data appendBytes:bytes length:count];
+}
+
+@end
+
+#pragma mark - Decoder
+
+@implementation EDOMessageDecoder {
+  // The data to decode, which is retained for the bytes.
+  NSData *_data;
+  // The bytes of the data.
+  const uint8_t *_bytes;
+  // The number of bytes that are decoded.
+  size_t _offset;
+  // The table to look up the interned values in.
+  EDOMessageInternTable *_internTable;
+}
+
+- (instancetype)initWithData:(NSData *)data
+                      offset:(size_t)offset
+                 internTable:(EDOMessageInternTable *)internTable {
+  self = [super init];
+  if (self) {
+    _data = data;
+    _bytes = data.bytes;
+    _offset = offset;
+    _internTable = internTable;
+  }
+  return self;
+}
+
+- (BOOL)decodeBool {
+  return *(const uint8_t *)[self decodeBytesWithLength:1] != 0;
+}
+
+- (int64_t)decodeInt64 {
+  uint64_t littleEndianValue;
+  memcpy(&littleEndianValue, [self decodeBytesWithLength:sizeof(littleEndianValue)],
+         sizeof(littleEndianValue));
+  return (int64_t)OSSwapLittleToHostInt64(littleEndianValue);
+}
+
+- (double)decodeDouble {
+  int64_t bits = [self decodeInt64];
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+- (const void *)decodeBytesWithLength:(size_t)length {
+  if (length > _data.length - _offset) {
+    EDORaiseMalformedDataException(@"The data ends in the middle of a value.");
+  }
+  const void *bytes = _bytes + _offset;
+  _offset += length;
+  return bytes;
+}
+
+- (NSString *)decodeString {
+  size_t length = [self edo_decodeLength];
+  if (length == 0) {
+    return nil;
+  }
+  length -= 1;
+  const void *bytes = [self decodeBytesWithLength:length];
+  NSString *string = [[NSString alloc] initWithBytes:bytes
+                                              length:length
+                                            encoding:NSUTF8StringEncoding];
+  if (!string) {
+    EDORaiseMalformedDataException(@"The string is not in UTF-8.");
+  }
+  return string;
+}
+
+- (NSString *)decodeInternedString {
+  size_t reference = [self edo_decodeLength];
+  if (reference == kEDOInternedValueNil) {
+    return nil;
+  } else if (reference == kEDOInternedValueInPlace) {
+    return [self decodeString];
+  }
+  return [self edo_internedStringAtIndex:[self edo_internedIndexWithReference:reference]];
+}
+
+- (NSString *)decodeInternedSelectorName:(SEL *)selector {
+  size_t reference = [self edo_decodeLength];
+  if (reference == kEDOInternedValueNil) {
+    *selector = NULL;
+    return nil;
+  } else if (reference == kEDOInternedValueInPlace) {
+    NSString *selectorName = [self decodeString];
+    *selector = NSSelectorFromString(selectorName);
+    return selectorName;
+  }
+  NSUInteger index = [self edo_internedIndexWithReference:reference];
+  NSString *selectorName = [self edo_internedStringAtIndex:index];
+  *selector = [_internTable edo_selectorAtIndex:index];
+  return selectorName;
+}
+
+- (id)decodeInternedObject {
+  size_t reference = [self edo_decodeLength];
+  if (reference == kEDOInternedValueNil) {
+    return nil;
+  } else if (reference == kEDOInternedValueInPlace) {
+    return [self decodeObject];
+  }
+  return [_internTable edo_valueAtIndex:[self edo_internedIndexWithReference:reference]];
+}
+
+- (id)decodeObject {
+  EDOMessageValueType type = *(const uint8_t *)[self decodeBytesWithLength:1];
+  switch (type) {
+    case EDOMessageValueTypeNil:
+      return nil;
+    case EDOMessageValueTypeString:
+      return [self decodeString];
+    case EDOMessageValueTypeData: {
+      size_t length = [self edo_decodeLength];
+      return [NSData dataWithBytes:[self decodeBytesWithLength:length] length:length];
+    }
+    case EDOMessageValueTypeMessageCoding: {
+      NSArray<Class> *classes = EDOMessageCodingClasses();
+      size_t classIndex = [self edo_decodeLength];
+      if (classIndex >= classes.count) {
+        EDORaiseMalformedDataException(@"The class is unknown.");
+      }
+      return [(id<EDOMessageCoding>)[classes[classIndex] alloc] initWithMessageDecoder:self];
+    }
+    case EDOMessageValueTypeKeyedArchive: {
+      size_t length = [self edo_decodeLength];
+      const void *bytes = [self decodeBytesWithLength:length];
+      NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+      return [NSKeyedUnarchiver edo_unarchiveObjectWithData:data];
+    }
+    case EDOMessageValueTypeArray:
+      return [[self decodeArray] copy];
+  }
+  EDORaiseMalformedDataException(@"The type of the object is unknown.");
+  return nil;
+}
+
+- (NSArray *)decodeArray {
+  size_t count = [self edo_decodeLength];
+  if (count == 0) {
+    return nil;
+  }
+  count -= 1;
+  // Every element takes at least a byte, which bounds the capacity by the data left.
+  NSMutableArray *array =
+      [[NSMutableArray alloc] initWithCapacity:MIN(count, _data.length - _offset)];
+  for (size_t i = 0; i < count; ++i) {
+    id object = [self decodeObject];
+    if (!object) {
+      EDORaiseMalformedDataException(@"The array contains a nil object.");
+    }
+    [array addObject:object];
+  }
+  return array;
+}
+
+#pragma mark - Private
+
+/** Returns the index in the intern table that the @c reference refers to. */
+- (NSUInteger)edo_internedIndexWithReference:(size_t)reference {
+  size_t index = reference - kEDOInternedValueFirstIndex;
+  if (index >= _internTable.edo_count) {
+    EDORaiseMalformedDataException(@"The interned value is unknown.");
+  }
+  return index;
+}
+
+/** Returns the interned string at the @c index. */
+- (NSString *)edo_internedStringAtIndex:(NSUInteger)index {
+  NSString *string = [_internTable edo_valueAtIndex:index];
+  if (![string isKindOfClass:[NSString class]]) {
+    EDORaiseMalformedDataException(@"The interned value is not a string.");
+  }
+  return string;
+}
+
+- (size_t)edo_decodeLength {
+  size_t length = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    uint8_t byte = *(const uint8_t *)[self decodeBytesWithLength:1];
+    length |= (size_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return length;
+    }
+  }
+  EDORaiseMalformedDataException(@"The length is too long.");
+  return 0;
+}
+
+@end
+
+#pragma mark - Coder
+
+@implementation EDOMessageCoder
+
++ (NSData *)dataWithMessage:(EDOMessage *)message binaryCoding:(BOOL)binaryCoding {
+  return [self dataWithMessage:message binaryCoding:binaryCoding internTable:nil];
+}
+
++ (NSData *)dataWithMessage:(EDOMessage *)message
+               binaryCoding:(BOOL)binaryCoding
+                internTable:(EDOMessageInternTable *)internTable {
+  if (!binaryCoding) {
+    return [NSKeyedArchiver edo_archivedDataWithObject:message];
+  }
+  // Without a connection, the values are only interned within the message.
+  internTable = internTable ?: [[EDOMessageInternTable alloc] init];
+  NSUInteger internedCount = internTable.edo_count;
+  EDOMessageEncoder *encoder = [[EDOMessageEncoder alloc] initWithInternTable:internTable];
+  @try {
+    [encoder encodeObject:message];
+  } @catch (NSException *exception) {
+    // The message isn't sent, so the peer never learns the values interned for it.
+    [internTable edo_truncateToCount:internedCount];
+    @throw;
+  }
+
+  // The new values are sent ahead of the message, so the peer interns them even if it fails to
+  // decode the rest of the message, and both tables stay in sync. The values themselves are encoded
+  // in place.
+  EDOMessageEncoder *headerEncoder = [[EDOMessageEncoder alloc] initWithInternTable:nil];
+  [headerEncoder encodeBytes:kEDOMessageCoderMagic length:sizeof(kEDOMessageCoderMagic)];
+  [headerEncoder edo_encodeLength:internTable.edo_count - internedCount];
+  for (NSUInteger index = internedCount; index < internTable.edo_count; ++index) {
+    [headerEncoder encodeObject:[internTable edo_valueAtIndex:index]];
+  }
+  NSData *body = encoder.edo_data;
+  [headerEncoder encodeBytes:body.bytes length:body.length];
+  return headerEncoder.edo_data;
+}
+
++ (EDOMessage *)messageWithData:(NSData *)data {
+  return [self messageWithData:data internTable:nil];
+}
+
++ (EDOMessage *)messageWithData:(NSData *)data internTable:(EDOMessageInternTable *)internTable {
+  if (![self isBinaryCodedData:data]) {
+    return [NSKeyedUnarchiver edo_unarchiveObjectWithData:data];
+  }
+  internTable = internTable ?: [[EDOMessageInternTable alloc] init];
+  EDOMessageDecoder *decoder = [[EDOMessageDecoder alloc] initWithData:data
+                                                                offset:sizeof(kEDOMessageCoderMagic)
+                                                           internTable:internTable];
+  size_t newValueCount = [decoder edo_decodeLength];
+  if (newValueCount > kEDOMessageInternTableCapacity - internTable.edo_count) {
+    EDORaiseMalformedDataException(@"The intern table is full.");
+  }
+  for (size_t i = 0; i < newValueCount; ++i) {
+    id value = [decoder decodeObject];
+    if (!value) {
+      EDORaiseMalformedDataException(@"The interned value is nil.");
+    } else if ([value isKindOfClass:[NSString class]]) {
+      if ([internTable edo_indexOfString:value] != NSNotFound) {
+        EDORaiseMalformedDataException(@"The string is interned twice.");
+      }
+      [internTable edo_addString:value];
+    } else {
+      [internTable edo_addObject:value];
+    }
+  }
+  id message = [decoder decodeObject];
+  if (![message isKindOfClass:[EDOMessage class]]) {
+    EDORaiseMalformedDataException(@"The data doesn't contain a message.");
+  }
+  return message;
+}
+
++ (BOOL)isBinaryCodedData:(NSData *)data {
+  return data.length >= sizeof(kEDOMessageCoderMagic) &&
+         memcmp(data.bytes, kEDOMessageCoderMagic, sizeof(kEDOMessageCoderMagic)) == 0;
+}
+
+@end
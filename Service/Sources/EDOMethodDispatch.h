@@ -0,0 +1,126 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOInvocationPlan;
+
+/** The list of method families that should retain the returned object. */
+typedef NS_ENUM(NSUInteger, EDOMethodFamily) {
+  EDOMethodFamilyNone,
+  EDOMethodFamilyAlloc,
+  EDOMethodFamilyCopy,
+  EDOMethodFamilyNew,
+  EDOMethodFamilyMutableCopy,
+};
+
+/**
+ * Gets the family type of the method belonging to the ns_returns_retained family.
+ *
+ * More info here:
+ * https://clang.llvm.org/docs/AutomaticReferenceCounting.html#retained-return-values.
+ *
+ * @param methodName  The method name.
+ * @param targetClass The class of the target, whose generated protobuf methods are never retained.
+ * @return The method family type.
+ */
+FOUNDATION_EXTERN EDOMethodFamily EDOGetMethodFamily(const char *_Nullable methodName,
+                                                     Class targetClass);
+
+/** The maximum number of arguments of the methods that are invoked directly. */
+enum { kEDOMethodDispatchMaxArguments = 4 };
+
+/**
+ * The method of a class that the host resolves once to invoke the requests on its instances.
+ *
+ * Most of the remote invocations go to methods that take a few objects or integers and return
+ * nothing, an object or an integer. These methods are called through their implementation with
+ * each argument passed in a word, so the host doesn't create an @c NSInvocation for them. The
+ * other methods are still invoked by @c NSInvocation with the cached method signature.
+ *
+ * The dispatch also keeps what the host needs to know about the method for every request, such as
+ * its method family, so the host only works them out at the first request. The dispatches can be
+ * resolved ahead of the first requests by @c +dispatchForClass:selector:.
+ */
+@interface EDOMethodDispatch : NSObject
+
+/** The selector of the method. */
+@property(readonly, nonatomic) SEL selector;
+/** The signature of the method. */
+@property(readonly, nonatomic) NSMethodSignature *signature;
+/** The plan that has the kinds and the sizes of the arguments parsed from the signature. */
+@property(readonly, nonatomic) EDOInvocationPlan *plan;
+/** Whether the method is called directly by @c -invokeWithTarget:arguments:. */
+@property(readonly, nonatomic) BOOL invokesDirectly;
+/** The family of the method, which decides whether its returned object is retained. */
+@property(readonly, nonatomic) EDOMethodFamily methodFamily;
+
+/**
+ * Gets the dispatch of the method that the class of the @c target implements.
+ *
+ * The dispatch is cached for the class and the selector. The method that is only handled by the
+ * forwarding of the @c target doesn't have a dispatch, as the forwarding target can vary.
+ *
+ * @param target   The object to invoke the method on.
+ * @param selector The selector of the method.
+ *
+ * @return The dispatch of the method, or @c nil if the class doesn't implement the method.
+ */
++ (nullable instancetype)dispatchForTarget:(id)target selector:(SEL)selector;
+
+/**
+ * Gets the dispatch of the method for the instances of the class, resolving it if it's not cached.
+ *
+ * @param klass    The class of the targets, which is the metaclass for the class methods.
+ * @param selector The selector of the method.
+ *
+ * @return The dispatch of the method, or @c nil if the class doesn't implement the method.
+ */
++ (nullable instancetype)dispatchForClass:(Class)klass selector:(SEL)selector;
+
+/** Gets the dispatches that are cached for the class. */
++ (NSArray<EDOMethodDispatch *> *)cachedDispatchesForClass:(Class)klass;
+
+/**
+ * Converts the value of an argument to the word it is passed in.
+ *
+ * @param bytes    The buffer of the value.
+ * @param objCType The type of the value, which is an object, a pointer to an object, or an integer.
+ *
+ * @return The value extended to a word.
+ */
++ (uintptr_t)wordWithBytes:(const void *)bytes objCType:(const char *)objCType;
+
+/**
+ * Calls the method directly, which is only supported if @c invokesDirectly is @c YES.
+ *
+ * The objects are neither retained nor released, the same as @c NSInvocation without retaining its
+ * arguments.
+ *
+ * @param target    The object to call the method on.
+ * @param arguments The words of the arguments, in the order of the signature.
+ *
+ * @return The word of the return value, which is undefined for a void method.
+ */
+- (uintptr_t)invokeWithTarget:(id)target arguments:(const uintptr_t *)arguments;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,245 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDOMethodDispatch.h"
+
+#include <objc/runtime.h>
+
+#import "Service/Sources/EDOInvocationPlan.h"
+#import "Service/Sources/EDOParameter.h"
+
+/** A struct representing an Objective-C method family. */
+typedef struct MethodFamily {
+  /** The method family type. */
+  EDOMethodFamily family;
+  /** The prefix identifying the method family. */
+  const char *prefix;
+  /** The length of the prefix of the method family. */
+  size_t length;
+} MethodFamily;
+
+/** The helper macro to define a @c MethodFamily above. */
+#define METHOD_FAMILY(__family, __str) \
+  ((MethodFamily){.family = (__family), .prefix = (__str), .length = sizeof(__str) - 1})
+
+/** The methods family that should retain the returned object. */
+static const MethodFamily kRetainReturnsMethodsFamily[] = {
+    METHOD_FAMILY(EDOMethodFamilyAlloc, "alloc"),
+    METHOD_FAMILY(EDOMethodFamilyCopy, "copy"),
+    METHOD_FAMILY(EDOMethodFamilyNew, "new"),
+    METHOD_FAMILY(EDOMethodFamilyMutableCopy, "mutableCopy"),
+};
+
+EDOMethodFamily EDOGetMethodFamily(const char *methodName, Class targetClass) {
+  static Class protobufMessageClass;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    protobufMessageClass = NSClassFromString(@"ComGoogleProtobufGeneratedMessage");
+  });
+  if (!methodName ||
+      (protobufMessageClass && [targetClass isSubclassOfClass:protobufMessageClass])) {
+    return EDOMethodFamilyNone;
+  }
+
+  /**
+   * To find out if a selector is in a certain method family:
+   *
+   * A selector is in a certain selector family if, ignoring any leading underscores, the first
+   * component of the selector either consists entirely of the name of the method family or it
+   * begins with that name followed by a character other than a lowercase letter.
+   * http://clang.llvm.org/docs/AutomaticReferenceCounting.html#method-families
+   */
+
+  // Skip the leading underscore as it is considered to be the same method family.
+  while (*methodName == '_') {
+    ++methodName;
+  }
+
+  // Skip the first component if it begins with a method family that is implicitly annotated with
+  // the ns_returns_retained attribute.
+  BOOL matchesMethodFamily = NO;
+  int familySize = sizeof(kRetainReturnsMethodsFamily) / sizeof(MethodFamily);
+  int methodIdx = 0;
+  for (; methodIdx < familySize; methodIdx++) {
+    MethodFamily family = kRetainReturnsMethodsFamily[methodIdx];
+    if (strncmp(methodName, family.prefix, family.length) == 0) {
+      methodName += family.length;
+      matchesMethodFamily = YES;
+      break;
+    }
+  }
+
+  if (!matchesMethodFamily) {
+    return EDOMethodFamilyNone;
+  }
+
+  // It should end or be followed by a character other than a lowercase letter.
+  if (*methodName == '\0' || !islower(*methodName)) {
+    return kRetainReturnsMethodsFamily[methodIdx].family;
+  } else {
+    return EDOMethodFamilyNone;
+  }
+}
+
+/** The key of the table of the dispatches associated with a class. */
+static const void *kEDOMethodDispatchTableKey = &kEDOMethodDispatchTableKey;
+
+/** The integer types that are passed in a word, excluding @c long whose size varies. */
+static const char kEDOWordIntegerTypes[] = {
+    _C_CHR, _C_UCHR, _C_SHT, _C_USHT, _C_INT, _C_UINT, _C_LNG_LNG, _C_ULNG_LNG, _C_BOOL,
+};
+
+/** Whether the value of the @c objCType is passed and returned in a word. */
+static BOOL EDOIsWordType(const char *objCType) {
+  if (EDO_IS_OBJECT_OR_CLASS(objCType) || EDO_IS_OBJPOINTER(objCType)) {
+    return YES;
+  }
+  return objCType[0] != '\0' && objCType[1] == '\0' &&
+         memchr(kEDOWordIntegerTypes, objCType[0], sizeof(kEDOWordIntegerTypes)) != NULL;
+}
+
+/** Whether the method of the @c plan can be called directly. */
+static BOOL EDOCanInvokeDirectly(EDOInvocationPlan *plan) {
+  NSMethodSignature *signature = plan.signature;
+  NSUInteger numOfArgs = signature.numberOfArguments;
+  if (numOfArgs - plan.firstArgumentIndex > kEDOMethodDispatchMaxArguments) {
+    return NO;
+  }
+  for (NSUInteger i = plan.firstArgumentIndex; i < numOfArgs; ++i) {
+    if (!EDOIsWordType([plan argumentAtIndex:i]->objCType)) {
+      return NO;
+    }
+  }
+  const char *returnType = signature.methodReturnType;
+  return (returnType[0] == _C_VOID && returnType[1] == '\0') ||
+         (EDOIsWordType(returnType) && !EDO_IS_OBJPOINTER(returnType));
+}
+
+@implementation EDOMethodDispatch {
+  // The method whose implementation is called, which is read at each call so the method can be
+  // swizzled after it is resolved.
+  Method _method;
+}
+
++ (instancetype)dispatchForTarget:(id)target selector:(SEL)selector {
+  return [self dispatchForClass:object_getClass(target) selector:selector];
+}
+
++ (instancetype)dispatchForClass:(Class)klass selector:(SEL)selector {
+  NSMapTable<id, EDOMethodDispatch *> *table;
+  @synchronized(self) {
+    table = objc_getAssociatedObject(klass, kEDOMethodDispatchTableKey);
+    EDOMethodDispatch *dispatch = [table objectForKey:(__bridge id)(void *)selector];
+    if (dispatch) {
+      return dispatch;
+    }
+  }
+
+  Method method = class_getInstanceMethod(klass, selector);
+  if (!method) {
+    return nil;
+  }
+  EDOMethodDispatch *dispatch = [[self alloc] initWithMethod:method
+                                                      selector:selector
+                                                         class:klass];
+  @synchronized(self) {
+    table = objc_getAssociatedObject(klass, kEDOMethodDispatchTableKey);
+    if (!table) {
+      NSPointerFunctionsOptions keyOptions =
+          NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality;
+      table = [[NSMapTable alloc] initWithKeyOptions:keyOptions
+                                        valueOptions:NSPointerFunctionsStrongMemory
+                                            capacity:0];
+      objc_setAssociatedObject(klass, kEDOMethodDispatchTableKey, table,
+                               OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    [table setObject:dispatch forKey:(__bridge id)(void *)selector];
+  }
+  return dispatch;
+}
+
++ (NSArray<EDOMethodDispatch *> *)cachedDispatchesForClass:(Class)klass {
+  @synchronized(self) {
+    NSMapTable<id, EDOMethodDispatch *> *table =
+        objc_getAssociatedObject(klass, kEDOMethodDispatchTableKey);
+    return table.objectEnumerator.allObjects ?: @[];
+  }
+}
+
++ (uintptr_t)wordWithBytes:(const void *)bytes objCType:(const char *)objCType {
+  // The narrow integers are extended by their signedness as the calling conventions expect.
+  switch (objCType[0]) {
+    case _C_CHR:
+      return (uintptr_t)(*(const signed char *)bytes);
+    case _C_UCHR:
+    case _C_BOOL:
+      return *(const unsigned char *)bytes;
+    case _C_SHT:
+      return (uintptr_t)(*(const short *)bytes);
+    case _C_USHT:
+      return *(const unsigned short *)bytes;
+    case _C_INT:
+      return (uintptr_t)(*(const int *)bytes);
+    case _C_UINT:
+      return *(const unsigned int *)bytes;
+    default: {
+      uintptr_t word;
+      memcpy(&word, bytes, sizeof(word));
+      return word;
+    }
+  }
+}
+
+- (instancetype)initWithMethod:(Method)method selector:(SEL)selector class:(Class)klass {
+  self = [super init];
+  if (self) {
+    _method = method;
+    _selector = selector;
+    _signature = [NSMethodSignature signatureWithObjCTypes:method_getTypeEncoding(method)];
+    _plan = [EDOInvocationPlan planWithMethodSignature:_signature firstArgumentIndex:2];
+    _invokesDirectly = EDOCanInvokeDirectly(_plan);
+    // The family is decided by the class that the targets return from -class, which is the class
+    // itself rather than its metaclass for the class methods.
+    Class targetClass = class_isMetaClass(klass) ? objc_getClass(class_getName(klass)) : klass;
+    _methodFamily = EDOGetMethodFamily(sel_getName(selector), targetClass);
+  }
+  return self;
+}
+
+- (uintptr_t)invokeWithTarget:(id)target arguments:(const uintptr_t *)arguments {
+  NSAssert(self.invokesDirectly, @"The method %@ can't be called directly.",
+           NSStringFromSelector(_selector));
+  // The receiver and the return are not managed by ARC, the same as NSInvocation.
+  void *receiver = (__bridge void *)target;
+  IMP imp = method_getImplementation(_method);
+  switch (_signature.numberOfArguments - 2) {
+    case 0:
+      return ((uintptr_t(*)(void *, SEL))imp)(receiver, _selector);
+    case 1:
+      return ((uintptr_t(*)(void *, SEL, uintptr_t))imp)(receiver, _selector, arguments[0]);
+    case 2:
+      return ((uintptr_t(*)(void *, SEL, uintptr_t, uintptr_t))imp)(receiver, _selector,
+                                                                    arguments[0], arguments[1]);
+    case 3:
+      return ((uintptr_t(*)(void *, SEL, uintptr_t, uintptr_t, uintptr_t))imp)(
+          receiver, _selector, arguments[0], arguments[1], arguments[2]);
+    default:
+      return ((uintptr_t(*)(void *, SEL, uintptr_t, uintptr_t, uintptr_t, uintptr_t))imp)(
+          receiver, _selector, arguments[0], arguments[1], arguments[2], arguments[3]);
+  }
+}
+
+@end
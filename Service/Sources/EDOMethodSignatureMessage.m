@@ -60,9 +60,22 @@ static NSString *const kEDOMethodSignatureCoderSelectorKey = @"selector";
   [aCoder encodeObject:self.signature forKey:kEDOMethodSignatureCoderSignatureKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _signature = [decoder decodeInternedString];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeInternedString:self.signature];
+}
+
 - (NSString *)description {
   return [NSString
-      stringWithFormat:@"Method signature response (%@): (%@)", self.messageID, self.signature];
+      stringWithFormat:@"Method signature response (%llx): (%@)", self.messageID, self.signature];
 }
 
 @end
@@ -141,13 +154,30 @@ static NSString *const kEDOMethodSignatureCoderSelectorKey = @"selector";
   [aCoder encodeObject:self.port forKey:kEDOMethodSignatureCoderPortKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _object = [decoder decodeInt64];
+    _selectorName = [decoder decodeInternedString];
+    _port = [decoder decodeObject];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeInt64:self.object];
+  [encoder encodeInternedString:self.selectorName];
+  [encoder encodeObject:self.port];
+}
+
 - (BOOL)matchesService:(EDOServicePort *)originatorPort {
   return [self.port match:originatorPort];
 }
 
 - (NSString *)description {
   return [NSString
-      stringWithFormat:@"Method signature request (%@): (%@)", self.messageID, self.selectorName];
+      stringWithFormat:@"Method signature request (%llx): (%@)", self.messageID, self.selectorName];
 }
 
 @end
@@ -21,13 +21,16 @@
 #import "Service/Sources/EDOBlockObject.h"
 #import "Service/Sources/EDOClientService+Private.h"
 #import "Service/Sources/EDOClientService.h"
+#import "Service/Sources/EDOFuture+Private.h"
 #import "Service/Sources/EDOHostService+Private.h"
 #import "Service/Sources/EDOHostService.h"
 #import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOInvocationPlan.h"
 #import "Service/Sources/EDOMethodSignatureMessage.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOParameter.h"
 #import "Service/Sources/EDORemoteException.h"
+#import "Service/Sources/EDOServiceException.h"
 #import "Service/Sources/EDOServicePort.h"
 #import "Service/Sources/EDOServiceRequest.h"
 
@@ -70,6 +73,9 @@ static EDORemoteException *RemoteExceptionWithLocalInformation(EDORemoteExceptio
 // The cache of the instance method signatures.
 static NSCache<NSString *, NSMethodSignature *> *gEDOInstanceMethodSignatureCache;
 
+// The key of the invocation plan associated with the cached instance method signature.
+static const void *kEDOInvocationPlanKey = &kEDOInvocationPlanKey;
+
 /**
  * Builds the key for the instance method signature cache.
  *
@@ -104,9 +110,34 @@ static NSMethodSignature *EDOInstanceMethodSignatureForSelector(SEL selector, NS
 static void EDOAddInstanceMethodSignature(NSMethodSignature *methodSignature, SEL selector,
                                           NSString *className) {
   NSString *key = EDOCreateMethodSignatureCacheKey(selector, className);
+  // The plan is made before the signature is shared, so the invocations of the cached signature
+  // don't parse it again.
+  EDOInvocationPlan *plan = [EDOInvocationPlan planWithMethodSignature:methodSignature
+                                                    firstArgumentIndex:2];
+  objc_setAssociatedObject(methodSignature, kEDOInvocationPlanKey, plan,
+                           OBJC_ASSOCIATION_RETAIN_NONATOMIC);
   [gEDOInstanceMethodSignatureCache setObject:methodSignature forKey:key];
 }
 
+/**
+ * Gets the invocation plan for the method signature of the invocation.
+ *
+ * @param methodSignature The method signature.
+ * @param selector        The selector, or @c nil for a block invocation.
+ * @return The plan cached with the instance method signature, or a new plan if the signature is
+ *         not cached.
+ */
+static EDOInvocationPlan *EDOInvocationPlanForMethodSignature(NSMethodSignature *methodSignature,
+                                                              SEL selector) {
+  NSUInteger firstArgumentIndex = selector ? 2 : 1;
+  EDOInvocationPlan *plan = objc_getAssociatedObject(methodSignature, kEDOInvocationPlanKey);
+  if (plan.firstArgumentIndex == firstArgumentIndex) {
+    return plan;
+  }
+  return [EDOInvocationPlan planWithMethodSignature:methodSignature
+                                 firstArgumentIndex:firstArgumentIndex];
+}
+
 /**
  * The extension of EDOObject to handle the message forwarding.
  *
@@ -178,7 +209,10 @@ static void EDOAddInstanceMethodSignature(NSMethodSignature *methodSignature, SE
     useTemporaryService = YES;
   }
 
+  EDOInvocationPlan *plan =
+      EDOInvocationPlanForMethodSignature(invocation.methodSignature, selector);
   EDOInvocationRequest *request = [EDOInvocationRequest requestWithInvocation:invocation
+                                                                         plan:plan
                                                                        target:self
                                                                      selector:selector
                                                                 returnByValue:returnByValue
@@ -205,9 +239,8 @@ static void EDOAddInstanceMethodSignature(NSMethodSignature *methodSignature, SE
     @throw RemoteExceptionWithLocalInformation(response.exception, self, invocation);  // NOLINT
   }
 
-  NSUInteger returnBufSize = invocation.methodSignature.methodReturnLength;
-  char const *ctype = invocation.methodSignature.methodReturnType;
-  if (EDO_IS_OBJECT_OR_CLASS(ctype)) {
+  NSUInteger returnBufSize = plan.returnSize;
+  if (plan.returnKind == EDOInvocationValueKindObject) {
     id __unsafe_unretained obj;
     [response.returnValue getValue:&obj];
     obj = [EDOClientService unwrappedObjectFromObject:obj];
@@ -229,12 +262,11 @@ static void EDOAddInstanceMethodSignature(NSMethodSignature *methodSignature, SE
 
   NSArray<EDOBoxedValueType *> *outValues = response.outValues;
   if (outValues.count > 0) {
-    NSMethodSignature *method = invocation.methodSignature;
-    NSUInteger numOfArgs = method.numberOfArguments;
-    for (NSUInteger curArgIdx = selector ? 2 : 1, curOutIdx = 0; curArgIdx < numOfArgs;
-         ++curArgIdx) {
-      char const *ctype = [method getArgumentTypeAtIndex:curArgIdx];
-      if (!EDO_IS_OBJPOINTER(ctype)) {
+    NSUInteger numOfArgs = plan.signature.numberOfArguments;
+    NSUInteger numOfOutArgs = plan.numberOfObjectPointerArguments;
+    for (NSUInteger curArgIdx = plan.firstArgumentIndex, curOutIdx = 0;
+         curArgIdx < numOfArgs && curOutIdx < numOfOutArgs; ++curArgIdx) {
+      if ([plan argumentAtIndex:curArgIdx]->kind != EDOInvocationValueKindObjectPointer) {
         continue;
       }
 
@@ -255,4 +287,93 @@ static void EDOAddInstanceMethodSignature(NSMethodSignature *methodSignature, SE
   }
 }
 
+- (void)edo_forwardInvocation:(NSInvocation *)invocation
+                     selector:(SEL)selector
+                       future:(EDOFuture *)future {
+  EDOHostService *service = [EDOHostService serviceForCurrentOriginatingQueue];
+  if (!service) {
+    service = [EDOHostService temporaryServiceForCurrentThread];
+    if (service.valid) {
+      [future setTemporaryExecutorForCurrentThread:service.executor];
+    }
+  }
+
+  EDOInvocationPlan *plan;
+  EDOInvocationRequest *request = [self edo_requestWithInvocation:invocation
+                                                         selector:selector
+                                                          service:service
+                                                             plan:&plan];
+  [EDOClientService sendRequest:request
+                         onPort:self.servicePort.hostPort
+              completionHandler:^(EDOServiceResponse *response, NSError *error) {
+                // The service is kept until the response is received so the remote invocation
+                // can call back to the arguments that are wrapped by the service. The target is
+                // kept too, or its release request may reach the host before the invocation.
+                (void)service;
+                (void)self;
+                EDOInvocationResponse *invocationResponse = (EDOInvocationResponse *)response;
+                id result = invocationResponse
+                                ? [EDOObject edo_resultFromResponse:invocationResponse plan:plan]
+                                : nil;
+                [future finishWithResult:result
+                               exception:invocationResponse.exception
+                                   error:error];
+              }];
+}
+
+- (EDOInvocationRequest *)edo_requestWithInvocation:(NSInvocation *)invocation
+                                           selector:(SEL)selector
+                                            service:(EDOHostService *)service
+                                               plan:(EDOInvocationPlan **)planOut {
+  EDOInvocationPlan *plan =
+      EDOInvocationPlanForMethodSignature(invocation.methodSignature, selector);
+  // The out values would be filled after the caller has returned, so they are not supported.
+  for (NSUInteger curArgIdx = plan.firstArgumentIndex;
+       curArgIdx < plan.signature.numberOfArguments; ++curArgIdx) {
+    if ([plan argumentAtIndex:curArgIdx]->kind != EDOInvocationValueKindObjectPointer) {
+      continue;
+    }
+    void *objRef;
+    [invocation getArgument:&objRef atIndex:curArgIdx];
+    if (objRef) {
+      NSString *reason = [NSString
+          stringWithFormat:@"The deferred invocation of %@ can't fill the argument %lu back.",
+                           NSStringFromSelector(selector), (unsigned long)curArgIdx];
+      [[NSException exceptionWithName:EDOTypeEncodingException reason:reason userInfo:nil] raise];
+    }
+  }
+
+  EDOInvocationRequest *request = [EDOInvocationRequest requestWithInvocation:invocation
+                                                                         plan:plan
+                                                                       target:self
+                                                                     selector:selector
+                                                                returnByValue:NO
+                                                                      service:service];
+  // The caller gets zero, and the result is read from the response later.
+  if (plan.returnSize > 0) {
+    char *const returnBuf = calloc(plan.returnSize, sizeof(char));
+    [invocation setReturnValue:returnBuf];
+    free(returnBuf);
+  }
+  *planOut = plan;
+  return request;
+}
+
++ (id)edo_resultFromResponse:(EDOInvocationResponse *)response plan:(EDOInvocationPlan *)plan {
+  if (plan.returnKind == EDOInvocationValueKindObject) {
+    id __unsafe_unretained obj;
+    [response.returnValue getValue:&obj];
+    obj = [EDOClientService unwrappedObjectFromObject:obj];
+    return [EDOClientService cachedEDOFromObjectUpdateIfNeeded:obj];
+  } else if (plan.returnSize > 0) {
+    char *const returnBuf = calloc(plan.returnSize, sizeof(char));
+    [response.returnValue getValue:returnBuf];
+    NSValue *result = [NSValue valueWithBytes:returnBuf
+                                     objCType:plan.signature.methodReturnType];
+    free(returnBuf);
+    return result;
+  }
+  return nil;
+}
+
 @end
@@ -18,6 +18,11 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class EDOFuture;
+@class EDOHostService;
+@class EDOInvocationPlan;
+@class EDOInvocationRequest;
+@class EDOInvocationResponse;
 @class EDOServicePort;
 
 typedef int64_t EDOPointerType;
@@ -72,6 +77,47 @@ typedef int64_t EDOPointerType;
                      selector:(SEL _Nullable)selector
                 returnByValue:(BOOL)returnByValue;
 
+/**
+ * The method to forward invocation asynchronously.
+ *
+ * The invocation returns zero once the request is sent, and the result is delivered to the
+ * @c future when the response is received.
+ *
+ * @param  invocation The invocation to forward, which can't have the out arguments.
+ * @param  selector   The selector to be sent. @c nil if it forwards a block invocation.
+ * @param  future     The future to complete with the result of the invocation.
+ */
+- (void)edo_forwardInvocation:(NSInvocation *)invocation
+                     selector:(SEL _Nullable)selector
+                       future:(EDOFuture *)future;
+
+/**
+ * Creates the request of the invocation whose result is read from the response later instead of
+ * being set back to the invocation, which returns zero.
+ *
+ * @param      invocation The invocation, which can't have the out arguments.
+ * @param      selector   The selector to be sent. @c nil if it forwards a block invocation.
+ * @param      service    The host service used to wrap the arguments in the @c invocation if any.
+ * @param[out] plan       The plan of the method signature to read the result with.
+ *
+ * @return The request of the invocation.
+ */
+- (EDOInvocationRequest *)edo_requestWithInvocation:(NSInvocation *)invocation
+                                           selector:(SEL _Nullable)selector
+                                            service:(EDOHostService *)service
+                                               plan:(EDOInvocationPlan *_Nullable *_Nonnull)plan;
+
+/**
+ * Reads the result of a deferred invocation from its response.
+ *
+ * @param response The response of the invocation.
+ * @param plan     The plan of the method signature of the invocation.
+ *
+ * @return The returned object, the other types boxed in an @c NSValue, or @c nil for @c void.
+ */
++ (nullable id)edo_resultFromResponse:(EDOInvocationResponse *)response
+                                 plan:(EDOInvocationPlan *)plan;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -21,6 +21,9 @@
 
 #import "Service/Sources/EDOClientService+Private.h"
 #import "Service/Sources/EDOClientService.h"
+#import "Service/Sources/EDODeadline+Private.h"
+#import "Service/Sources/EDOFuture+Private.h"
+#import "Service/Sources/EDOMessageCoder.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObjectReleaseMessage.h"
 #import "Service/Sources/EDOParameter.h"
@@ -38,7 +41,7 @@ static NSString *const kEDOObjectCoderProcessUUIDKey = @"edoProcessUUID";
 /** Returns the boolean idicating if the two objects are from the same process. */
 static BOOL IsFromSameProcess(id object1, id object2);
 
-@interface EDOObject ()
+@interface EDOObject () <EDOMessageCoding>
 /** The port to connect to the local socket. */
 @property(nonatomic, readonly) EDOServicePort *servicePort;
 /** The proxied object's address in the remote. */
@@ -87,6 +90,16 @@ static BOOL IsFromSameProcess(id object1, id object2);
   return [[EDOValueObject alloc] initWithRemoteObject:self];
 }
 
+- (id)edo_asyncWithFuture:(EDOFuture **)future {
+  EDOAsyncObject *asyncObject = [[EDOAsyncObject alloc] initWithRemoteObject:self];
+  *future = asyncObject.future;
+  return asyncObject;
+}
+
+- (id)edo_withTimeout:(NSTimeInterval)timeout {
+  return [[EDODeadlineObject alloc] initWithRemoteObject:self timeout:timeout];
+}
+
 - (id)remoteWeak {
   [[NSException exceptionWithName:EDOWeakObjectRemoteWeakMisuseException
                            reason:@"Calling remoteWeak on a remote object."
@@ -181,6 +194,24 @@ static BOOL IsFromSameProcess(id object1, id object2);
   [aCoder encodeObject:self.processUUID forKey:kEDOObjectCoderProcessUUIDKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  _servicePort = [decoder decodeInternedObject];
+  _remoteAddress = [decoder decodeInt64];
+  _remoteClass = [decoder decodeInt64];
+  _className = [decoder decodeInternedString];
+  _local = NO;
+  _processUUID = [decoder decodeInternedString];
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [encoder encodeInternedObject:self.servicePort];
+  [encoder encodeInt64:self.remoteAddress];
+  [encoder encodeInt64:self.remoteClass];
+  [encoder encodeInternedString:self.className];
+  [encoder encodeInternedString:self.processUUID];
+}
+
 - (BOOL)isEqual:(id)object {
   if (self == object) {
     return YES;
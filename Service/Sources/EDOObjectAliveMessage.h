@@ -50,7 +50,10 @@ NS_ASSUME_NONNULL_BEGIN
 /** @see -[NSCoding initWithCoder:]. */
 - (instancetype)initWithCoder:(NSCoder *)aDecoder NS_DESIGNATED_INITIALIZER;
 
-- (instancetype)initWithMessageID:(NSString *)messageID NS_UNAVAILABLE;
+/** @see -[EDOMessageCoding initWithMessageDecoder:]. */
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)initWithMessageID:(EDOMessageID)messageID NS_UNAVAILABLE;
 
 @end
 
@@ -70,6 +70,21 @@ static NSString *const kEDOObjectAliveCoderIsAliveKey = @"isAlive";
   [aCoder encodeInt64:self.remoteAddress forKey:kEDOObjectAliveCoderRemoteAddressKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _servicePort = [decoder decodeObject];
+    _remoteAddress = [decoder decodeInt64];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeObject:self.servicePort];
+  [encoder encodeInt64:self.remoteAddress];
+}
+
 + (EDORequestHandler)requestHandler {
   return ^(EDOServiceRequest *request, EDOHostService *service) {
     EDOObjectAliveRequest *retainRequest = (EDOObjectAliveRequest *)request;
@@ -114,4 +129,17 @@ static NSString *const kEDOObjectAliveCoderIsAliveKey = @"isAlive";
   [aCoder encodeBool:self.isAlive forKey:kEDOObjectAliveCoderIsAliveKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _alive = [decoder decodeBool];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeBool:self.isAlive];
+}
+
 @end
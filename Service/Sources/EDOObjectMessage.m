@@ -79,6 +79,19 @@ static NSString *const kEDOObjectCoderHostPortKey = @"hostPort";
   [aCoder encodeObject:self.hostPort forKey:kEDOObjectCoderHostPortKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _hostPort = [decoder decodeObject];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeObject:self.hostPort];
+}
+
 @end
 
 #pragma mark -
@@ -110,6 +123,19 @@ static NSString *const kEDOObjectCoderHostPortKey = @"hostPort";
   [aCoder encodeObject:self.object forKey:kEDOObjectCoderObjectKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _object = [decoder decodeObject];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeObject:self.object];
+}
+
 + (EDOServiceResponse *)responseWithObject:(EDOObject *)object
                                 forRequest:(EDOServiceRequest *)request {
   return [[self alloc] initWithObject:object forRequest:request];
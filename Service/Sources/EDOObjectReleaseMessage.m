@@ -73,6 +73,21 @@ static NSString *const kEDOObjectReleaseCoderRemoteAddressKey = @"remoteAddress"
   [aCoder encodeBool:self.weaklyReferenced forKey:kEDOObjectReleaseCoderWeaklyReferencedKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _remoteAddress = [decoder decodeInt64];
+    _weaklyReferenced = [decoder decodeBool];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeInt64:self.remoteAddress];
+  [encoder encodeBool:self.weaklyReferenced];
+}
+
 + (EDORequestHandler)requestHandler {
   return ^(EDOServiceRequest *request, EDOHostService *service) {
     EDOObjectReleaseRequest *releaseRequest = (EDOObjectReleaseRequest *)request;
@@ -61,6 +61,19 @@ NS_ASSUME_NONNULL_BEGIN
 /** Create a EDOParameter with the buffer saving the data and type encoding for the data. */
 + (instancetype)parameterWithBytes:(void *_Nullable)bytes objCType:(const char *)objCType;
 
+/**
+ * Create a EDOParameter with the buffer of a non-object value whose type is already parsed.
+ *
+ * @param bytes        The buffer saving the data.
+ * @param objCType     The type encoding for the data.
+ * @param size         The size of the data.
+ * @param typeEncoding The @c objCType as a string, which is shared by the parameters of the type.
+ */
++ (instancetype)parameterWithBytes:(void *)bytes
+                          objCType:(const char *)objCType
+                              size:(NSUInteger)size
+                      typeEncoding:(NSString *)typeEncoding;
+
 /** Create a EDOParameter with the @c object. */
 + (instancetype)parameterWithObject:(id<NSCoding>)object;
 
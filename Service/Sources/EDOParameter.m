@@ -17,6 +17,7 @@
 #import "Service/Sources/EDOParameter.h"
 
 #import "Service/Sources/EDOBlockObject.h"
+#import "Service/Sources/EDOMessageCoder.h"
 #import "Service/Sources/EDOObject.h"
 
 static NSString *const kObjCIdType = @"@";
@@ -24,6 +25,76 @@ static NSString *const kObjCSelectorType = @":";
 static NSString *const kEDOParameterCoderValueKey = @"value";
 static NSString *const kEDOParameterCoderTypeKey = @"type";
 
+/** The maximum size of the non-object value that is stored inline in the parameter. */
+static const size_t kEDOParameterInlineCapacity = 32;
+
+/**
+ * The scalar types that are tagged by their indexes plus one, so their type encodings and sizes are
+ * known without parsing the type encodings.
+ */
+static const char kEDOScalarTypes[] = {
+    _C_BOOL, _C_CHR,  _C_UCHR,    _C_SHT,      _C_USHT, _C_INT, _C_UINT,
+    _C_LNG,  _C_ULNG, _C_LNG_LNG, _C_ULNG_LNG, _C_FLT,  _C_DBL,
+};
+/** The type encodings of @c kEDOScalarTypes. */
+static NSString *const kEDOScalarTypeEncodings[] = {
+    @"B", @"c", @"C", @"s", @"S", @"i", @"I", @"l", @"L", @"q", @"Q", @"f", @"d",
+};
+/** The sizes of @c kEDOScalarTypes. */
+static const uint8_t kEDOScalarTypeSizes[] = {1, 1, 1, 2, 2, 4, 4, 4, 4, 8, 8, 4, 8};
+/** The number of @c kEDOScalarTypes. */
+static const uint8_t kEDOScalarTypeCount = sizeof(kEDOScalarTypes);
+/** The tag of the parameter that isn't a scalar. */
+static const uint8_t kEDOScalarTagNone = 0;
+/** The tag in the binary coding for the parameter that stores the non-scalar value inline. */
+static const uint8_t kEDOScalarTagInline = 0xFF;
+
+/** The smallest integer that is preboxed for each integer scalar type. */
+static const int64_t kEDOPreboxedIntegerMin = -1;
+/** The largest integer that is preboxed for each integer scalar type. */
+static const int64_t kEDOPreboxedIntegerMax = 15;
+
+/** Returns the tag of the scalar @c objCType, or @c kEDOScalarTagNone if it isn't a scalar. */
+static uint8_t EDOGetScalarTag(const char *objCType) {
+  if (objCType[0] == '\0' || objCType[1] != '\0') {
+    return kEDOScalarTagNone;
+  }
+  for (uint8_t index = 0; index < kEDOScalarTypeCount; ++index) {
+    if (kEDOScalarTypes[index] == objCType[0]) {
+      return index + 1;
+    }
+  }
+  return kEDOScalarTagNone;
+}
+
+/**
+ * Reads the integer of the scalar type of the @c tag from the @c bytes, which may not be aligned.
+ *
+ * @return @c NO if the scalar type isn't an integer type.
+ */
+static BOOL EDOGetScalarInteger(uint8_t tag, const void *bytes, int64_t *integer) {
+  char type = kEDOScalarTypes[tag - 1];
+  if (type == _C_FLT || type == _C_DBL) {
+    return NO;
+  }
+  BOOL isSigned = type == _C_CHR || type == _C_SHT || type == _C_INT || type == _C_LNG ||
+                  type == _C_LNG_LNG;
+  uint8_t size = kEDOScalarTypeSizes[tag - 1];
+  uint64_t value = 0;
+  // The scalars are little-endian, so their bytes are the lower bytes of the 64-bit value.
+  memcpy(&value, bytes, size);
+  value = OSSwapLittleToHostInt64(value);
+  if (isSigned && size < sizeof(value)) {
+    uint64_t signBit = 1ULL << (size * 8 - 1);
+    value = (value ^ signBit) - signBit;
+  }
+  if (!isSigned && value > INT64_MAX) {
+    value = INT64_MAX;
+  }
+  *integer = (int64_t)value;
+  return YES;
+}
+
 #pragma mark -
 
 /** The placeholder type to save the NULL pointer that points to an object. */
@@ -49,12 +120,67 @@ static NSString *const kEDOParameterCoderTypeKey = @"type";
 
 #pragma mark -
 
-@implementation EDOParameter
+@interface EDOParameter () <EDOMessageCoding>
+/** Initializes the parameter with the non-object value stored inline. */
+- (instancetype)initWithInlineBytes:(const void *)bytes
+                             length:(size_t)length
+                           objCType:(NSString *)objCType
+                          scalarTag:(uint8_t)scalarTag;
+@end
+
+@implementation EDOParameter {
+  // The boxed object, or the data of the non-object value that isn't stored inline.
+  id<NSCoding> _value;
+  // The tag of the scalar type, or kEDOScalarTagNone if the value isn't a scalar.
+  uint8_t _scalarTag;
+  // The length of the non-object value stored inline, or 0 if the value isn't stored inline.
+  uint8_t _inlineLength;
+  // The bytes of the non-object value stored inline.
+  uint8_t _inlineBytes[kEDOParameterInlineCapacity];
+}
 
 + (BOOL)supportsSecureCoding {
   return YES;
 }
 
+/**
+ * Returns the parameter of the integer scalar that is preboxed, or nil if it's not preboxed.
+ *
+ * The small integers and booleans are passed far more often than the others, so their parameters
+ * are created once and shared.
+ */
++ (nullable instancetype)edo_preboxedParameterWithScalarTag:(uint8_t)scalarTag
+                                                      bytes:(const void *)bytes {
+  static NSArray<NSArray<EDOParameter *> *> *preboxedParameters;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableArray<NSArray<EDOParameter *> *> *parameters = [[NSMutableArray alloc] init];
+    for (uint8_t tag = 1; tag <= kEDOScalarTypeCount; ++tag) {
+      NSMutableArray<EDOParameter *> *tagParameters = [[NSMutableArray alloc] init];
+      int64_t zero = 0, integer;
+      if (EDOGetScalarInteger(tag, &zero, &integer)) {
+        for (int64_t value = kEDOPreboxedIntegerMin; value <= kEDOPreboxedIntegerMax; ++value) {
+          int64_t littleEndianValue = (int64_t)OSSwapHostToLittleInt64((uint64_t)value);
+          [tagParameters
+              addObject:[[self alloc] initWithInlineBytes:&littleEndianValue
+                                                   length:kEDOScalarTypeSizes[tag - 1]
+                                                 objCType:kEDOScalarTypeEncodings[tag - 1]
+                                                scalarTag:tag]];
+        }
+      }
+      [parameters addObject:tagParameters];
+    }
+    preboxedParameters = parameters;
+  });
+
+  int64_t integer;
+  if (!EDOGetScalarInteger(scalarTag, bytes, &integer) || integer < kEDOPreboxedIntegerMin ||
+      integer > kEDOPreboxedIntegerMax) {
+    return nil;
+  }
+  return preboxedParameters[scalarTag - 1][integer - kEDOPreboxedIntegerMin];
+}
+
 + (instancetype)parameterWithValue:(id<NSCoding>)value objCType:(NSString *)objCType {
   return [[self alloc] initWithValue:value objCType:objCType];
 }
@@ -66,12 +192,68 @@ static NSString *const kEDOParameterCoderTypeKey = @"type";
   } else if (EDO_IS_SELECTOR(objCType)) {
     SEL selector = *(SEL *)bytes;
     return [self parameterWithValue:NSStringFromSelector(selector) objCType:kObjCSelectorType];
-  } else {
-    NSUInteger typeSize = 0L;
+  } else if (!bytes) {
+    return [self parameterWithValue:nil objCType:[NSString stringWithUTF8String:objCType]];
+  }
+
+  NSUInteger typeSize = 0L;
+  uint8_t scalarTag = EDOGetScalarTag(objCType);
+  if (scalarTag == kEDOScalarTagNone) {
     NSGetSizeAndAlignment(objCType, &typeSize, NULL);
-    return [self parameterWithValue:(bytes ? [NSData dataWithBytes:bytes length:typeSize] : nil)
-                           objCType:[NSString stringWithUTF8String:objCType]];
   }
+  return [self edo_parameterWithBytes:bytes
+                             objCType:objCType
+                            scalarTag:scalarTag
+                                 size:typeSize
+                         typeEncoding:nil];
+}
+
++ (instancetype)parameterWithBytes:(void *)bytes
+                          objCType:(const char *)objCType
+                              size:(NSUInteger)size
+                      typeEncoding:(NSString *)typeEncoding {
+  if (EDO_IS_SELECTOR(objCType)) {
+    return [self parameterWithBytes:bytes objCType:objCType];
+  }
+  return [self edo_parameterWithBytes:bytes
+                             objCType:objCType
+                            scalarTag:EDOGetScalarTag(objCType)
+                                 size:size
+                         typeEncoding:typeEncoding];
+}
+
+/**
+ * Creates the parameter of the value that is neither an object nor a selector.
+ *
+ * @param bytes        The buffer of the value.
+ * @param objCType     The type encoding of the value.
+ * @param scalarTag    The tag of the scalar type, or @c kEDOScalarTagNone.
+ * @param size         The size of the value, which is only used if it isn't a scalar.
+ * @param typeEncoding The @c objCType as a string, or @c nil to create it only if it isn't a
+ *                     scalar.
+ */
++ (instancetype)edo_parameterWithBytes:(const void *)bytes
+                              objCType:(const char *)objCType
+                             scalarTag:(uint8_t)scalarTag
+                                  size:(NSUInteger)size
+                          typeEncoding:(nullable NSString *)typeEncoding {
+  if (scalarTag != kEDOScalarTagNone) {
+    EDOParameter *parameter = [self edo_preboxedParameterWithScalarTag:scalarTag bytes:bytes];
+    return parameter ?: [[self alloc] initWithInlineBytes:bytes
+                                                   length:kEDOScalarTypeSizes[scalarTag - 1]
+                                                 objCType:kEDOScalarTypeEncodings[scalarTag - 1]
+                                                scalarTag:scalarTag];
+  }
+
+  typeEncoding = typeEncoding ?: [NSString stringWithUTF8String:objCType];
+  if (size > 0 && size <= kEDOParameterInlineCapacity) {
+    return [[self alloc] initWithInlineBytes:bytes
+                                      length:size
+                                    objCType:typeEncoding
+                                   scalarTag:kEDOScalarTagNone];
+  }
+  return [self parameterWithValue:[NSData dataWithBytes:bytes length:size]
+                         objCType:typeEncoding];
 }
 
 + (instancetype)parameterWithObject:(id<NSCoding>)object {
@@ -120,16 +302,99 @@ static NSString *const kEDOParameterCoderTypeKey = @"type";
   return self;
 }
 
+- (instancetype)initWithInlineBytes:(const void *)bytes
+                             length:(size_t)length
+                           objCType:(NSString *)objCType
+                          scalarTag:(uint8_t)scalarTag {
+  self = [super init];
+  if (self) {
+    NSAssert(length > 0 && length <= kEDOParameterInlineCapacity, @"The value is too large.");
+    memcpy(_inlineBytes, bytes, length);
+    _inlineLength = (uint8_t)length;
+    _scalarTag = scalarTag;
+    _valueObjCType = objCType;
+  }
+  return self;
+}
+
 - (void)encodeWithCoder:(NSCoder *)aCoder {
   [aCoder encodeObject:self.value forKey:kEDOParameterCoderValueKey];
   [aCoder encodeObject:self.valueObjCType forKey:kEDOParameterCoderTypeKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  uint8_t scalarTag = *(const uint8_t *)[decoder decodeBytesWithLength:1];
+  if (scalarTag == kEDOScalarTagNone) {
+    self = [super init];
+    if (self) {
+      _value = [decoder decodeObject];
+      _valueObjCType = [decoder decodeInternedString];
+    }
+    return self;
+  } else if (scalarTag == kEDOScalarTagInline) {
+    NSString *objCType = [decoder decodeInternedString];
+    uint8_t length = *(const uint8_t *)[decoder decodeBytesWithLength:1];
+    if (!objCType || length == 0 || length > kEDOParameterInlineCapacity) {
+      [[NSException exceptionWithName:NSInvalidUnarchiveOperationException
+                               reason:@"The inline value of the parameter is malformed."
+                             userInfo:nil] raise];
+    }
+    return [self initWithInlineBytes:[decoder decodeBytesWithLength:length]
+                              length:length
+                            objCType:objCType
+                           scalarTag:kEDOScalarTagNone];
+  } else if (scalarTag > kEDOScalarTypeCount) {
+    [[NSException exceptionWithName:NSInvalidUnarchiveOperationException
+                             reason:@"The scalar type of the parameter is unknown."
+                           userInfo:nil] raise];
+  }
+
+  const void *bytes = [decoder decodeBytesWithLength:kEDOScalarTypeSizes[scalarTag - 1]];
+  EDOParameter *parameter = [EDOParameter edo_preboxedParameterWithScalarTag:scalarTag
+                                                                       bytes:bytes];
+  if (parameter) {
+    return parameter;
+  }
+  return [self initWithInlineBytes:bytes
+                            length:kEDOScalarTypeSizes[scalarTag - 1]
+                          objCType:kEDOScalarTypeEncodings[scalarTag - 1]
+                         scalarTag:scalarTag];
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  // The scalars are encoded by their tags followed by their bytes, the other inline values by their
+  // type encodings and bytes, and the rest by their objects and type encodings.
+  if (_scalarTag != kEDOScalarTagNone) {
+    [encoder encodeBytes:&_scalarTag length:1];
+    [encoder encodeBytes:_inlineBytes length:_inlineLength];
+  } else if (_inlineLength > 0) {
+    uint8_t tag = kEDOScalarTagInline;
+    [encoder encodeBytes:&tag length:1];
+    [encoder encodeInternedString:self.valueObjCType];
+    [encoder encodeBytes:&_inlineLength length:1];
+    [encoder encodeBytes:_inlineBytes length:_inlineLength];
+  } else {
+    uint8_t tag = kEDOScalarTagNone;
+    [encoder encodeBytes:&tag length:1];
+    [encoder encodeObject:_value];
+    [encoder encodeInternedString:self.valueObjCType];
+  }
+}
+
+- (id<NSCoding>)value {
+  // The inline value is boxed on demand, e.g. for NSKeyedArchiver.
+  return _inlineLength > 0 ? [NSData dataWithBytes:_inlineBytes length:_inlineLength] : _value;
+}
+
 - (char const *)objCType {
   return self.valueObjCType.UTF8String;
 }
 
 - (void)getValue:(void *)buffer {
+  if (_inlineLength > 0) {
+    memcpy(buffer, _inlineBytes, _inlineLength);
+    return;
+  }
   char const *ctype = self.objCType;
   if (EDO_IS_OBJECT_OR_CLASS(ctype)) {
     NSAssert(sizeof(id) == sizeof(Class), @"The buffer is not suitable for both Id and Class.");
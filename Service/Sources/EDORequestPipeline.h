@@ -0,0 +1,85 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Channel/Sources/EDOChannel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class EDOServiceRequest;
+@class EDOServiceResponse;
+
+/**
+ * The handler of the response to a request sent on the pipeline.
+ *
+ * @param response The response to the request, or @c nil if the pipeline fails before the response
+ *                 is received.
+ */
+typedef void (^EDORequestPipelineResponseHandler)(EDOServiceResponse *_Nullable response);
+
+/**
+ * The pipeline of the requests sent on one channel without waiting for their responses.
+ *
+ * A request is written as soon as it's sent, even if the responses to the earlier requests haven't
+ * been received yet. The service sends the response as soon as the request completes, and pings the
+ * request only if it runs longer than the service's ping delay, so the responses are matched to
+ * their requests by the message IDs rather than by their order.
+ *
+ * The pipeline fails all its pending requests if the channel closes, or if nothing is received
+ * within the ping timeout after a request is sent while the service isn't busy with an earlier
+ * request of the pipeline, and it can't be used after that.
+ */
+@interface EDORequestPipeline : NSObject
+
+/** The channel that the requests are sent on, which is owned by the pipeline. */
+@property(readonly) id<EDOChannel> channel;
+/** Whether the pipeline can send requests. */
+@property(readonly, getter=isValid) BOOL valid;
+/** The number of requests that are waiting for their responses. */
+@property(readonly) NSUInteger numberOfPendingRequests;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Initializes the pipeline with the connected channel.
+ *
+ * @param channel     The channel to send the requests on, which is not shared with anyone else.
+ * @param pingTimeout The timeout in nanoseconds for the service to ping or answer a request.
+ */
+- (instancetype)initWithChannel:(id<EDOChannel>)channel
+                    pingTimeout:(int64_t)pingTimeout NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Sends the request without waiting for the response to the earlier requests.
+ *
+ * @param request      The request to send.
+ * @param binaryCoding Whether to encode the request in the binary coding.
+ * @param handler      The handler to be invoked on an arbitrary queue with the response.
+ *
+ * @return @c YES if the request is sent; @c NO if the pipeline is invalid, in which case the
+ *         @c handler is not invoked.
+ */
+- (BOOL)sendRequest:(EDOServiceRequest *)request
+         binaryCoding:(BOOL)binaryCoding
+    completionHandler:(EDORequestPipelineResponseHandler)handler;
+
+/** Invalidates the channel, failing the pending requests. */
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
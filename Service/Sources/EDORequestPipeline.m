@@ -0,0 +1,234 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import "Service/Sources/EDORequestPipeline.h"
+
+#import "Service/Sources/EDOClientService+Private.h"
+#import "Service/Sources/EDOMessageCoder.h"
+#import "Service/Sources/EDOServiceRequest.h"
+
+@implementation EDORequestPipeline {
+  // The timeout in nanoseconds for the service to ping or answer a request.
+  int64_t _pingTimeout;
+  // The tables of the strings interned for the requests and the responses on the channel.
+  EDOMessageInternTable *_sendingInternTable;
+  EDOMessageInternTable *_receivingInternTable;
+  // The handlers of the pending requests by their message IDs.
+  NSMutableDictionary<NSNumber *, EDORequestPipelineResponseHandler> *_handlers;
+  // The indexes of the pending requests in the order they are sent by their message IDs.
+  NSMutableDictionary<NSNumber *, NSNumber *> *_requestIndexes;
+  // The indexes of the pending requests.
+  NSMutableIndexSet *_pendingRequestIndexes;
+  // The number of the requests sent, and the pings and the responses received.
+  NSUInteger _numberOfRequests;
+  uint64_t _numberOfReceivedMessages;
+  BOOL _valid;
+}
+
+- (instancetype)initWithChannel:(id<EDOChannel>)channel pingTimeout:(int64_t)pingTimeout {
+  self = [super init];
+  if (self) {
+    _channel = channel;
+    _pingTimeout = pingTimeout;
+    // The channel may come from the pool after the synchronous requests, and the service keeps
+    // interning the strings where they left off, so the pipeline continues with their tables.
+    _sendingInternTable = [EDOClientService internTableForChannel:channel sending:YES];
+    _receivingInternTable = [EDOClientService internTableForChannel:channel sending:NO];
+    _handlers = [[NSMutableDictionary alloc] init];
+    _requestIndexes = [[NSMutableDictionary alloc] init];
+    _pendingRequestIndexes = [[NSMutableIndexSet alloc] init];
+    _valid = YES;
+    [self edo_receiveNextMessage];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [_channel invalidate];
+}
+
+- (BOOL)isValid {
+  @synchronized(self) {
+    return _valid;
+  }
+}
+
+- (NSUInteger)numberOfPendingRequests {
+  @synchronized(self) {
+    return _handlers.count;
+  }
+}
+
+- (BOOL)sendRequest:(EDOServiceRequest *)request
+         binaryCoding:(BOOL)binaryCoding
+    completionHandler:(EDORequestPipelineResponseHandler)handler {
+  NSUInteger requestIndex;
+  uint64_t numberOfReceivedMessages;
+  @synchronized(self) {
+    if (!_valid) {
+      return NO;
+    }
+    // The requests are encoded in the order they are written, so the service interns the strings
+    // in the same order.
+    NSData *requestData = [EDOMessageCoder dataWithMessage:request
+                                              binaryCoding:binaryCoding
+                                               internTable:_sendingInternTable];
+    requestIndex = ++_numberOfRequests;
+    numberOfReceivedMessages = _numberOfReceivedMessages;
+    _handlers[@(request.messageID)] = [handler copy];
+    _requestIndexes[@(request.messageID)] = @(requestIndex);
+    [_pendingRequestIndexes addIndex:requestIndex];
+    [_channel sendData:requestData withCompletionHandler:nil];
+  }
+  [self edo_checkRequestAtIndex:requestIndex numberOfReceivedMessages:numberOfReceivedMessages];
+  return YES;
+}
+
+- (void)invalidate {
+  NSArray<EDORequestPipelineResponseHandler> *handlers;
+  @synchronized(self) {
+    _valid = NO;
+    handlers = _handlers.allValues;
+    [_handlers removeAllObjects];
+    [_requestIndexes removeAllObjects];
+    [_pendingRequestIndexes removeAllIndexes];
+  }
+  [_channel invalidate];
+  for (EDORequestPipelineResponseHandler handler in handlers) {
+    handler(nil);
+  }
+}
+
+#pragma mark - Private
+
+/** Receives the next ping or response on the channel until the pipeline is invalidated. */
+- (void)edo_receiveNextMessage {
+  __weak EDORequestPipeline *weakSelf = self;
+  [_channel receiveDataWithQueue:dispatch_get_global_queue(qos_class_self(), 0)
+                         handler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+                           EDORequestPipeline *strongSelf = weakSelf;
+                           if ([strongSelf edo_handleReceivedData:data]) {
+                             [strongSelf edo_receiveNextMessage];
+                           }
+                         }];
+}
+
+/**
+ * Handles the ping or the response received on the channel.
+ *
+ * @param data The received data, or @c nil if the channel is closed.
+ * @return @c YES if the pipeline continues to receive; @c NO if it's invalidated.
+ */
+- (BOOL)edo_handleReceivedData:(NSData *)data {
+  if (!data) {
+    [self invalidate];
+    return NO;
+  }
+  if ([data isEqualToData:EDOClientService.pingMessageData]) {
+    @synchronized(self) {
+      ++_numberOfReceivedMessages;
+    }
+    return YES;
+  }
+
+  // The responses are decoded in the order they are received, the same order as the service
+  // encodes them. The malformed response can't be matched to its request, and the later ones
+  // can't be decoded after it, so it fails all the pending requests below.
+  EDOServiceResponse *response;
+  @try {
+    response = [EDOMessageCoder messageWithData:data internTable:_receivingInternTable];
+  } @catch (NSException *exception) {
+    NSLog(@"The edo channel %@ receives a malformed response: %@", _channel, exception);
+  }
+  EDORequestPipelineResponseHandler handler;
+  if (response) {
+    @synchronized(self) {
+      ++_numberOfReceivedMessages;
+      NSNumber *messageID = @(response.messageID);
+      handler = _handlers[messageID];
+      [_handlers removeObjectForKey:messageID];
+      [_pendingRequestIndexes removeIndex:_requestIndexes[messageID].unsignedIntegerValue];
+      [_requestIndexes removeObjectForKey:messageID];
+    }
+  }
+  if (handler) {
+    handler(response);
+    return YES;
+  }
+
+  // The service replies with an error that doesn't match any request if it can't decode the
+  // request, and it stops receiving on the channel, so the error fails all the pending requests.
+  NSArray<EDORequestPipelineResponseHandler> *handlers;
+  @synchronized(self) {
+    _valid = NO;
+    handlers = _handlers.allValues;
+    [_handlers removeAllObjects];
+    [_requestIndexes removeAllObjects];
+    [_pendingRequestIndexes removeAllIndexes];
+  }
+  [_channel invalidate];
+  for (EDORequestPipelineResponseHandler pendingHandler in handlers) {
+    pendingHandler([response isKindOfClass:[EDOErrorResponse class]] ? response : nil);
+  }
+  return NO;
+}
+
+/**
+ * Checks that the service is alive within the ping timeout after the request is sent.
+ *
+ * The service pings the request only if it doesn't complete within the service's ping delay, and
+ * the pings don't tell which requests they are for, so the service is considered alive if any ping
+ * or response is received after the request is sent; the request may run for any time afterwards.
+ * If nothing is received in time, but an earlier request is still pending, the service may not
+ * read the request until the earlier one completes, so the check is deferred, and the earliest
+ * pending request is the one to detect the broken channel.
+ *
+ * @param requestIndex             The index of the request in the order it's sent, starting from 1.
+ * @param numberOfReceivedMessages The number of the pings and the responses received before the
+ *                                 check starts.
+ */
+- (void)edo_checkRequestAtIndex:(NSUInteger)requestIndex
+       numberOfReceivedMessages:(uint64_t)numberOfReceivedMessages {
+  __weak EDORequestPipeline *weakSelf = self;
+  dispatch_time_t timeout = dispatch_time(DISPATCH_TIME_NOW, _pingTimeout);
+  dispatch_after(timeout, dispatch_get_global_queue(qos_class_self(), 0), ^{
+    EDORequestPipeline *strongSelf = weakSelf;
+    if (!strongSelf) {
+      return;
+    }
+    BOOL serviceBusy;
+    uint64_t currentNumberOfReceivedMessages;
+    @synchronized(strongSelf) {
+      currentNumberOfReceivedMessages = strongSelf->_numberOfReceivedMessages;
+      if (!strongSelf->_valid ||
+          ![strongSelf->_pendingRequestIndexes containsIndex:requestIndex] ||
+          currentNumberOfReceivedMessages > numberOfReceivedMessages) {
+        return;
+      }
+      NSRange earlierRange = NSMakeRange(0, requestIndex);
+      serviceBusy = [strongSelf->_pendingRequestIndexes countOfIndexesInRange:earlierRange] > 0;
+    }
+    if (serviceBusy) {
+      [strongSelf edo_checkRequestAtIndex:requestIndex
+                 numberOfReceivedMessages:currentNumberOfReceivedMessages];
+    } else {
+      NSLog(@"The edo channel %@ is broken.", strongSelf.channel);
+      [strongSelf invalidate];
+    }
+  });
+}
+
+@end
@@ -26,7 +26,7 @@ FOUNDATION_EXPORT NSErrorDomain const EDOServiceErrorDomain;
 NS_ERROR_ENUM(EDOServiceErrorDomain){
     EDOServiceErrorCannotConnect = -1000, EDOServiceErrorConnectTimeout,
     EDOServiceErrorRequestNotHandled,     EDOServiceErrorNamingServiceUnavailable,
-    EDOServiceErrorSwiftErrorThrow,
+    EDOServiceErrorSwiftErrorThrow,       EDOServiceErrorDeadlineExceeded,
 };
 
 /** Key in userInfo, the value is an NSString describing the request being sent. */
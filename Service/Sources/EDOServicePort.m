@@ -17,11 +17,15 @@
 #import "Service/Sources/EDOServicePort.h"
 
 #import "Channel/Sources/EDOHostPort.h"
+#import "Service/Sources/EDOMessageCoder.h"
 
 static NSString *const EDOServicePortCoderPortKey = @"port";
 static NSString *const EDOServiceHostPortCoderPortKey = @"hostPort";
 static NSString *const EDOServicePortCoderUUIDKey = @"uuid";
 
+@interface EDOServicePort () <EDOMessageCoding>
+@end
+
 @implementation EDOServicePort {
   uuid_t _serviceKey;
 }
@@ -86,6 +90,22 @@ static NSString *const EDOServicePortCoderUUIDKey = @"uuid";
   [aCoder encodeBytes:_serviceKey length:sizeof(_serviceKey) forKey:EDOServicePortCoderUUIDKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super init];
+  if (self) {
+    _port = (UInt16)[decoder decodeInt64];
+    _hostPort = [decoder decodeObject];
+    uuid_copy(_serviceKey, [decoder decodeBytesWithLength:sizeof(_serviceKey)]);
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [encoder encodeInt64:self.port];
+  [encoder encodeObject:self.hostPort];
+  [encoder encodeBytes:_serviceKey length:sizeof(_serviceKey)];
+}
+
 - (BOOL)match:(EDOServicePort *)otherPort {
   if (!otherPort) {
     return NO;
@@ -47,7 +47,16 @@ typedef EDOServiceResponse *_Nonnull (^EDORequestHandler)(EDOServiceRequest *req
  */
 @property(readonly, class) EDORequestHandler requestHandler;
 
-- (instancetype)initWithMessageID:(NSString *)messageID NS_UNAVAILABLE;
+/**
+ * The time in seconds left for the service to handle the request, or 0 if the request has no
+ * deadline.
+ *
+ * The client sets it from the deadline of the invocation when the request is sent. The older
+ * clients don't send it, and the older services ignore it.
+ */
+@property(nonatomic) NSTimeInterval remainingTime;
+
+- (instancetype)initWithMessageID:(EDOMessageID)messageID NS_UNAVAILABLE;
 
 /**
  * Checks if the request matches the @c port.
@@ -69,6 +78,12 @@ typedef EDOServiceResponse *_Nonnull (^EDORequestHandler)(EDOServiceRequest *req
 /** Time spent in seconds to generate the response. */
 @property(nonatomic) double duration;
 
+/**
+ * Whether the service that sends the response decodes the requests in the binary coding of
+ * @c EDOMessageCoder, which the older services don't advertise.
+ */
+@property(nonatomic, readonly) BOOL binaryCodingSupported;
+
 - (instancetype)init NS_UNAVAILABLE;
 
 @end
@@ -86,15 +101,18 @@ typedef EDOServiceResponse *_Nonnull (^EDORequestHandler)(EDOServiceRequest *req
 + (instancetype)unhandledErrorResponseForRequest:(EDOServiceRequest *)request;
 
 - (instancetype)init NS_UNAVAILABLE;
-- (instancetype)initWithMessageID:(NSString *)messageID NS_UNAVAILABLE;
+- (instancetype)initWithMessageID:(EDOMessageID)messageID NS_UNAVAILABLE;
 
 /** Initializes the response with an @c NSError. */
-- (instancetype)initWithMessageID:(NSString *)messageID
+- (instancetype)initWithMessageID:(EDOMessageID)messageID
                             error:(NSError *)error NS_DESIGNATED_INITIALIZER;
 
 /** @see -[NSCoding initWithCoder:]. */
 - (instancetype)initWithCoder:(NSCoder *)aDecoder NS_DESIGNATED_INITIALIZER;
 
+/** @see -[EDOMessageCoding initWithMessageDecoder:]. */
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder NS_DESIGNATED_INITIALIZER;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -19,8 +19,10 @@
 #import "Service/Sources/EDOMessage.h"
 #import "Service/Sources/EDOServiceError.h"
 
+static NSString *const kEDOServiceRequestRemainingTimeKey = @"remainingTime";
 static NSString *const kEDOServiceResponseErrorKey = @"error";
 static NSString *const kEDOServiceResponseDurationKey = @"duration";
+static NSString *const kEDOServiceResponseBinaryCodingKey = @"binaryCoding";
 
 @implementation EDOServiceRequest
 
@@ -39,6 +41,35 @@ static NSString *const kEDOServiceResponseDurationKey = @"duration";
   return YES;
 }
 
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+  self = [super initWithCoder:aDecoder];
+  if (self) {
+    // The older clients don't encode the key, which is decoded as no deadline.
+    _remainingTime = [aDecoder decodeDoubleForKey:kEDOServiceRequestRemainingTimeKey];
+  }
+  return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+  [super encodeWithCoder:aCoder];
+  if (self.remainingTime > 0) {
+    [aCoder encodeDouble:self.remainingTime forKey:kEDOServiceRequestRemainingTimeKey];
+  }
+}
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _remainingTime = [decoder decodeDouble];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeDouble:self.remainingTime];
+}
+
 @end
 
 @implementation EDOServiceResponse
@@ -51,6 +82,8 @@ static NSString *const kEDOServiceResponseDurationKey = @"duration";
   self = [super initWithCoder:aDecoder];
   if (self) {
     _duration = [aDecoder decodeDoubleForKey:kEDOServiceResponseDurationKey];
+    // The older services don't encode the key, which is decoded as NO.
+    _binaryCodingSupported = [aDecoder decodeBoolForKey:kEDOServiceResponseBinaryCodingKey];
   }
   return self;
 }
@@ -58,6 +91,21 @@ static NSString *const kEDOServiceResponseDurationKey = @"duration";
 - (void)encodeWithCoder:(NSCoder *)aCoder {
   [super encodeWithCoder:aCoder];
   [aCoder encodeDouble:self.duration forKey:kEDOServiceResponseDurationKey];
+  [aCoder encodeBool:YES forKey:kEDOServiceResponseBinaryCodingKey];
+}
+
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _duration = [decoder decodeDouble];
+    _binaryCodingSupported = YES;
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeDouble:self.duration];
 }
 
 @end
@@ -82,7 +130,7 @@ static NSString *const kEDOServiceResponseDurationKey = @"duration";
   return [self errorResponse:unhandledError forRequest:request];
 }
 
-- (instancetype)initWithMessageID:(NSString *)messageID error:(NSError *)error {
+- (instancetype)initWithMessageID:(EDOMessageID)messageID error:(NSError *)error {
   self = [super initWithMessageID:messageID];
   if (self) {
     _error = error;
@@ -103,4 +151,17 @@ static NSString *const kEDOServiceResponseDurationKey = @"duration";
   [aCoder encodeObject:self.error forKey:kEDOServiceResponseErrorKey];
 }
 
+- (instancetype)initWithMessageDecoder:(EDOMessageDecoder *)decoder {
+  self = [super initWithMessageDecoder:decoder];
+  if (self) {
+    _error = [decoder decodeObject];
+  }
+  return self;
+}
+
+- (void)encodeWithMessageEncoder:(EDOMessageEncoder *)encoder {
+  [super encodeWithMessageEncoder:encoder];
+  [encoder encodeObject:self.error];
+}
+
 @end
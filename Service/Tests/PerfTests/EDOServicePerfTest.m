@@ -16,7 +16,12 @@
 
 #import <XCTest/XCTest.h>
 
+#include <sys/socket.h>
+
+#import "Channel/Sources/EDOBufferPool.h"
 #import "Channel/Sources/EDOHostPort.h"
+#import "Channel/Sources/EDOSocket.h"
+#import "Channel/Sources/EDOSocketChannel.h"
 #import "Service/Sources/EDOClientService.h"
 #import "Service/Sources/EDOHostService+Private.h"
 #import "Service/Sources/EDOHostService.h"
@@ -132,6 +137,20 @@ static const size_t kNumOfBenchmarkExecutions = 100;
                                }];
 }
 
+- (void)testMethodWithManyArgumentsLotsTimes {
+  // The arguments are parsed once per method signature, so each call only copies their values.
+  [self assertPerformBlockWithWeight:1
+                               block:^(EDOTestDummy *remoteDummy) {
+                                 NSError *error;
+                                 [remoteDummy returnSumWithInt:1
+                                                     longValue:2
+                                                   doubleValue:3
+                                                   dummyStruct:(EDOTestDummyStruct){.value = 4}
+                                                        number:@5
+                                                      errorOut:&error];
+                               }];
+}
+
 - (void)testMethodWithOutVarLotsTimes {
   [self assertPerformBlockWithWeight:1
                                block:^(EDOTestDummy *remoteDummy) {
@@ -157,6 +176,90 @@ static const size_t kNumOfBenchmarkExecutions = 100;
                                }];
 }
 
+- (void)testMethodWithLargeDataReturnLotsTimes {
+  // The 4MB payload is delivered to the decoder as it is read, and it is only copied once if the
+  // regions read are discontiguous.
+  size_t payloadSize = 4 << 20;
+  NSInteger executions = 10;
+  self.rootObject.value = (int)payloadSize;
+  EDOBufferPool *pool = EDOBufferPool.sharedPool;
+  uint64_t copiedBytes = pool.copiedBytes;
+  uint64_t dispatchDataCount = pool.dispatchDataCount;
+  [self assertPerformBlockWithWeight:4
+                          executions:executions
+                               block:^(EDOTestDummy *remoteDummy) {
+                                 [remoteDummy returnData];
+                               }];
+
+  // Each call receives at least the request and the response frames, and only the response is
+  // large enough to be read in multiple regions.
+  uint64_t frameCount = pool.dispatchDataCount - dispatchDataCount;
+  uint64_t totalCopiedBytes = pool.copiedBytes - copiedBytes;
+  XCTAssertGreaterThanOrEqual(frameCount, 2 * (uint64_t)executions);
+  NSLog(@"%llu bytes are copied per frame for %llu frames.",
+        totalCopiedBytes / MAX(frameCount, 1), frameCount);
+  XCTAssertLessThanOrEqual(totalCopiedBytes / (uint64_t)executions, payloadSize + (64 << 10));
+}
+
+- (void)testSimpleMethodOverLocalSocketLotsTimes {
+  uint64_t tcpResult = [self assertPerformBlockWithWeight:1
+                                                    block:^(EDOTestDummy *remoteDummy) {
+                                                      [remoteDummy voidWithValuePlusOne];
+                                                    }];
+
+  // The new service also listens on the UNIX domain socket, which the client connects to first.
+  EDOHostService.listensOnLocalSocket = YES;
+  EDOHostService *localService = [EDOHostService serviceWithPort:0
+                                                      rootObject:self.rootObject
+                                                           queue:self.executionQueue];
+  EDOHostService.listensOnLocalSocket = NO;
+  EDOTestDummy *localDummy = [EDOClientService rootObjectWithPort:localService.port.hostPort.port];
+  uint64_t localResult = dispatch_benchmark(kNumOfBenchmarkExecutions, ^{
+    [localDummy voidWithValuePlusOne];
+  });
+  [localService invalidate];
+
+  NSLog(@"The round trip takes %llu ns over TCP and %llu ns over the UNIX domain socket.",
+        tcpResult, localResult);
+  XCTAssertLessThan(localResult, kRemoteInvocationThresholdInNano);
+}
+
+- (void)testSimpleMethodOverSharedMemoryLotsTimes {
+  uint64_t tcpResult = [self assertPerformBlockWithWeight:1
+                                                    block:^(EDOTestDummy *remoteDummy) {
+                                                      [remoteDummy voidWithValuePlusOne];
+                                                    }];
+
+  // The new service also accepts the shared memory channels, which the client prefers.
+  EDOHostService.listensOnSharedMemory = YES;
+  EDOHostService *sharedMemoryService = [EDOHostService serviceWithPort:0
+                                                             rootObject:self.rootObject
+                                                                  queue:self.executionQueue];
+  EDOHostService.listensOnSharedMemory = NO;
+  EDOTestDummy *sharedMemoryDummy =
+      [EDOClientService rootObjectWithPort:sharedMemoryService.port.hostPort.port];
+  uint64_t sharedMemoryResult = dispatch_benchmark(kNumOfBenchmarkExecutions, ^{
+    [sharedMemoryDummy voidWithValuePlusOne];
+  });
+  [sharedMemoryService invalidate];
+
+  NSLog(@"The round trip takes %llu ns over TCP and %llu ns over the shared memory.", tcpResult,
+        sharedMemoryResult);
+  XCTAssertLessThan(sharedMemoryResult, kRemoteInvocationThresholdInNano);
+}
+
+- (void)testRoundTripsWithManyIdleChannels {
+  uint64_t dispatchIOResult = [self roundTripTimeWithIdleChannels:500 busyChannels:50];
+  EDOSocketChannel.usesSharedReactor = YES;
+  uint64_t reactorResult = [self roundTripTimeWithIdleChannels:500 busyChannels:50];
+  EDOSocketChannel.usesSharedReactor = NO;
+
+  NSLog(@"The round trips on 50 busy channels next to 500 idle ones take %llu ns with dispatch "
+        @"I/O and %llu ns with the shared reactor.",
+        dispatchIOResult, reactorResult);
+  XCTAssertLessThan(reactorResult, kRemoteInvocationThresholdInNano);
+}
+
 - (void)testComplicatedMethodLotsTimes {
   [self assertPerformBlockWithWeight:1
                                block:^(EDOTestDummy *remoteDummy) {
@@ -231,6 +334,60 @@ static const size_t kNumOfBenchmarkExecutions = 100;
   XCTAssertLessThan(byValueResult * 100, byReferenceResult);
 }
 
+/**
+ * Measures the time for a round trip on each of the busy channels at once, while the idle channels
+ * wait for the data that never comes.
+ */
+- (uint64_t)roundTripTimeWithIdleChannels:(NSUInteger)idleCount
+                             busyChannels:(NSUInteger)busyCount {
+  NSMutableArray<EDOSocketChannel *> *channels = [[NSMutableArray alloc] init];
+  NSMutableArray<EDOSocketChannel *> *busyChannels = [[NSMutableArray alloc] init];
+  for (NSUInteger i = 0; i < idleCount + busyCount; ++i) {
+    int sockets[2];
+    XCTAssertEqual(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    EDOSocketChannel *client =
+        [EDOSocketChannel channelWithSocket:[EDOSocket socketWithSocket:sockets[0]]];
+    EDOSocketChannel *host =
+        [EDOSocketChannel channelWithSocket:[EDOSocket socketWithSocket:sockets[1]]];
+    [channels addObject:client];
+    [channels addObject:host];
+    if (i < idleCount) {
+      [client receiveDataWithHandler:nil];
+      [host receiveDataWithHandler:nil];
+    } else {
+      [self echoOnChannel:host];
+      [busyChannels addObject:client];
+    }
+  }
+
+  NSData *data = [@"ping" dataUsingEncoding:NSUTF8StringEncoding];
+  uint64_t result = dispatch_benchmark(kNumOfBenchmarkExecutions, ^{
+    dispatch_group_t group = dispatch_group_create();
+    for (EDOSocketChannel *channel in busyChannels) {
+      dispatch_group_enter(group);
+      [channel sendData:data withCompletionHandler:nil];
+      [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+        dispatch_group_leave(group);
+      }];
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+  });
+  for (EDOSocketChannel *channel in channels) {
+    [channel invalidate];
+  }
+  return result;
+}
+
+/** Sends back the data received on the channel until it is closed. */
+- (void)echoOnChannel:(id<EDOChannel>)channel {
+  [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+    if (data) {
+      [channel sendData:data withCompletionHandler:nil];
+      [self echoOnChannel:channel];
+    }
+  }];
+}
+
 /**
  * Assert the block is performed within the @weight multiple of threshold.
  */
@@ -121,6 +121,12 @@ typedef EDOTestDummy * (^EDOMultiTypesHandler)(EDOTestDummyStruct, int, id, EDOT
 - (Class)classsWithClass:(Class)clz;
 - (NSNumber *)returnNumberWithInt:(int)arg value:(NSNumber *)value;
 - (BOOL)returnBoolWithError:(NSError **)errorOrNil;
+- (double)returnSumWithInt:(int)intValue
+                 longValue:(long)longValue
+               doubleValue:(double)doubleValue
+               dummyStruct:(EDOTestDummyStruct)dummyStruct
+                    number:(NSNumber *)number
+                  errorOut:(NSError **)errorOut;
 - (NSString *)returnClassNameWithObject:(id)object;
 - (NSInteger)returnCountWithArray:(NSArray *)value;
 - (NSInteger)returnSumWithArray:(NSArray *)value;
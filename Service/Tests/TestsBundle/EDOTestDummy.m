@@ -308,6 +308,18 @@ static const NSInteger kLargeArraySize = 1000;
   }
 }
 
+- (double)returnSumWithInt:(int)intValue
+                 longValue:(long)longValue
+               doubleValue:(double)doubleValue
+               dummyStruct:(EDOTestDummyStruct)dummyStruct
+                    number:(NSNumber *)number
+                  errorOut:(NSError **)errorOut {
+  if (errorOut) {
+    *errorOut = nil;
+  }
+  return intValue + longValue + doubleValue + dummyStruct.value + number.doubleValue + _value;
+}
+
 - (NSString *)returnClassNameWithObject:(id)object {
   return NSStringFromClass(object_getClass(object));
 }
@@ -49,6 +49,38 @@
   XCTAssertTrue(executed);
 }
 
+- (void)testExecutorHandlesBlocksAsynchronouslyInOrder {
+  dispatch_queue_t queue = [self testQueue];
+  EDOExecutor *executor = [[EDOExecutor alloc] initWithQueue:queue];
+  NSMutableArray<NSNumber *> *executedIndexes = [[NSMutableArray alloc] init];
+  XCTestExpectation *expectExecuted = [self expectationWithDescription:@"The blocks are executed."];
+  expectExecuted.expectedFulfillmentCount = 10;
+
+  // The queue is blocked until all the blocks are handled, so none of them is executed in place.
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  dispatch_async(queue, ^{
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+  });
+  for (int i = 0; i < 10; ++i) {
+    XCTAssertTrue([executor
+        handleBlockAsynchronously:^{
+          [executedIndexes addObject:@(i)];
+          [expectExecuted fulfill];
+        }
+                            error:nil]);
+  }
+  XCTAssertEqual(executedIndexes.count, 0);
+  dispatch_semaphore_signal(semaphore);
+
+  [self waitForExpectationsWithTimeout:1 handler:nil];
+  XCTAssertEqualObjects(executedIndexes, (@[ @0, @1, @2, @3, @4, @5, @6, @7, @8, @9 ]));
+
+  NSError *error;
+  EDOExecutor *executorWithoutQueue = [[EDOExecutor alloc] initWithQueue:nil];
+  XCTAssertFalse([executorWithoutQueue handleBlockAsynchronously:self.emptyBlock error:&error]);
+  XCTAssertEqual(error.code, EDOServiceErrorRequestNotHandled);
+}
+
 - (void)testExecutorFinishRunningAfterClosingMessageQueue {
   dispatch_queue_t queue = [self testQueue];
   EDOExecutor *executor = [[EDOExecutor alloc] initWithQueue:queue];
@@ -0,0 +1,309 @@
+//
+// Copyright 2019 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "Channel/Sources/EDOHostPort.h"
+#import "Service/Sources/EDOBatchInvocationMessage.h"
+#import "Service/Sources/EDOClassMessage.h"
+#import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOMessageCoder.h"
+#import "Service/Sources/EDOObject+Private.h"
+#import "Service/Sources/EDOObject.h"
+#import "Service/Sources/EDOParameter.h"
+#import "Service/Sources/EDOServiceError.h"
+#import "Service/Sources/EDOServicePort.h"
+#import "Service/Sources/EDOServiceRequest.h"
+
+@interface EDOMessageCoderTest : XCTestCase
+@end
+
+@implementation EDOMessageCoderTest
+
+/** Tests that the invocation request is decoded from the binary coding with all its fields. */
+- (void)testInvocationRequestRoundTripsInBinaryCoding {
+  EDOHostPort *hostPort = [EDOHostPort hostPortWithLocalPort:1234];
+  NSArray *arguments = @[
+    [EDOParameter parameterWithObject:@"argument"],
+    [EDOParameter parameterWithObject:@[ @1, @2 ]],
+    [EDOParameter parameterForNilValue],
+  ];
+  EDOInvocationRequest *request = [EDOInvocationRequest requestWithTarget:0xBEEF
+                                                                 selector:@selector(description)
+                                                                arguments:arguments
+                                                                 hostPort:hostPort
+                                                            returnByValue:YES];
+
+  NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:YES];
+  XCTAssertTrue([EDOMessageCoder isBinaryCodedData:data]);
+
+  EDOInvocationRequest *decoded = [EDOMessageCoder messageWithData:data];
+  XCTAssertEqualObjects([decoded class], [EDOInvocationRequest class]);
+  XCTAssertEqual(decoded.messageID, request.messageID);
+  XCTAssertEqualObjects([decoded valueForKey:@"target"], @0xBEEF);
+  XCTAssertEqualObjects([decoded valueForKey:@"selectorName"], @"description");
+  XCTAssertEqualObjects([decoded valueForKey:@"returnByValue"], @YES);
+  XCTAssertEqualObjects([decoded valueForKey:@"hostPort"], hostPort);
+
+  NSArray<EDOParameter *> *decodedArguments = [decoded valueForKey:@"arguments"];
+  XCTAssertEqual(decodedArguments.count, arguments.count);
+  XCTAssertEqualObjects(decodedArguments[0].value, @"argument");
+  XCTAssertEqualObjects(decodedArguments[1].value, (@[ @1, @2 ]));
+  XCTAssertNil(decodedArguments[2].value);
+}
+
+/** Tests that the batch invocation request keeps its invocations in order in both codings. */
+- (void)testBatchInvocationRequestRoundTrips {
+  EDOHostPort *hostPort = [EDOHostPort hostPortWithLocalPort:1234];
+  NSMutableArray<EDOInvocationRequest *> *invocations = [[NSMutableArray alloc] init];
+  for (int i = 0; i < 3; ++i) {
+    [invocations addObject:[EDOInvocationRequest
+                               requestWithTarget:0xBEEF + i
+                                        selector:@selector(description)
+                                       arguments:@[ [EDOParameter parameterWithObject:@(i)] ]
+                                        hostPort:hostPort
+                                   returnByValue:NO]];
+  }
+  EDOBatchInvocationRequest *request =
+      [EDOBatchInvocationRequest requestWithInvocations:invocations];
+
+  for (NSNumber *binaryCoding in @[ @NO, @YES ]) {
+    NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:binaryCoding.boolValue];
+    EDOBatchInvocationRequest *decoded = [EDOMessageCoder messageWithData:data];
+    XCTAssertEqualObjects([decoded class], [EDOBatchInvocationRequest class]);
+    XCTAssertEqual(decoded.messageID, request.messageID);
+    XCTAssertEqual(decoded.invocations.count, invocations.count);
+    for (NSUInteger i = 0; i < invocations.count; ++i) {
+      XCTAssertEqual(decoded.invocations[i].messageID, invocations[i].messageID);
+      XCTAssertEqualObjects([decoded.invocations[i] valueForKey:@"target"], @(0xBEEF + i));
+      NSArray<EDOParameter *> *decodedArguments = [decoded.invocations[i] valueForKey:@"arguments"];
+      XCTAssertEqualObjects(decodedArguments[0].value, @(i));
+    }
+  }
+}
+
+/** Tests that the binary coding is smaller than the keyed archive of the same message. */
+- (void)testBinaryCodingIsSmallerThanKeyedArchive {
+  EDOClassRequest *request =
+      [EDOClassRequest requestWithClassName:@"EDOTestDummy"
+                                   hostPort:[EDOHostPort hostPortWithLocalPort:1234]];
+
+  NSData *keyedData = [EDOMessageCoder dataWithMessage:request binaryCoding:NO];
+  NSData *binaryData = [EDOMessageCoder dataWithMessage:request binaryCoding:YES];
+  XCTAssertFalse([EDOMessageCoder isBinaryCodedData:keyedData]);
+  XCTAssertLessThan(binaryData.length, keyedData.length);
+
+  // Both codings are decoded to the same request.
+  EDOClassRequest *keyedRequest = [EDOMessageCoder messageWithData:keyedData];
+  EDOClassRequest *binaryRequest = [EDOMessageCoder messageWithData:binaryData];
+  XCTAssertEqual(keyedRequest.messageID, request.messageID);
+  XCTAssertEqual(binaryRequest.messageID, request.messageID);
+  XCTAssertEqualObjects([binaryRequest valueForKey:@"className"], @"EDOTestDummy");
+}
+
+/** Tests that the keyed archive keeps the UUID string of the message ID from the older clients. */
+- (void)testKeyedArchiveKeepsLegacyMessageID {
+  EDOClassRequest *request =
+      [EDOClassRequest requestWithClassName:@"EDOTestDummy"
+                                   hostPort:[EDOHostPort hostPortWithLocalPort:1234]];
+  NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:NO];
+  EDOClassRequest *decoded = [EDOMessageCoder messageWithData:data];
+  XCTAssertEqual(decoded.messageID, request.messageID);
+  XCTAssertNil(decoded.legacyMessageID);
+
+  // The older clients identify the request with a UUID string, which the response sends back.
+  NSString *legacyMessageID = [NSUUID UUID].UUIDString;
+  request.legacyMessageID = legacyMessageID;
+  data = [EDOMessageCoder dataWithMessage:request binaryCoding:NO];
+  decoded = [EDOMessageCoder messageWithData:data];
+  XCTAssertEqualObjects(decoded.legacyMessageID, legacyMessageID);
+
+  EDOErrorResponse *response = [EDOErrorResponse unhandledErrorResponseForRequest:decoded];
+  response.legacyMessageID = decoded.legacyMessageID;
+  data = [EDOMessageCoder dataWithMessage:response binaryCoding:NO];
+  EDOErrorResponse *decodedResponse = [EDOMessageCoder messageWithData:data];
+  XCTAssertEqualObjects(decodedResponse.legacyMessageID, legacyMessageID);
+  XCTAssertEqual(decodedResponse.messageID, decoded.messageID);
+}
+
+/** Tests that the response advertises the binary coding in both codings. */
+- (void)testResponseAdvertisesBinaryCoding {
+  EDOClassRequest *request =
+      [EDOClassRequest requestWithClassName:@"EDOTestDummy"
+                                   hostPort:[EDOHostPort hostPortWithLocalPort:1234]];
+  NSError *error = [NSError errorWithDomain:EDOServiceErrorDomain
+                                       code:EDOServiceErrorRequestNotHandled
+                                   userInfo:nil];
+  EDOErrorResponse *response = [EDOErrorResponse errorResponse:error forRequest:request];
+
+  for (NSNumber *binaryCoding in @[ @NO, @YES ]) {
+    NSData *data = [EDOMessageCoder dataWithMessage:response binaryCoding:binaryCoding.boolValue];
+    EDOErrorResponse *decoded = [EDOMessageCoder messageWithData:data];
+    XCTAssertEqualObjects([decoded class], [EDOErrorResponse class]);
+    XCTAssertEqual(decoded.messageID, request.messageID);
+    XCTAssertEqualObjects(decoded.error, error);
+    XCTAssertTrue(decoded.binaryCodingSupported);
+  }
+}
+
+/** Tests that the remaining time of the request is kept in both codings. */
+- (void)testRequestRemainingTimeRoundTrips {
+  EDOClassRequest *request =
+      [EDOClassRequest requestWithClassName:@"EDOTestDummy"
+                                   hostPort:[EDOHostPort hostPortWithLocalPort:1234]];
+  for (NSNumber *binaryCoding in @[ @NO, @YES ]) {
+    request.remainingTime = 0;
+    NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:binaryCoding.boolValue];
+    EDOClassRequest *decoded = [EDOMessageCoder messageWithData:data];
+    XCTAssertEqual(decoded.remainingTime, 0);
+
+    request.remainingTime = 2.5;
+    data = [EDOMessageCoder dataWithMessage:request binaryCoding:binaryCoding.boolValue];
+    decoded = [EDOMessageCoder messageWithData:data];
+    XCTAssertEqualObjects([decoded class], [EDOClassRequest class]);
+    XCTAssertEqual(decoded.remainingTime, 2.5);
+  }
+}
+
+/** Tests that the strings are only sent with the first message on a connection. */
+- (void)testStringsAreInternedOnConnection {
+  EDOHostPort *hostPort = [EDOHostPort hostPortWithLocalPort:1234];
+  EDOMessageInternTable *sendingTable = [[EDOMessageInternTable alloc] init];
+  EDOMessageInternTable *receivingTable = [[EDOMessageInternTable alloc] init];
+  NSArray *arguments = @[ [EDOParameter parameterWithObject:@"argument"] ];
+
+  NSMutableArray<NSData *> *dataArray = [[NSMutableArray alloc] init];
+  for (int i = 0; i < 2; ++i) {
+    EDOInvocationRequest *request =
+        [EDOInvocationRequest requestWithTarget:0xBEEF
+                                       selector:@selector(performSelector:withObject:)
+                                      arguments:arguments
+                                       hostPort:hostPort
+                                  returnByValue:NO];
+    [dataArray addObject:[EDOMessageCoder dataWithMessage:request
+                                             binaryCoding:YES
+                                              internTable:sendingTable]];
+  }
+  XCTAssertLessThan(dataArray[1].length, dataArray[0].length);
+
+  // The second message only refers to the strings that are sent with the first one.
+  XCTAssertThrowsSpecificNamed([EDOMessageCoder messageWithData:dataArray[1]], NSException,
+                               NSInvalidUnarchiveOperationException);
+  for (NSData *data in dataArray) {
+    EDOInvocationRequest *decoded = [EDOMessageCoder messageWithData:data
+                                                         internTable:receivingTable];
+    XCTAssertEqualObjects([decoded valueForKey:@"selectorName"], @"performSelector:withObject:");
+    NSArray<EDOParameter *> *decodedArguments = [decoded valueForKey:@"arguments"];
+    XCTAssertEqualObjects(decodedArguments[0].value, @"argument");
+  }
+}
+
+/** Tests that the remote objects of the same service share the service port once decoded. */
+- (void)testServicePortIsInternedForRemoteObjects {
+  EDOServicePort *port = [EDOServicePort servicePortWithPort:1234 serviceName:@"service"];
+  NSMutableArray<EDOObject *> *objects = [[NSMutableArray alloc] init];
+  NSMutableArray *targets = [[NSMutableArray alloc] init];
+  for (int i = 0; i < 100; ++i) {
+    [targets addObject:[[NSObject alloc] init]];
+    [objects addObject:[EDOObject objectWithTarget:targets.lastObject port:port]];
+  }
+  EDOParameter *parameter = [EDOParameter parameterWithObject:[objects copy]];
+  EDOInvocationRequest *request =
+      [EDOInvocationRequest requestWithTarget:0xBEEF
+                                     selector:@selector(description)
+                                    arguments:@[ parameter ]
+                                     hostPort:port.hostPort
+                                returnByValue:NO];
+
+  NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:YES];
+  XCTAssertLessThan(data.length, [EDOMessageCoder dataWithMessage:request binaryCoding:NO].length);
+
+  EDOInvocationRequest *decoded = [EDOMessageCoder messageWithData:data];
+  NSArray<EDOParameter *> *decodedArguments = [decoded valueForKey:@"arguments"];
+  NSArray<EDOObject *> *decodedObjects = (NSArray *)decodedArguments[0].value;
+  XCTAssertEqual(decodedObjects.count, objects.count);
+  EDOServicePort *decodedPort = decodedObjects[0].servicePort;
+  XCTAssertTrue([decodedPort match:port]);
+  for (NSUInteger i = 0; i < objects.count; ++i) {
+    XCTAssertEqual(decodedObjects[i].servicePort, decodedPort);
+    XCTAssertEqual(decodedObjects[i].remoteAddress, objects[i].remoteAddress);
+  }
+}
+
+/** Tests that the primitive values are stored inline and the small integers are preboxed. */
+- (void)testPrimitiveParametersRoundTripInline {
+  BOOL yes = YES;
+  NSInteger one = 1;
+  double pi = M_PI;
+  NSRange range = NSMakeRange(3, 7);
+  EDOParameter *boolParameter = [EDOParameter parameterWithBytes:&yes objCType:@encode(BOOL)];
+  EDOParameter *integerParameter = [EDOParameter parameterWithBytes:&one
+                                                           objCType:@encode(NSInteger)];
+  XCTAssertEqual(boolParameter, [EDOParameter parameterWithBytes:&yes objCType:@encode(BOOL)]);
+  XCTAssertEqual(integerParameter, [EDOParameter parameterWithBytes:&one
+                                                           objCType:@encode(NSInteger)]);
+
+  NSArray<EDOParameter *> *arguments = @[
+    boolParameter,
+    integerParameter,
+    [EDOParameter parameterWithBytes:&pi objCType:@encode(double)],
+    [EDOParameter parameterWithBytes:&range objCType:@encode(NSRange)],
+  ];
+  EDOInvocationRequest *request =
+      [EDOInvocationRequest requestWithTarget:0xBEEF
+                                     selector:@selector(description)
+                                    arguments:arguments
+                                     hostPort:[EDOHostPort hostPortWithLocalPort:1234]
+                                returnByValue:NO];
+  for (NSNumber *binaryCoding in @[ @NO, @YES ]) {
+    NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:binaryCoding.boolValue];
+    EDOInvocationRequest *decoded = [EDOMessageCoder messageWithData:data];
+    NSArray<EDOParameter *> *decodedArguments = [decoded valueForKey:@"arguments"];
+
+    BOOL decodedBool = NO;
+    NSInteger decodedInteger = 0;
+    double decodedDouble = 0;
+    NSRange decodedRange = NSMakeRange(0, 0);
+    [decodedArguments[0] getValue:&decodedBool];
+    [decodedArguments[1] getValue:&decodedInteger];
+    [decodedArguments[2] getValue:&decodedDouble];
+    [decodedArguments[3] getValue:&decodedRange];
+    XCTAssertTrue(decodedBool);
+    XCTAssertEqual(decodedInteger, one);
+    XCTAssertEqual(decodedDouble, pi);
+    XCTAssertTrue(NSEqualRanges(decodedRange, range));
+    XCTAssertEqual(strcmp(decodedArguments[3].objCType, @encode(NSRange)), 0);
+    if (binaryCoding.boolValue) {
+      // The preboxed parameters are shared by the decoded messages as well.
+      XCTAssertEqual(decodedArguments[0], boolParameter);
+      XCTAssertEqual(decodedArguments[1], integerParameter);
+    }
+  }
+}
+
+/** Tests that the malformed binary data fails to decode with an exception. */
+- (void)testMalformedBinaryDataRaisesException {
+  EDOClassRequest *request =
+      [EDOClassRequest requestWithClassName:@"EDOTestDummy"
+                                   hostPort:[EDOHostPort hostPortWithLocalPort:1234]];
+  NSData *data = [EDOMessageCoder dataWithMessage:request binaryCoding:YES];
+  NSData *truncatedData = [data subdataWithRange:NSMakeRange(0, data.length - 4)];
+
+  XCTAssertThrowsSpecificNamed([EDOMessageCoder messageWithData:truncatedData], NSException,
+                               NSInvalidUnarchiveOperationException);
+}
+
+@end
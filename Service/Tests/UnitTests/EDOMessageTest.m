@@ -24,6 +24,9 @@
 #import "Service/Sources/EDOHostService+Private.h"
 #import "Service/Sources/EDOHostService.h"
 #import "Service/Sources/EDOInvocationMessage.h"
+#import "Service/Sources/EDOInvocationPlan.h"
+#import "Service/Sources/EDOMessage.h"
+#import "Service/Sources/EDOMethodDispatch.h"
 #import "Service/Sources/EDOMethodSignatureMessage.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObject.h"
@@ -99,6 +102,92 @@
   free(classes);
 }
 
+/** Tests that the message IDs of a process share the epoch and follow the sequence. */
+- (void)testMessageIDsAreSequential {
+  EDOMessage *firstMessage = [[EDOMessage alloc] init];
+  EDOMessage *secondMessage = [[EDOMessage alloc] init];
+  XCTAssertEqual(firstMessage.messageID >> 48, secondMessage.messageID >> 48);
+  XCTAssertGreaterThan(secondMessage.messageID, firstMessage.messageID);
+}
+
+/** Tests that the invocation plan parses the kinds and the sizes of the method signature. */
+- (void)testInvocationPlanParsesMethodSignature {
+  SEL selector = @selector(returnSumWithInt:longValue:doubleValue:dummyStruct:number:errorOut:);
+  NSMethodSignature *signature = [EDOTestDummy instanceMethodSignatureForSelector:selector];
+  EDOInvocationPlan *plan = [EDOInvocationPlan planWithMethodSignature:signature
+                                                    firstArgumentIndex:2];
+
+  EDOInvocationValueKind kinds[] = {
+      EDOInvocationValueKindBytes, EDOInvocationValueKindBytes,
+      EDOInvocationValueKindBytes, EDOInvocationValueKindBytes,
+      EDOInvocationValueKindObject, EDOInvocationValueKindObjectPointer,
+  };
+  for (NSUInteger i = 2; i < signature.numberOfArguments; ++i) {
+    XCTAssertEqual([plan argumentAtIndex:i]->kind, kinds[i - 2]);
+    XCTAssertEqualObjects([plan argumentAtIndex:i]->typeEncoding,
+                          @([signature getArgumentTypeAtIndex:i]));
+  }
+  XCTAssertEqual([plan argumentAtIndex:5]->size, sizeof(EDOTestDummyStruct));
+  XCTAssertEqual(plan.maxArgumentSize, sizeof(EDOTestDummyStruct));
+  XCTAssertEqual(plan.numberOfObjectPointerArguments, 1u);
+  XCTAssertEqual(plan.returnKind, EDOInvocationValueKindBytes);
+  XCTAssertEqual(plan.returnSize, sizeof(double));
+
+  NSMethodSignature *voidSignature =
+      [EDOTestDummy instanceMethodSignatureForSelector:@selector(voidWithValuePlusOne)];
+  XCTAssertEqual([EDOInvocationPlan planWithMethodSignature:voidSignature
+                                         firstArgumentIndex:2]
+                     .returnKind,
+                 EDOInvocationValueKindVoid);
+}
+
+/** Tests that the host calls the methods of the common signatures without NSInvocation. */
+- (void)testMethodDispatchInvokesCommonMethodsDirectly {
+  EDOTestDummy *dummy = [[EDOTestDummy alloc] initWithValue:5];
+  EDOMethodDispatch *dispatch =
+      [EDOMethodDispatch dispatchForTarget:dummy selector:@selector(returnNumberWithInt:value:)];
+  XCTAssertTrue(dispatch.invokesDirectly);
+  XCTAssertEqual(dispatch,
+                 [EDOMethodDispatch dispatchForTarget:dummy
+                                             selector:@selector(returnNumberWithInt:value:)]);
+  XCTAssertEqualObjects(dispatch.signature,
+                        [dummy methodSignatureForSelector:@selector(returnNumberWithInt:value:)]);
+
+  int intValue = -3;
+  NSNumber *number = @10;
+  uintptr_t arguments[] = {
+      [EDOMethodDispatch wordWithBytes:&intValue objCType:@encode(int)],
+      (uintptr_t)(__bridge void *)number,
+  };
+  uintptr_t returnWord = [dispatch invokeWithTarget:dummy arguments:arguments];
+  XCTAssertEqualObjects((__bridge id)(void *)returnWord, @12);
+
+  XCTAssertFalse([EDOMethodDispatch dispatchForTarget:dummy selector:@selector(structWithStruct:)]
+                     .invokesDirectly);
+  XCTAssertNil([EDOMethodDispatch dispatchForTarget:dummy selector:@selector(nonExistMethod)]);
+}
+
+/** Tests that the method family is resolved once with the dispatch of the method. */
+- (void)testMethodDispatchCachesMethodFamily {
+  EDOTestDummy *dummy = [[EDOTestDummy alloc] init];
+  EDOMethodDispatch *returnSelf = [EDOMethodDispatch dispatchForTarget:dummy
+                                                              selector:@selector(returnSelf)];
+  EDOMethodDispatch *copy = [EDOMethodDispatch dispatchForTarget:dummy selector:@selector(copy)];
+  EDOMethodDispatch *alloc = [EDOMethodDispatch dispatchForTarget:[EDOTestDummy class]
+                                                         selector:@selector(alloc)];
+  XCTAssertEqual(returnSelf.methodFamily, EDOMethodFamilyNone);
+  XCTAssertEqual(copy.methodFamily, EDOMethodFamilyCopy);
+  XCTAssertEqual(alloc.methodFamily, EDOMethodFamilyAlloc);
+
+  NSArray<EDOMethodDispatch *> *dispatches =
+      [EDOMethodDispatch cachedDispatchesForClass:[EDOTestDummy class]];
+  XCTAssertTrue([dispatches containsObject:returnSelf]);
+  XCTAssertTrue([dispatches containsObject:copy]);
+  XCTAssertFalse([dispatches containsObject:alloc]);
+  XCTAssertTrue([[EDOMethodDispatch cachedDispatchesForClass:object_getClass([EDOTestDummy class])]
+      containsObject:alloc]);
+}
+
 - (void)testObjectRequestHandler {
   XCTestExpectation *blockExecuted = [self expectationWithDescription:@"Executed the test block."];
   id dummyLocal = [[EDOTestDummy alloc] init];
@@ -219,6 +308,26 @@
   [self waitForExpectationsWithTimeout:1 handler:nil];
 }
 
+- (void)testInvocationWithMismatchedArgumentTypeHandler {
+  EDOTestDummy *dummyLocal = [[EDOTestDummy alloc] initWithValue:5];
+  EDOTestDummyStruct dummyStruct = {.value = 8};
+  EDOBoxedValueType *structValue =
+      [EDOBoxedValueType parameterWithBytes:&dummyStruct objCType:@encode(EDOTestDummyStruct)];
+
+  // The struct is larger than the int argument, and it is rejected instead of being copied.
+  [self edo_createQueueAndServiceWithRootObject:dummyLocal
+                                          block:^(EDOHostService *service) {
+                                            EDOInvocationResponse *response = [self
+                                                edo_runInvocationWithService:service
+                                                                      target:dummyLocal
+                                                                    selector:@selector(voidWithInt:)
+                                                                   arguments:@[ structValue ]];
+                                            XCTAssertNotNil(response.exception);
+                                            XCTAssertNil(response.returnValue);
+                                          }];
+  XCTAssertEqual(dummyLocal.value, 5);
+}
+
 - (void)testInvocationWithReturnHandler {
   XCTestExpectation *blockExecuted = [self expectationWithDescription:@"Executed the test block."];
   EDOTestDummy *dummyLocal = [[EDOTestDummy alloc] initWithValue:100];
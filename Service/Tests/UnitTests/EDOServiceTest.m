@@ -17,16 +17,22 @@
 
 #import <XCTest/XCTest.h>
 
+#import "Channel/Sources/EDOChannelPool.h"
 #import "Channel/Sources/EDOHostPort.h"
 #import "Service/Sources/EDOClientService+Private.h"
 #import "Service/Sources/EDOClientService.h"
+#import "Service/Sources/EDODeadline.h"
+#import "Service/Sources/EDOFuture.h"
 #import "Service/Sources/EDOHostNamingService.h"
 #import "Service/Sources/EDOHostService+Private.h"
+#import "Service/Sources/EDOInvocationBatch.h"
+#import "Service/Sources/EDOMessageCoder.h"
 #import "Service/Sources/EDOObject+Private.h"
 #import "Service/Sources/EDOObject.h"
 #import "Service/Sources/EDOObjectMessage.h"
 #import "Service/Sources/EDORemoteException.h"
 #import "Service/Sources/EDOServiceError.h"
+#import "Service/Sources/EDOServiceException.h"
 #import "Service/Sources/EDOServicePort.h"
 #import "Service/Sources/EDOServiceRequest.h"
 #import "Service/Sources/NSObject+EDOValueObject.h"
@@ -796,6 +802,219 @@ static NSString *const kTestServiceName = @"com.google.edotest.service";
   XCTAssertEqual([dummyOnBackground returnCountWithArray:[[array passByValue] returnByValue]], 4);
 }
 
+- (void)testAsyncInvocationsCompleteFutures {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 19;
+
+  NSMutableArray<EDOFuture *> *futures = [[NSMutableArray alloc] init];
+  for (int i = 0; i < 20; ++i) {
+    EDOFuture *future;
+    XCTAssertNil([[dummyOnBackground edo_asyncWithFuture:&future] returnNumberWithInt:i value:@5]);
+    [futures addObject:future];
+  }
+  for (int i = 0; i < 20; ++i) {
+    XCTAssertEqualObjects([futures[i] waitForResult], @(19 + i + 5));
+    XCTAssertTrue(futures[i].done);
+  }
+
+  EDOFuture *intFuture;
+  XCTAssertEqual([[dummyOnBackground edo_asyncWithFuture:&intFuture] returnInt], 0);
+  XCTestExpectation *expectation = [self expectationWithDescription:@"The future is notified."];
+  [intFuture notifyOnQueue:dispatch_get_main_queue()
+                   handler:^(EDOFuture *future) {
+                     // The scalar result is boxed by its type encoding in a plain NSValue.
+                     int result = 0;
+                     [future.result getValue:&result];
+                     XCTAssertEqual(result, [self.rootObject returnInt]);
+                     [expectation fulfill];
+                   }];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  EDOFuture *voidFuture;
+  [[dummyOnBackground edo_asyncWithFuture:&voidFuture] voidWithValuePlusOne];
+  XCTAssertNil([voidFuture waitForResult]);
+  XCTAssertNil(voidFuture.exception);
+  XCTAssertNil(voidFuture.error);
+}
+
+- (void)testAsyncInvocationsContinueInternTablesOfSynchronousRequests {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 11;
+
+  // The first response advertises the binary coding, and the later requests intern their strings
+  // on the pooled channel, which the pipeline may take after them.
+  for (int i = 0; i < 3; ++i) {
+    XCTAssertEqualObjects([dummyOnBackground returnNumberWithInt:i value:@1], @(11 + i + 1));
+  }
+  EDOFuture *future;
+  [[dummyOnBackground edo_asyncWithFuture:&future] returnNumberWithInt:3 value:@1];
+  XCTAssertEqualObjects([future waitForResult], @(11 + 3 + 1));
+  XCTAssertNil(future.error);
+  XCTAssertEqualObjects([dummyOnBackground returnNumberWithInt:4 value:@1], @(11 + 4 + 1));
+}
+
+- (void)testAsyncInvocationKeepsTargetUntilResponse {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 3;
+  // The method signature is fetched beforehand.
+  [[dummyOnBackground returnDeepCopy] returnNumberWithInt:0 value:@0];
+
+  EDOFuture *future;
+  @autoreleasepool {
+    // The proxy and its target are dropped right after the invocation is made.
+    [[[dummyOnBackground returnDeepCopy] edo_asyncWithFuture:&future] returnNumberWithInt:1
+                                                                                    value:@2];
+  }
+  XCTAssertEqualObjects([future waitForResult], @(3 + 1 + 2));
+  XCTAssertNil(future.error);
+}
+
+- (void)testAsyncInvocationErrors {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 13;
+
+  EDOFuture *future;
+  [[dummyOnBackground edo_asyncWithFuture:&future] selWithThrow];
+  XCTAssertThrowsSpecificNamed([future waitForResult], EDORemoteException, @"Dummy Just Throw 13");
+  XCTAssertNotNil(future.exception);
+
+  NSError *errorOut;
+  XCTAssertThrowsSpecificNamed(
+      [[dummyOnBackground edo_asyncWithFuture:&future] returnBoolWithError:&errorOut], NSException,
+      EDOTypeEncodingException);
+  XCTAssertThrowsSpecificNamed([self.rootObject edo_asyncWithFuture:&future], NSException,
+                               NSObjectNotAvailableException);
+}
+
+- (void)testAsyncInvocationsArePipelinedOutOfOrder {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 7;
+
+  // The block waits for the invocation sent after it on the same pipeline, which only completes if
+  // the service handles it while the first one waits for the block.
+  // The method signature is fetched beforehand, so the block isn't invoked while fetching it.
+  [dummyOnBackground returnNumberWithInt:0 value:@0];
+  __block EDOFuture *numberFuture;
+  __block EDOFuture *blockFuture;
+  XCTestExpectation *expectation = [self expectationWithDescription:@"The block is invoked."];
+  [[dummyOnBackground edo_asyncWithFuture:&blockFuture] voidWithBlock:^{
+    XCTAssertEqualObjects([numberFuture waitForResult], @(7 + 1 + 2));
+    XCTAssertFalse(blockFuture.done);
+    [expectation fulfill];
+  }];
+  [[dummyOnBackground edo_asyncWithFuture:&numberFuture] returnNumberWithInt:1 value:@2];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  XCTAssertNil([blockFuture waitForResult]);
+  XCTAssertNil(blockFuture.error);
+}
+
+- (void)testInvocationBatchMakesRecordedInvocationsInOrder {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 5;
+
+  EDOInvocationBatch *batch = [[EDOInvocationBatch alloc] init];
+  EDOTestDummy *recorder = [batch recorderForObject:dummyOnBackground];
+  [recorder voidWithValuePlusOne];
+  [recorder voidWithValuePlusOne];
+  XCTAssertEqual([recorder returnInt], 0);
+  XCTAssertNil([recorder returnNumberWithInt:1 value:@2]);
+  XCTAssertEqual(batch.count, 4);
+  // Nothing is sent until the batch is flushed.
+  XCTAssertEqual(self.rootObject.value, 5);
+
+  NSArray<EDOFuture *> *futures = [batch flush];
+  XCTAssertEqual(batch.count, 0);
+  XCTAssertEqual(self.rootObject.value, 7);
+  XCTAssertEqual(futures.count, 4);
+  int returnInt = 0;
+  [futures[2].result getValue:&returnInt];
+  XCTAssertEqual(returnInt, [self.rootObject returnInt]);
+  XCTAssertEqualObjects(futures[3].result, @(7 + 1 + 2));
+  XCTAssertEqual([batch flush].count, 0);
+
+  // The invocations after the one that raises are still made.
+  [recorder selWithThrow];
+  [recorder voidWithValuePlusOne];
+  XCTAssertThrowsSpecificNamed([batch flush], EDORemoteException, @"Dummy Just Throw 7");
+  XCTAssertEqual(self.rootObject.value, 8);
+
+  // The recorder and its target are dropped before the batch is flushed.
+  @autoreleasepool {
+    [[batch recorderForObject:[dummyOnBackground returnDeepCopy]] returnNumberWithInt:1 value:@2];
+  }
+  XCTAssertEqualObjects([batch flush][0].result, @(8 + 1 + 2));
+
+  XCTAssertThrowsSpecificNamed([batch recorderForObject:self.rootObject], NSException,
+                               NSObjectNotAvailableException);
+}
+
+- (void)testDeadlineScopeKeepsEarlierDeadline {
+  XCTAssertNil(EDODeadline.currentDeadline);
+  EDODeadline *outerDeadline = [EDODeadline deadlineWithTimeout:5];
+  [outerDeadline performBlock:^{
+    XCTAssertEqual(EDODeadline.currentDeadline, outerDeadline);
+    // The nested scope can't extend the deadline.
+    [[EDODeadline deadlineWithTimeout:10] performBlock:^{
+      XCTAssertEqual(EDODeadline.currentDeadline, outerDeadline);
+    }];
+    EDODeadline *innerDeadline = [EDODeadline deadlineWithTimeout:0];
+    [innerDeadline performBlock:^{
+      XCTAssertEqual(EDODeadline.currentDeadline, innerDeadline);
+    }];
+    XCTAssertTrue(innerDeadline.expired);
+    XCTAssertEqual(innerDeadline.remainingTime, 0);
+    XCTAssertEqual(EDODeadline.currentDeadline, outerDeadline);
+  }];
+  XCTAssertNil(EDODeadline.currentDeadline);
+  XCTAssertFalse(outerDeadline.expired);
+  XCTAssertLessThanOrEqual(outerDeadline.remainingTime, 5);
+
+  XCTAssertThrowsSpecificNamed([self.rootObject edo_withTimeout:1], NSException,
+                               NSObjectNotAvailableException);
+}
+
+- (void)testDeadlineFailsInvocationOnBusyService {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  self.rootObject.value = 5;
+  [dummyOnBackground voidWithValuePlusOne];
+  __block NSError *deadlineError;
+  EDOClientErrorHandler oldErrorHandler = EDOSetClientErrorHandler(^(NSError *error) {
+    deadlineError = error;
+  });
+
+  dispatch_async(self.executionQueue, ^{
+    [NSThread sleepForTimeInterval:2];
+  });
+  NSDate *startDate = [NSDate date];
+  [[dummyOnBackground edo_withTimeout:0.5] voidWithValuePlusOne];
+  XCTAssertLessThan([[NSDate date] timeIntervalSinceDate:startDate], 2);
+  XCTAssertEqualObjects(deadlineError.domain, EDOServiceErrorDomain);
+  XCTAssertEqual(deadlineError.code, EDOServiceErrorDeadlineExceeded);
+
+  // The service rejects the request that expires before it runs.
+  dispatch_sync(self.executionQueue, ^{});
+  XCTAssertEqual(self.rootObject.value, 6);
+  EDOSetClientErrorHandler(oldErrorHandler);
+}
+
+- (void)testDeadlineIsPassedToNestedInvocations {
+  EDOTestDummy *dummyOnBackground = self.rootObjectOnBackground;
+  XCTestExpectation *expectation = [self expectationWithDescription:@"The block is invoked."];
+  // The queue doesn't have a service, so the block is invoked on the queue of the temporary
+  // service, which only has the deadline sent with the invocation of the block.
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    __block NSTimeInterval nestedRemainingTime = 0;
+    [[dummyOnBackground edo_withTimeout:5] voidWithBlock:^{
+      nestedRemainingTime = EDODeadline.currentDeadline.remainingTime;
+    }];
+    XCTAssertGreaterThan(nestedRemainingTime, 0);
+    XCTAssertLessThanOrEqual(nestedRemainingTime, 5);
+    [expectation fulfill];
+  });
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
 - (void)testEDOHostServiceTrackedByNamingService {
   EDOHostNamingService *namingServiceObject = EDOHostNamingService.sharedService;
   XCTAssertFalse([namingServiceObject portForServiceWithName:kTestServiceName] == 0);
@@ -862,6 +1081,47 @@ static NSString *const kTestServiceName = @"com.google.edotest.service";
   XCTAssertTrue(response.duration > 0 && response.duration <= 1000);
 }
 
+- (void)testServicePingsOnlyRequestsRunningLongerThanPingDelay {
+  dispatch_queue_t testQueue = dispatch_queue_create(NULL, DISPATCH_QUEUE_SERIAL);
+  EDOHostService *hostService = [EDOHostService serviceWithPort:0 rootObject:self queue:testQueue];
+  EDOHostPort *port = hostService.port.hostPort;
+  id<EDOChannel> channel = [EDOChannelPool.sharedChannelPool channelWithPort:port error:nil];
+  NSData *(^firstDataForRequest)(void) = ^{
+    __block NSData *firstData;
+    dispatch_semaphore_t waitLock = dispatch_semaphore_create(0);
+    NSData *requestData =
+        [EDOMessageCoder dataWithMessage:[EDOObjectRequest requestWithHostPort:port]
+                            binaryCoding:NO];
+    [channel sendData:requestData withCompletionHandler:nil];
+    [channel receiveDataWithHandler:^(id<EDOChannel> channel, NSData *data, NSError *error) {
+      firstData = data;
+      dispatch_semaphore_signal(waitLock);
+    }];
+    dispatch_semaphore_wait(waitLock, DISPATCH_TIME_FOREVER);
+    return firstData;
+  };
+
+  // The fast request is answered by the response alone.
+  NSData *data = firstDataForRequest();
+  XCTAssertFalse([data isEqualToData:EDOClientService.pingMessageData]);
+  XCTAssertTrue([[EDOMessageCoder messageWithData:data] isKindOfClass:[EDOObjectResponse class]]);
+
+  // The earlier behavior pings the request before the response.
+  hostService.pingDelay = 0;
+  XCTAssertEqualObjects(firstDataForRequest(), EDOClientService.pingMessageData);
+  [channel invalidate];
+  [hostService invalidate];
+
+  // The request running longer than the delay is pinged before it completes.
+  self.serviceOnBackground.pingDelay = 0.1;
+  __block BOOL blockInvoked = NO;
+  [self.rootObjectOnBackground voidWithBlock:^{
+    [NSThread sleepForTimeInterval:0.5];
+    blockInvoked = YES;
+  }];
+  XCTAssertTrue(blockInvoked);
+}
+
 - (void)testUnrecognizedSelectorExceptionHandling {
   dispatch_queue_t testQueue = dispatch_queue_create(NULL, DISPATCH_QUEUE_SERIAL);
   EDOHostService *hostService = [EDOHostService serviceWithPort:0 rootObject:self queue:testQueue];